@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT       += core gui
+QT       += core gui concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -24,27 +24,26 @@ DEFINES += QT_DEPRECATED_WARNINGS
 
 CONFIG += c++11
 
+# Record per-stage detection times and counters (DetectionStats), shown in the
+# status bar after Apply. Without it the recording compiles to nothing.
+DEFINES += POLYFEATURE_STATS
+
+include(polyfeaturecore.pri)
+
 SOURCES += \
-        CurveFitter.cpp \
-        Spline.cpp \
         datamarker.cpp \
         main.cpp \
         mainwindow.cpp \
-        polyfeaturedetection.cpp \
         polygondisplayview.cpp \
-        polygonedge.cpp \
-        polygongraphicsitem.cpp
+        polygongraphicsitem.cpp \
+        rendertilecache.cpp
 
 HEADERS += \
-        CurveFitter.h \
-        Spline.h \
         datamarker.h \
-        hashcombine.h \
         mainwindow.h \
-        polyfeaturedetection.h \
         polygondisplayview.h \
-        polygonedge.h \
-        polygongraphicsitem.h
+        polygongraphicsitem.h \
+        rendertilecache.h
 
 FORMS += \
         mainwindow.ui
@@ -4,8 +4,6 @@
 #include <qstack.h>
 #include <qvector.h>
 
-const int MAX_SPLINE_SIZE = 50000;
-
 CurveFitter::CurveFitter() {}
 
 CurveFitter::~CurveFitter() {}
@@ -62,14 +60,18 @@ QPolygonF SplineCurveFitter::fitSpline(const QPolygonF &points) const {
   const double dx = x2 - x1;
   const double delta = dx / (d_data->splineSize - 1);
 
+  QVector<double> v(d_data->splineSize);
+  QVector<double> sv(d_data->splineSize);
+  for (int i = 0; i < d_data->splineSize; i++)
+    v[i] = x1 + i * delta;
+
+  d_data->spline.values(v.constData(), sv.data(), d_data->splineSize);
+
   for (int i = 0; i < d_data->splineSize; i++) {
     QPointF &p = fittedPoints[i];
 
-    const double v = x1 + i * delta;
-    const double sv = d_data->spline.value(v);
-
-    p.setX(v);
-    p.setY(sv);
+    p.setX(v[i]);
+    p.setY(sv[i]);
   }
 
   d_data->spline.reset();
@@ -7,6 +7,9 @@
 
 class Spline;
 
+// Upper bound of SplineCurveFitter::setSplineSize()
+const int MAX_SPLINE_SIZE = 50000;
+
 class CurveFitter {
 public:
   virtual ~CurveFitter();
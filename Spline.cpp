@@ -1,4 +1,5 @@
 #include "Spline.h"
+#include "geometrykernels.h"
 #include <qmath.h>
 
 static int lookup(double x, const QPolygonF &values) {
@@ -26,6 +27,18 @@ static int lookup(double x, const QPolygonF &values) {
   return i1;
 }
 
+/* lookup() of x, walking on from segment i of an argument prev <= x; other
+  arguments (including NaN) go through the binary search */
+static int walk(double x, double prev, int i, const QPolygonF &values) {
+  if (!(x >= prev))
+    return lookup(x, values);
+
+  const int last = values.size() - 2;
+  while (i < last && values[i + 1].x() <= x)
+    i++;
+  return i;
+}
+
 Spline::Spline() { d_data = new PrivateData; }
 
 Spline::Spline(const Spline &other) { d_data = new PrivateData(*other.d_data); }
@@ -90,6 +103,42 @@ double Spline::value(double x) const {
       d_data->points[i].y());
 }
 
+/* Calculate value() for count arguments, in any order. Ascending arguments
+  walk the segments on from the previous one, the others are looked up like
+  in value(), and runs of arguments on the same segment go through
+  GeometryKernels::cubic() together.*/
+void Spline::values(const double *xs, double *ys, int count) const {
+  if (d_data->coefficientsA.size() == 0) {
+    for (int k = 0; k < count; k++)
+      ys[k] = 0.0;
+    return;
+  }
+
+  const QPolygonF &points = d_data->points;
+
+  int k = 0;
+  int i = count > 0 ? lookup(xs[0], points) : 0;
+  while (k < count) {
+    int end = k + 1;
+    int next = i;
+    while (end < count && (next = walk(xs[end], xs[end - 1], i, points)) == i)
+      end++;
+
+    GeometryKernels::cubic(points[i].x(), points[i].y(),
+                           d_data->coefficientsA[i], d_data->coefficientsB[i],
+                           d_data->coefficientsC[i], xs + k, end - k, ys + k);
+    k = end;
+    i = next;
+  }
+}
+
+/* Coefficients of segment i, 0 <= i < points().size() - 1 */
+void Spline::coefficients(int i, double &a, double &b, double &c) const {
+  a = d_data->coefficientsA[i];
+  b = d_data->coefficientsB[i];
+  c = d_data->coefficientsC[i];
+}
+
 /* Determines the coefficients for a natural spline
 return true if successful */
 bool Spline::buildNaturalSpline(const QPolygonF &points) {
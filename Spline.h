@@ -22,6 +22,11 @@ public:
 
   bool isValid() const;
   double value(double x) const;
+  // value() of count arguments, in any order
+  void values(const double *xs, double *ys, int count) const;
+  // Cubic of segment i : value() = ((a * d + b) * d + c) * d + points()[i].y()
+  // with d = x - points()[i].x()
+  void coefficients(int i, double &a, double &b, double &c) const;
 
 protected:
   bool buildNaturalSpline(const QPolygonF &);
@@ -0,0 +1,66 @@
+#ifndef DETECTIONMETRICS_H
+#define DETECTIONMETRICS_H
+
+#include "edgegeometry.h"
+#include "edgespan.h"
+#include "polygonedge.h"
+#include <QList>
+#include <QVector>
+
+// Tolerance-independent measurements of one polygon, kept by
+// PolyFeatureDetection between detection runs (see setMetricsCaching()).
+// Everything here depends only on the edges and the sharp-angle grouping,
+// except the spline fit which is kept for the spline tolerance it was made with.
+class DetectionMetrics
+{
+public:
+    DetectionMetrics()
+        : mValid(false)
+        , mSharpAngleCheck(false)
+        , mSharpAngleTolerance(0.0)
+        , mCoordinates(FloatingPointCoordinates)
+        , mLineNormalizeFactor(1.0)
+        , mSplinesValid(false)
+        , mSplineTolerance(0.0)
+    {}
+
+    void clear()
+    {
+        mValid = false;
+        mSplinesValid = false;
+        mEdgeList.clear();
+        mGroups.clear();
+        mSharpEdgeIDs.clear();
+        mArcResiduals.clear();
+        mSplineIDs.clear();
+        mSplineCounts.clear();
+        mSplineErrors.clear();
+    }
+
+    bool mValid;
+    QList<PolygonEdge *> mEdgeList;
+
+    // sharp-angle grouping the metrics were computed for
+    bool mSharpAngleCheck;
+    double mSharpAngleTolerance;
+    QVector<EdgeSpan> mGroups;
+    QVector<long> mSharpEdgeIDs;
+
+    // turning angles and line slopes, and the coordinates they came from
+    CoordinateMode mCoordinates;
+    EdgeGeometry mGeometry;
+    double mLineNormalizeFactor;
+
+    // per group, normalised distance of the next edge end point to the circle
+    // through the previous and current edge (see arcResidualsGroup())
+    QVector<QVector<double>> mArcResiduals;
+
+    // spline fit, per group local IDs and per edge errors
+    bool mSplinesValid;
+    double mSplineTolerance;
+    QVector<QVector<long>> mSplineIDs;
+    QVector<int> mSplineCounts;
+    QVector<double> mSplineErrors;
+};
+
+#endif // DETECTIONMETRICS_H
@@ -0,0 +1,102 @@
+#include "detectionstats.h"
+#include <QStringList>
+
+DetectionStats::DetectionStats()
+    : mWallNanoseconds(0)
+{
+    for (qint64 &lTime : mStageNanoseconds) {
+        lTime = 0;
+    }
+    for (qint64 &lCount : mCounters) {
+        lCount = 0;
+    }
+}
+
+bool DetectionStats::enabled()
+{
+#ifdef POLYFEATURE_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char *DetectionStats::stageName(const DetectionStage aStage)
+{
+    switch (aStage) {
+    case GeometryStage:
+        return "geometry";
+    case SplineStage:
+        return "splines";
+    case ArcStage:
+        return "arcs";
+    case LineStage:
+        return "lines";
+    case CascadeStage:
+        return "cascade";
+    case NumberingStage:
+        return "numbering";
+    default:
+        return "";
+    }
+}
+
+QString DetectionStats::summary() const
+{
+    if (mCounters[ResultCacheHits] > 0) {
+        return QString("Detection : cached result in %1 ms").arg(mWallNanoseconds / 1E6, 0, 'f', 3);
+    }
+
+    QString lSummary = QString("Detection : %1 ms").arg(mWallNanoseconds / 1E6, 0, 'f', 3);
+    QStringList lStages;
+    for (int s = 0; s < NumDetectionStages; s++) {
+        if (mStageNanoseconds[s] > 0) {
+            lStages << QString("%1 %2")
+                           .arg(QString(stageName(DetectionStage(s))))
+                           .arg(mStageNanoseconds[s] / 1E6, 0, 'f', 3);
+        }
+    }
+    if (!lStages.isEmpty()) {
+        lSummary += " (" + lStages.join(", ") + ")";
+    }
+    lSummary += QString(", %1 edges, %2 spline fits (depth %3), %4 spline samples, %5 KB")
+                    .arg(mCounters[EdgesProcessed])
+                    .arg(mCounters[SplineFits])
+                    .arg(mCounters[SplineRecursionDepth])
+                    .arg(mCounters[SplineSamples])
+                    .arg(mCounters[BytesAllocated] / 1024);
+    return lSummary;
+}
+
+void DetectionStatsCollector::reset()
+{
+    for (std::atomic<qint64> &lTime : mStageNanoseconds) {
+        lTime.store(0, std::memory_order_relaxed);
+    }
+    for (std::atomic<qint64> &lCount : mCounters) {
+        lCount.store(0, std::memory_order_relaxed);
+    }
+}
+
+void DetectionStatsCollector::raise(const DetectionCounter aCounter, const qint64 aValue)
+{
+    qint64 lCurrent = mCounters[aCounter].load(std::memory_order_relaxed);
+    while (lCurrent < aValue
+           && !mCounters[aCounter].compare_exchange_weak(lCurrent,
+                                                         aValue,
+                                                         std::memory_order_relaxed)) {
+    }
+}
+
+DetectionStats DetectionStatsCollector::snapshot(const qint64 aWallNanoseconds) const
+{
+    DetectionStats lStats;
+    lStats.mWallNanoseconds = aWallNanoseconds;
+    for (int s = 0; s < NumDetectionStages; s++) {
+        lStats.mStageNanoseconds[s] = mStageNanoseconds[s].load(std::memory_order_relaxed);
+    }
+    for (int c = 0; c < NumDetectionCounters; c++) {
+        lStats.mCounters[c] = mCounters[c].load(std::memory_order_relaxed);
+    }
+    return lStats;
+}
@@ -0,0 +1,123 @@
+#ifndef DETECTIONSTATS_H
+#define DETECTIONSTATS_H
+
+#include "detectiontrace.h"
+#include <atomic>
+#include <QElapsedTimer>
+#include <QString>
+
+// Stages of PolyFeatureDetection::detectFeatures() that are timed separately.
+// Groups are labelled concurrently, so stage times are summed over groups
+// (thread time) while mWallNanoseconds is the elapsed time of the whole run.
+enum DetectionStage {
+    GeometryStage,  // edge geometry, sharp-angle grouping and cached metrics
+    SplineStage,    // spline fits and spline errors
+    ArcStage,       // arc residuals and labels
+    LineStage,      // line labels
+    CascadeStage,   // CascadeDetection groups, all checks together
+    NumberingStage, // global feature IDs from the per-group ones
+    NumDetectionStages
+};
+
+enum DetectionCounter {
+    EdgesProcessed,       // edges through each stage, summed over stages
+    SplineFits,           // SplineCurveFitter::fitCurve() calls
+    SplineSamples,        // points sampled on the fitted splines
+    SplineRecursionDepth, // deepest calcSplineApprox_recursive() call chain
+    BytesAllocated,       // working buffers : spline samples, group labels
+    ResultCacheHits,      // 1 when the result came from the result cache
+    NumDetectionCounters
+};
+
+// What one detection run did, returned with its DetectionResult. Only
+// recorded when the core is built with DEFINES += POLYFEATURE_STATS,
+// otherwise everything stays 0 and the recording macros compile to nothing.
+class DetectionStats
+{
+public:
+    DetectionStats();
+
+    static bool enabled();
+    static const char *stageName(const DetectionStage aStage);
+
+    // one line, e.g. for a status bar
+    QString summary() const;
+
+    qint64 mWallNanoseconds;
+    qint64 mStageNanoseconds[NumDetectionStages];
+    qint64 mCounters[NumDetectionCounters];
+};
+
+// Thread-safe accumulation of the stats of the run in progress
+class DetectionStatsCollector
+{
+public:
+    DetectionStatsCollector() { reset(); }
+
+    void reset();
+    void add(const DetectionCounter aCounter, const qint64 aValue)
+    {
+        mCounters[aCounter].fetch_add(aValue, std::memory_order_relaxed);
+    }
+    void raise(const DetectionCounter aCounter, const qint64 aValue);
+    void addTime(const DetectionStage aStage, const qint64 aNanoseconds)
+    {
+        mStageNanoseconds[aStage].fetch_add(aNanoseconds, std::memory_order_relaxed);
+    }
+
+    DetectionStats snapshot(const qint64 aWallNanoseconds) const;
+
+private:
+    std::atomic<qint64> mStageNanoseconds[NumDetectionStages];
+    std::atomic<qint64> mCounters[NumDetectionCounters];
+};
+
+// Adds the time until the end of its scope to a stage
+class DetectionStageTimer
+{
+public:
+    DetectionStageTimer(DetectionStatsCollector &aCollector, const DetectionStage aStage)
+        : mCollector(aCollector)
+        , mStage(aStage)
+    {
+        mTimer.start();
+    }
+    ~DetectionStageTimer() { mCollector.addTime(mStage, mTimer.nsecsElapsed()); }
+
+private:
+    DetectionStatsCollector &mCollector;
+    DetectionStage mStage;
+    QElapsedTimer mTimer;
+};
+
+// Recording in PolyFeatureDetection members, through its mStatsCollector.
+// DETECTION_STAGE_TIMER also traces the stage when tracing is compiled in.
+#ifdef POLYFEATURE_STATS
+#define DETECTION_STATS_BEGIN() \
+    QElapsedTimer lStatsTimer; \
+    lStatsTimer.start(); \
+    mStatsCollector.reset()
+#define DETECTION_STATS_END(aStats) aStats = mStatsCollector.snapshot(lStatsTimer.nsecsElapsed())
+#define DETECTION_STAGE_STATS(aStage) DetectionStageTimer lStageTimer(mStatsCollector, aStage)
+#define DETECTION_STAT_ADD(aCounter, aValue) mStatsCollector.add(aCounter, aValue)
+#define DETECTION_STAT_MAX(aCounter, aValue) mStatsCollector.raise(aCounter, aValue)
+#else
+#define DETECTION_STATS_BEGIN() ((void) 0)
+#define DETECTION_STATS_END(aStats) ((void) 0)
+#define DETECTION_STAGE_STATS(aStage) ((void) 0)
+#define DETECTION_STAT_ADD(aCounter, aValue) ((void) 0)
+#define DETECTION_STAT_MAX(aCounter, aValue) ((void) 0)
+#endif
+
+#ifdef POLYFEATURE_TRACE
+#define DETECTION_STAGE_TRACE(aStage) \
+    DetectionTraceScope lStageTrace("stage", DetectionStats::stageName(aStage))
+#else
+#define DETECTION_STAGE_TRACE(aStage) ((void) 0)
+#endif
+
+#define DETECTION_STAGE_TIMER(aStage) \
+    DETECTION_STAGE_STATS(aStage); \
+    DETECTION_STAGE_TRACE(aStage)
+
+#endif // DETECTIONSTATS_H
@@ -0,0 +1,179 @@
+#include "detectiontrace.h"
+#include <atomic>
+#include <chrono>
+#include <QCoreApplication>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSharedPointer>
+#include <QTextStream>
+#include <QThread>
+#include <QVector>
+
+// Events of one thread, the oldest overwritten once full. Only its own thread
+// writes to it, and only while recording.
+class TraceRing
+{
+public:
+    TraceRing()
+        : mThreadIndex(0)
+        , mWritten(0)
+    {}
+
+    QVector<TraceEvent> mEvents;
+    QString mThreadName;
+    int mThreadIndex; // "tid" of its events
+    qint64 mWritten;
+};
+
+// Rings of every thread that ever recorded. They are kept until the process
+// exits, since pool threads may be gone by the time the trace is written.
+class TraceRings
+{
+public:
+    QMutex mMutex;
+    QVector<QSharedPointer<TraceRing>> mRings;
+};
+
+static std::atomic<bool> gRecording(false);
+static std::atomic<qint64> gEpoch(0);
+static std::atomic<int> gEventsPerThread(0);
+static thread_local TraceRing *gThreadRing = nullptr;
+
+static TraceRings &traceRings()
+{
+    static TraceRings lRings;
+    return lRings;
+}
+
+static qint64 steadyNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+static TraceRing *threadRing()
+{
+    if (gThreadRing == nullptr) {
+        QSharedPointer<TraceRing> lRing(new TraceRing);
+        const QCoreApplication *lApp = QCoreApplication::instance();
+        const bool lMainThread = lApp != nullptr && QThread::currentThread() == lApp->thread();
+
+        TraceRings &lRings = traceRings();
+        QMutexLocker lLocker(&lRings.mMutex);
+        lRing->mThreadIndex = lRings.mRings.count() + 1;
+        lRing->mThreadName = lMainThread ? QString("main")
+                                         : QString("worker %1").arg(lRing->mThreadIndex);
+        lRing->mEvents.resize(gEventsPerThread.load(std::memory_order_relaxed));
+        lRings.mRings.append(lRing);
+        gThreadRing = lRing.data();
+    }
+    return gThreadRing;
+}
+
+// Chrome trace timestamps are in microseconds
+static QString traceMicroseconds(const qint64 aNanoseconds)
+{
+    return QString::number(aNanoseconds / 1000.0, 'f', 3);
+}
+
+bool DetectionTrace::enabled()
+{
+#ifdef POLYFEATURE_TRACE
+    return true;
+#else
+    return false;
+#endif
+}
+
+void DetectionTrace::start(const int aEventsPerThread)
+{
+    TraceRings &lRings = traceRings();
+    QMutexLocker lLocker(&lRings.mMutex);
+    gEventsPerThread.store(qMax(1, aEventsPerThread), std::memory_order_relaxed);
+    for (auto &lRing : lRings.mRings) {
+        lRing->mEvents.clear();
+        lRing->mEvents.resize(gEventsPerThread.load(std::memory_order_relaxed));
+        lRing->mWritten = 0;
+    }
+    gEpoch.store(steadyNanoseconds(), std::memory_order_relaxed);
+    gRecording.store(true, std::memory_order_release);
+}
+
+void DetectionTrace::stop()
+{
+    gRecording.store(false, std::memory_order_release);
+}
+
+bool DetectionTrace::recording()
+{
+    return gRecording.load(std::memory_order_acquire);
+}
+
+qint64 DetectionTrace::now()
+{
+    return steadyNanoseconds() - gEpoch.load(std::memory_order_relaxed);
+}
+
+void DetectionTrace::record(const TraceEvent &aEvent)
+{
+    TraceRing *lRing = threadRing();
+    const int lCapacity = lRing->mEvents.count();
+    if (lCapacity > 0) {
+        lRing->mEvents[int(lRing->mWritten % lCapacity)] = aEvent;
+        lRing->mWritten++;
+    }
+}
+
+qint64 DetectionTrace::droppedEvents()
+{
+    TraceRings &lRings = traceRings();
+    QMutexLocker lLocker(&lRings.mMutex);
+    qint64 lDropped = 0;
+    for (const auto &lRing : lRings.mRings) {
+        lDropped += qMax(qint64(0), lRing->mWritten - lRing->mEvents.count());
+    }
+    return lDropped;
+}
+
+int DetectionTrace::writeChromeTrace(const QString &aFilePath)
+{
+    QFile lFile(aFilePath);
+    if (!lFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return -1;
+    }
+
+    TraceRings &lRings = traceRings();
+    QMutexLocker lLocker(&lRings.mMutex);
+    QTextStream lOut(&lFile);
+    lOut << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    lOut << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\""
+         << QCoreApplication::applicationName() << "\"}}";
+
+    int lNumEvents = 0;
+    for (const auto &lRing : lRings.mRings) {
+        lOut << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+             << lRing->mThreadIndex << ",\"args\":{\"name\":\"" << lRing->mThreadName << "\"}}";
+
+        // oldest first, from the start of the ring once it has wrapped around
+        const int lCapacity = lRing->mEvents.count();
+        const qint64 lFirst = qMax(qint64(0), lRing->mWritten - lCapacity);
+        for (qint64 e = lFirst; e < lRing->mWritten; e++) {
+            const TraceEvent &lEvent = lRing->mEvents.at(int(e % lCapacity));
+            lOut << ",\n{\"name\":\"" << lEvent.mName << "\",\"cat\":\"" << lEvent.mCategory
+                 << "\",\"ph\":\"X\",\"ts\":" << traceMicroseconds(lEvent.mStart)
+                 << ",\"dur\":" << traceMicroseconds(lEvent.mDuration)
+                 << ",\"pid\":1,\"tid\":" << lRing->mThreadIndex;
+            if (lEvent.mArgName != nullptr) {
+                lOut << ",\"args\":{\"" << lEvent.mArgName << "\":" << lEvent.mArgValue << "}";
+            }
+            lOut << "}";
+            lNumEvents++;
+        }
+    }
+    lOut << "\n]}\n";
+    lOut.flush();
+
+    return (lFile.error() == QFileDevice::NoError) ? lNumEvents : -1;
+}
@@ -0,0 +1,92 @@
+#ifndef DETECTIONTRACE_H
+#define DETECTIONTRACE_H
+
+#include <QString>
+
+// One complete ("X") event of the Chrome trace event format. Names, categories
+// and argument names are string literals, only their pointers are kept.
+class TraceEvent
+{
+public:
+    TraceEvent()
+        : mName(nullptr)
+        , mCategory(nullptr)
+        , mArgName(nullptr)
+        , mStart(0)
+        , mDuration(0)
+        , mArgValue(0)
+    {}
+
+    const char *mName;
+    const char *mCategory;
+    const char *mArgName; // nullptr for an event without argument
+    qint64 mStart;        // nanoseconds since DetectionTrace::start()
+    qint64 mDuration;
+    qint64 mArgValue;
+};
+
+// Process-wide recording of timed scopes of the detection pipeline and the
+// tolerance sweep, written as Chrome trace JSON that Perfetto UI
+// (ui.perfetto.dev) or chrome://tracing open offline. Every thread records into
+// a ring buffer of its own, so recording takes no lock; a thread that records
+// more than the ring holds keeps its latest events.
+// Scopes are only compiled in with DEFINES += POLYFEATURE_TRACE (see
+// DETECTION_TRACE_SCOPE) and only recorded between start() and stop(), which,
+// like writeChromeTrace(), must not be called while a detection is running.
+class DetectionTrace
+{
+public:
+    static bool enabled();
+
+    static void start(const int aEventsPerThread = 1 << 16);
+    static void stop();
+    static bool recording();
+
+    // nanoseconds since start()
+    static qint64 now();
+    static void record(const TraceEvent &aEvent);
+
+    // events overwritten in full rings since start()
+    static qint64 droppedEvents();
+
+    // returns the number of events written, -1 when the file can't be written
+    static int writeChromeTrace(const QString &aFilePath);
+};
+
+// Records the time until the end of its scope, when recording
+class DetectionTraceScope
+{
+public:
+    DetectionTraceScope(const char *aCategory,
+                        const char *aName,
+                        const char *aArgName = nullptr,
+                        const qint64 aArgValue = 0)
+    {
+        mEvent.mCategory = aCategory;
+        mEvent.mName = aName;
+        mEvent.mArgName = aArgName;
+        mEvent.mArgValue = aArgValue;
+        mEvent.mStart = DetectionTrace::recording() ? DetectionTrace::now() : -1;
+    }
+    ~DetectionTraceScope()
+    {
+        if (mEvent.mStart >= 0 && DetectionTrace::recording()) {
+            mEvent.mDuration = DetectionTrace::now() - mEvent.mStart;
+            DetectionTrace::record(mEvent);
+        }
+    }
+
+private:
+    TraceEvent mEvent;
+};
+
+#ifdef POLYFEATURE_TRACE
+#define DETECTION_TRACE_SCOPE(aCategory, aName) DetectionTraceScope lTraceScope(aCategory, aName)
+#define DETECTION_TRACE_SCOPE_ARG(aCategory, aName, aArgName, aArgValue) \
+    DetectionTraceScope lTraceScope(aCategory, aName, aArgName, aArgValue)
+#else
+#define DETECTION_TRACE_SCOPE(aCategory, aName) ((void) 0)
+#define DETECTION_TRACE_SCOPE_ARG(aCategory, aName, aArgName, aArgValue) ((void) 0)
+#endif
+
+#endif // DETECTIONTRACE_H
@@ -0,0 +1,78 @@
+#ifndef DETECTIONTYPES_H
+#define DETECTIONTYPES_H
+
+#include "detectionstats.h"
+#include "fixedpoint.h"
+#include "polygonedge.h"
+
+// Version of the labelling done by PolyFeatureDetection. Bump it with any
+// change that alters the labels of existing inputs : results stored on disk
+// (see DiskResultCache) under another version are discarded.
+const quint32 DETECTION_ALGORITHM_VERSION = 4;
+
+// Order in which PolyFeatureDetection::detectFeatures() applies the checks
+enum DetectionMode {
+    SequentialDetection, // splines, then arcs, then lines, each over every edge
+    CascadeDetection     // long line runs first, then arcs, then splines on the rest
+};
+
+// Floating point type of the sharp angle, line and arc checks. The spline
+// fit is always done in double.
+enum ScalarPrecision {
+    DoublePrecision,
+    SinglePrecision // float, twice the vector lanes, close but not equal labels
+};
+
+// Bits of DetectionParameters::enabledChecks(), the checks that label edges
+enum CheckFlags { SplineCheck = 1, ArcCheck = 2, LineCheck = 4, AllChecks = 7 };
+
+// Checks and tolerances applied in one feature detection run
+class DetectionParameters
+{
+public:
+    DetectionParameters()
+        : mMode(SequentialDetection)
+        , mCoordinates(FloatingPointCoordinates)
+        , mPrecision(DoublePrecision)
+        , mCheckLines(false)
+        , mCheckArcs(false)
+        , mCheckSplines(false)
+        , mCheckSharpEdges(false)
+        , mLineTolerance(DEFAULT_LINE_TOL)
+        , mArcTolerance(DEFAULT_ARC_TOL)
+        , mSplineTolerance(DEFAULT_SPLINE_TOL)
+        , mSharpAngleTolerance(DEFAULT_SHARP_ANGLE_TOL)
+    {}
+
+    int enabledChecks() const
+    {
+        return (mCheckSplines ? SplineCheck : 0) | (mCheckArcs ? ArcCheck : 0)
+               | (mCheckLines ? LineCheck : 0);
+    }
+
+    DetectionMode mMode;
+    // FixedPointCoordinates computes edge angles, turns and bounds from the
+    // vertices in micrometres, when all of them are on that grid
+    CoordinateMode mCoordinates;
+    ScalarPrecision mPrecision;
+    bool mCheckLines, mCheckArcs, mCheckSplines, mCheckSharpEdges;
+    double mLineTolerance, mArcTolerance, mSplineTolerance, mSharpAngleTolerance;
+};
+
+// Number of feature IDs assigned by each check in one detection run, and
+// what the run cost (see DetectionStats)
+class DetectionResult
+{
+public:
+    DetectionResult()
+        : mNumLines(0)
+        , mNumArcs(0)
+        , mNumSplines(0)
+        , mNumSharpEdges(0)
+    {}
+
+    int mNumLines, mNumArcs, mNumSplines, mNumSharpEdges;
+    DetectionStats mStats;
+};
+
+#endif // DETECTIONTYPES_H
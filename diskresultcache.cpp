@@ -0,0 +1,299 @@
+#include "diskresultcache.h"
+#include "detectiontypes.h"
+#include <algorithm>
+#include <string.h>
+#include <QMutexLocker>
+
+const quint32 CACHE_FILE_MAGIC = 0x43444650; // "PFDC"
+const quint32 CACHE_FORMAT_VERSION = 3;
+
+// Start of both files
+class FileHeader
+{
+public:
+    quint32 mMagic, mFormatVersion, mAlgorithmVersion, mReserved;
+};
+
+// Precedes every payload in the data file
+class RecordHeader
+{
+public:
+    quint64 mContentHash, mParameterHash;
+    quint32 mKind, mSize;
+};
+
+// One entry of the index file, mOffset is that of the payload
+class IndexEntry
+{
+public:
+    quint64 mContentHash, mParameterHash, mOffset;
+    quint32 mKind, mSize;
+};
+
+static_assert(sizeof(FileHeader) == 16, "unexpected padding in FileHeader");
+static_assert(sizeof(RecordHeader) == 24, "unexpected padding in RecordHeader");
+static_assert(sizeof(IndexEntry) == 32, "unexpected padding in IndexEntry");
+
+DiskResultCache::DiskResultCache()
+    : mHits(0)
+    , mMisses(0)
+{}
+
+DiskResultCache::~DiskResultCache()
+{
+    close();
+}
+
+bool DiskResultCache::open(const QString &aFilePath)
+{
+    QMutexLocker lLocker(&mMutex);
+    mDataFile.close();
+    mIndexFile.close();
+    mLockFile.reset();
+    mLocations.clear();
+    mHits = 0;
+    mMisses = 0;
+
+    // Records appended by two processes at once would interleave. The lock
+    // is held as long as the cache is open, so it never goes stale by age;
+    // that of a process that died is taken over.
+    mLockFile.reset(new QLockFile(aFilePath + ".lock"));
+    mLockFile->setStaleLockTime(0);
+    if (!mLockFile->tryLock()) {
+        mLockFile.reset();
+        return false;
+    }
+
+    mDataFile.setFileName(aFilePath);
+    mIndexFile.setFileName(aFilePath + ".idx");
+    if (!mDataFile.open(QIODevice::ReadWrite) || !mIndexFile.open(QIODevice::ReadWrite)) {
+        mDataFile.close();
+        mIndexFile.close();
+        mLockFile.reset();
+        return false;
+    }
+
+    // A new file, or one of another format or algorithm version, starts over.
+    // A lost index is rebuilt from the data file.
+    bool lOk = true;
+    if (!checkHeader(mDataFile)) {
+        lOk = mDataFile.resize(0) && writeHeader(mDataFile) && mIndexFile.resize(0)
+              && writeHeader(mIndexFile);
+    } else if (!checkHeader(mIndexFile)) {
+        lOk = mIndexFile.resize(0) && writeHeader(mIndexFile);
+    }
+    if (!lOk) {
+        mDataFile.close();
+        mIndexFile.close();
+        mLockFile.reset();
+        return false;
+    }
+
+    loadIndex();
+    return true;
+}
+
+void DiskResultCache::close()
+{
+    QMutexLocker lLocker(&mMutex);
+    mDataFile.close();
+    mIndexFile.close();
+    mLockFile.reset();
+    mLocations.clear();
+}
+
+bool DiskResultCache::isOpen() const
+{
+    QMutexLocker lLocker(&mMutex);
+    return mDataFile.isOpen();
+}
+
+QString DiskResultCache::filePath() const
+{
+    QMutexLocker lLocker(&mMutex);
+    return mDataFile.fileName();
+}
+
+bool DiskResultCache::writeHeader(QFile &aFile)
+{
+    FileHeader lHeader;
+    lHeader.mMagic = CACHE_FILE_MAGIC;
+    lHeader.mFormatVersion = CACHE_FORMAT_VERSION;
+    lHeader.mAlgorithmVersion = DETECTION_ALGORITHM_VERSION;
+    lHeader.mReserved = 0;
+    return aFile.seek(0)
+           && aFile.write(reinterpret_cast<const char *>(&lHeader), sizeof(lHeader))
+                  == qint64(sizeof(lHeader))
+           && aFile.flush();
+}
+
+bool DiskResultCache::checkHeader(QFile &aFile) const
+{
+    FileHeader lHeader;
+    if (!aFile.seek(0)
+        || aFile.read(reinterpret_cast<char *>(&lHeader), sizeof(lHeader))
+               != qint64(sizeof(lHeader))) {
+        return false;
+    }
+    return lHeader.mMagic == CACHE_FILE_MAGIC && lHeader.mFormatVersion == CACHE_FORMAT_VERSION
+           && lHeader.mAlgorithmVersion == DETECTION_ALGORITHM_VERSION;
+}
+
+void DiskResultCache::loadIndex()
+{
+    const qint64 lDataSize = mDataFile.size();
+    qint64 lDataEnd = sizeof(FileHeader);
+    qint64 lEntryCount = (mIndexFile.size() - qint64(sizeof(FileHeader)))
+                         / qint64(sizeof(IndexEntry));
+
+    if (lEntryCount > 0) {
+        uchar *lMap = mIndexFile.map(0, sizeof(FileHeader) + lEntryCount * sizeof(IndexEntry));
+        if (lMap == nullptr) {
+            // no mapping, rebuild the index from the data file
+            lEntryCount = 0;
+        } else {
+            const uchar *lEntryData = lMap + sizeof(FileHeader);
+            for (qint64 i = 0; i < lEntryCount; i++) {
+                IndexEntry lEntry;
+                memcpy(&lEntry, lEntryData + i * sizeof(IndexEntry), sizeof(IndexEntry));
+                // entries past the end of the data file are from an interrupted append
+                if (lEntry.mOffset < sizeof(FileHeader) + sizeof(RecordHeader)
+                    || qint64(lEntry.mOffset + lEntry.mSize) > lDataSize) {
+                    lEntryCount = i;
+                    break;
+                }
+                Location lLocation;
+                lLocation.mOffset = lEntry.mOffset;
+                lLocation.mSize = lEntry.mSize;
+                mLocations[DiskRecordKey(lEntry.mContentHash, lEntry.mParameterHash, lEntry.mKind)]
+                    = lLocation;
+                lDataEnd = std::max(lDataEnd, qint64(lEntry.mOffset + lEntry.mSize));
+            }
+            mIndexFile.unmap(lMap);
+        }
+    }
+
+    mIndexFile.resize(sizeof(FileHeader) + lEntryCount * sizeof(IndexEntry));
+    recoverRecords(lDataEnd);
+}
+
+void DiskResultCache::recoverRecords(const qint64 aFrom)
+{
+    // Records after the last indexed one were appended without their index
+    // entry : add them to the index. A record cut short is dropped.
+    const qint64 lDataSize = mDataFile.size();
+    qint64 lPos = aFrom;
+    while (lPos + qint64(sizeof(RecordHeader)) <= lDataSize) {
+        RecordHeader lHeader;
+        if (!mDataFile.seek(lPos)
+            || mDataFile.read(reinterpret_cast<char *>(&lHeader), sizeof(lHeader))
+                   != qint64(sizeof(lHeader))) {
+            break;
+        }
+        Location lLocation;
+        lLocation.mOffset = lPos + sizeof(RecordHeader);
+        lLocation.mSize = lHeader.mSize;
+        if (qint64(lLocation.mOffset + lLocation.mSize) > lDataSize) {
+            break;
+        }
+        DiskRecordKey lKey(lHeader.mContentHash, lHeader.mParameterHash, lHeader.mKind);
+        if (mLocations.find(lKey) == mLocations.end()) {
+            mLocations[lKey] = lLocation;
+            appendIndexEntry(lKey, lLocation);
+        }
+        lPos = lLocation.mOffset + lLocation.mSize;
+    }
+    if (lPos < lDataSize) {
+        mDataFile.resize(lPos);
+    }
+}
+
+bool DiskResultCache::appendIndexEntry(const DiskRecordKey &aKey, const Location &aLocation)
+{
+    IndexEntry lEntry;
+    lEntry.mContentHash = aKey.mContentHash;
+    lEntry.mParameterHash = aKey.mParameterHash;
+    lEntry.mOffset = aLocation.mOffset;
+    lEntry.mKind = aKey.mKind;
+    lEntry.mSize = aLocation.mSize;
+    return mIndexFile.seek(mIndexFile.size())
+           && mIndexFile.write(reinterpret_cast<const char *>(&lEntry), sizeof(lEntry))
+                  == qint64(sizeof(lEntry))
+           && mIndexFile.flush();
+}
+
+bool DiskResultCache::contains(const DiskRecordKey &aKey) const
+{
+    QMutexLocker lLocker(&mMutex);
+    return mLocations.find(aKey) != mLocations.end();
+}
+
+bool DiskResultCache::find(const DiskRecordKey &aKey, QByteArray &aPayload)
+{
+    QMutexLocker lLocker(&mMutex);
+    auto lFound = mLocations.find(aKey);
+    if (lFound == mLocations.end() || !mDataFile.seek(lFound->second.mOffset)) {
+        mMisses++;
+        return false;
+    }
+    aPayload = mDataFile.read(lFound->second.mSize);
+    if (aPayload.size() != int(lFound->second.mSize)) {
+        mMisses++;
+        return false;
+    }
+    mHits++;
+    return true;
+}
+
+bool DiskResultCache::append(const DiskRecordKey &aKey, const QByteArray &aPayload)
+{
+    QMutexLocker lLocker(&mMutex);
+    if (!mDataFile.isOpen()) {
+        return false;
+    }
+    if (mLocations.find(aKey) != mLocations.end()) {
+        return true;
+    }
+
+    RecordHeader lHeader;
+    lHeader.mContentHash = aKey.mContentHash;
+    lHeader.mParameterHash = aKey.mParameterHash;
+    lHeader.mKind = aKey.mKind;
+    lHeader.mSize = aPayload.size();
+
+    const qint64 lPos = mDataFile.size();
+    Location lLocation;
+    lLocation.mOffset = lPos + sizeof(RecordHeader);
+    lLocation.mSize = aPayload.size();
+    bool lOk = mDataFile.seek(lPos)
+               && mDataFile.write(reinterpret_cast<const char *>(&lHeader), sizeof(lHeader))
+                      == qint64(sizeof(lHeader))
+               && mDataFile.write(aPayload) == aPayload.size() && mDataFile.flush();
+    if (!lOk) {
+        mDataFile.resize(lPos);
+        return false;
+    }
+
+    // the record is complete before its index entry is written, see recoverRecords()
+    mLocations[aKey] = lLocation;
+    appendIndexEntry(aKey, lLocation);
+    return true;
+}
+
+int DiskResultCache::count() const
+{
+    QMutexLocker lLocker(&mMutex);
+    return int(mLocations.size());
+}
+
+int DiskResultCache::hitCount() const
+{
+    QMutexLocker lLocker(&mMutex);
+    return mHits;
+}
+
+int DiskResultCache::missCount() const
+{
+    QMutexLocker lLocker(&mMutex);
+    return mMisses;
+}
@@ -0,0 +1,112 @@
+#ifndef DISKRESULTCACHE_H
+#define DISKRESULTCACHE_H
+
+#include "hashcombine.h"
+#include <QByteArray>
+#include <QFile>
+#include <QLockFile>
+#include <QMutex>
+#include <QScopedPointer>
+#include <QString>
+#include <unordered_map>
+
+// What a record of a DiskResultCache holds
+enum DiskRecordKind {
+    DetectionRecord = 1, // FeatureResultCache entry : labels of one polygon
+    SweepRecord = 2      // ToleranceSweep result of one layer at one parameter point
+};
+
+// Key of a record : polygon content hash, detection parameter hash, record kind
+class DiskRecordKey
+{
+public:
+    DiskRecordKey(const quint64 aContentHash, const quint64 aParameterHash, const quint32 aKind)
+        : mContentHash(aContentHash)
+        , mParameterHash(aParameterHash)
+        , mKind(aKind)
+    {}
+
+    bool operator==(const DiskRecordKey &aOther) const
+    {
+        return mContentHash == aOther.mContentHash && mParameterHash == aOther.mParameterHash
+               && mKind == aOther.mKind;
+    }
+
+    quint64 mContentHash, mParameterHash;
+    quint32 mKind;
+};
+
+namespace std {
+
+template<>
+struct hash<DiskRecordKey>
+{
+    size_t operator()(const DiskRecordKey &k) const
+    {
+        size_t seed = 0;
+        hash_combine(seed, k.mContentHash);
+        hash_combine(seed, k.mParameterHash);
+        hash_combine(seed, k.mKind);
+        return seed;
+    }
+};
+
+} // namespace std
+
+// Detection results kept on disk between runs, e.g. when a model is sliced
+// again with other print settings, or by nightly jobs over the same models.
+//
+// Records are appended to the data file and never rewritten; every record is
+// prefixed with its key and size, and the same key, size and offset are
+// appended to an index file (<data file>.idx). Opening the cache maps the
+// index and loads it in one pass, then recovers records appended after the
+// last complete index entry (e.g. after a crash). Files written by another
+// DETECTION_ALGORITHM_VERSION are emptied. The byte order is that of the host.
+// All methods can be called from several threads. Only one process can have a
+// given cache open at a time : open() takes a lock file (<data file>.lock) and
+// fails while another process holds it.
+class DiskResultCache
+{
+public:
+    DiskResultCache();
+    ~DiskResultCache();
+
+    // Opens or creates the cache, returns false if the files can't be used or
+    // another process has the cache open
+    bool open(const QString &aFilePath);
+    void close();
+    bool isOpen() const;
+    QString filePath() const;
+
+    bool contains(const DiskRecordKey &aKey) const;
+    // Payload stored under aKey, returns false on a miss
+    bool find(const DiskRecordKey &aKey, QByteArray &aPayload);
+    // Appends aPayload under aKey, unless the key is already stored
+    bool append(const DiskRecordKey &aKey, const QByteArray &aPayload);
+
+    int count() const;
+    int hitCount() const;
+    int missCount() const;
+
+private:
+    class Location
+    {
+    public:
+        quint64 mOffset; // of the payload in the data file
+        quint32 mSize;
+    };
+
+    bool writeHeader(QFile &aFile);
+    bool checkHeader(QFile &aFile) const;
+    void loadIndex();
+    void recoverRecords(const qint64 aFrom);
+    bool appendIndexEntry(const DiskRecordKey &aKey, const Location &aLocation);
+
+    mutable QMutex mMutex;
+    QScopedPointer<QLockFile> mLockFile;
+    QFile mDataFile, mIndexFile;
+    std::unordered_map<DiskRecordKey, Location> mLocations;
+    int mHits, mMisses;
+};
+
+#endif // DISKRESULTCACHE_H
@@ -0,0 +1,118 @@
+#include "edgegeometry.h"
+#include "geometrykernels.h"
+#include <cmath>
+#include <QLineF>
+
+// Angle and length of an edge from its end points rounded to Scalar. The
+// double ones are those of PolygonEdge::getAngle() and QLineF.
+template<typename Scalar>
+static Scalar edgeAngle(const PolygonEdge *aEdge)
+{
+    const Scalar y = Scalar(aEdge->getPoint2().y()) - Scalar(aEdge->getPoint1().y());
+    const Scalar x = Scalar(aEdge->getPoint2().x()) - Scalar(aEdge->getPoint1().x());
+    if (std::fabs(x) <= Scalar(EPSILON)) {
+        return 90;
+    }
+    return std::atan2(y, x) * Scalar(180 / 3.14);
+}
+
+template<>
+double edgeAngle<double>(const PolygonEdge *aEdge)
+{
+    return aEdge->getAngle();
+}
+
+template<typename Scalar>
+static Scalar edgeLength(const PolygonEdge *aEdge)
+{
+    const Scalar y = Scalar(aEdge->getPoint2().y()) - Scalar(aEdge->getPoint1().y());
+    const Scalar x = Scalar(aEdge->getPoint2().x()) - Scalar(aEdge->getPoint1().x());
+    return std::sqrt(x * x + y * y);
+}
+
+template<>
+double edgeLength<double>(const PolygonEdge *aEdge)
+{
+    return QLineF(aEdge->getPoint1(), aEdge->getPoint2()).length();
+}
+
+template<typename Scalar>
+BasicEdgeGeometry<Scalar>::BasicEdgeGeometry()
+    : mFixedPoint(false)
+{}
+
+template<typename Scalar>
+void BasicEdgeGeometry<Scalar>::build(const QList<PolygonEdge *> &aEdgeList)
+{
+    mAngles.resize(aEdgeList.count());
+    mSlopes.resize(aEdgeList.count());
+    mLengths.resize(aEdgeList.count());
+    mTurns.resize(qMax(0, aEdgeList.count() - 1));
+    mStartX.resize(aEdgeList.count());
+    mStartY.resize(aEdgeList.count());
+    mFixedPoint = false;
+    mFixedStartX.clear();
+    mFixedStartY.clear();
+    for (int i = 0; i < aEdgeList.count(); i++) {
+        const PolygonEdge *lEdge = aEdgeList.at(i);
+        Scalar lAngle = edgeAngle<Scalar>(lEdge);
+        mAngles[i] = lAngle;
+        mSlopes[i] = edgeSlope(lAngle);
+        mLengths[i] = edgeLength<Scalar>(lEdge);
+        mStartX[i] = Scalar(lEdge->getPoint1().x());
+        mStartY[i] = Scalar(lEdge->getPoint1().y());
+    }
+    GeometryKernels::turns(mAngles.constData(), mAngles.count(), mTurns.data());
+}
+
+template<typename Scalar>
+void BasicEdgeGeometry<Scalar>::build(const QList<PolygonEdge *> &aEdgeList,
+                                      const CoordinateMode aCoordinates)
+{
+    if (aCoordinates != FixedPointCoordinates) {
+        build(aEdgeList);
+        return;
+    }
+
+    mAngles.resize(aEdgeList.count());
+    mSlopes.resize(aEdgeList.count());
+    mLengths.resize(aEdgeList.count());
+    mTurns.resize(qMax(0, aEdgeList.count() - 1));
+    mFixedPoint = true;
+    mStartX.clear();
+    mStartY.clear();
+    mFixedStartX.resize(aEdgeList.count());
+    mFixedStartY.resize(aEdgeList.count());
+    for (int i = 0; i < aEdgeList.count(); i++) {
+        // start point in micrometres into the start arrays, the end point only
+        // for the differences
+        const PolygonEdge *lEdge = aEdgeList.at(i);
+        qint32 lEndX, lEndY;
+        if (!toFixedPoint(lEdge->getPoint1().x(), mFixedStartX[i])
+            || !toFixedPoint(lEdge->getPoint1().y(), mFixedStartY[i])
+            || !toFixedPoint(lEdge->getPoint2().x(), lEndX)
+            || !toFixedPoint(lEdge->getPoint2().y(), lEndY)) {
+            build(aEdgeList);
+            return;
+        }
+        const qint64 lDx = qint64(lEndX) - mFixedStartX.at(i);
+        const qint64 lDy = qint64(lEndY) - mFixedStartY.at(i);
+        Scalar lAngle = Scalar(fixedEdgeAngle(lDx, lDy));
+        mAngles[i] = lAngle;
+        mSlopes[i] = edgeSlope(lAngle);
+        mLengths[i] = Scalar(std::sqrt(double(lDx * lDx + lDy * lDy)) / FIXED_POINT_UNITS_PER_MM);
+    }
+    GeometryKernels::turns(mAngles.constData(), mAngles.count(), mTurns.data());
+}
+
+template<typename Scalar>
+Scalar BasicEdgeGeometry<Scalar>::edgeSlope(const Scalar aAngle)
+{
+    if (std::fabs(aAngle - 90) <= EPSILON) {
+        return 1;
+    }
+    return std::tan(aAngle);
+}
+
+template class BasicEdgeGeometry<double>;
+template class BasicEdgeGeometry<float>;
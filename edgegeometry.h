@@ -0,0 +1,57 @@
+#ifndef EDGEGEOMETRY_H
+#define EDGEGEOMETRY_H
+
+#include "fixedpoint.h"
+#include "polygonedge.h"
+#include <QList>
+#include <QVector>
+
+// Per-edge geometry computed once per detection run, so the checks don't
+// recompute angles and slopes from the edge end points on every pass.
+// Scalar is double, or float for single precision runs (FloatEdgeGeometry).
+template<typename Scalar>
+class BasicEdgeGeometry
+{
+public:
+    BasicEdgeGeometry();
+
+    void build(const QList<PolygonEdge *> &aEdgeList);
+    // With FixedPointCoordinates the angles, lengths and start points come from
+    // the end points in micrometres. Falls back to build() when an end point is
+    // not on that grid.
+    void build(const QList<PolygonEdge *> &aEdgeList, const CoordinateMode aCoordinates);
+
+    int count() const { return mAngles.count(); }
+    Scalar angle(const int i) const { return mAngles.at(i); }
+    Scalar slope(const int i) const { return mSlopes.at(i); }
+    Scalar length(const int i) const { return mLengths.at(i); }
+    // |angle(i + 1) - angle(i)|, the turn from edge i to the next one
+    Scalar turn(const int i) const { return mTurns.at(i); }
+
+    // Start points of the edges, as arrays for GeometryKernels : in micrometres
+    // when built from fixed point coordinates, else in millimetres
+    bool isFixedPoint() const { return mFixedPoint; }
+    const Scalar *startX() const { return mStartX.constData(); }
+    const Scalar *startY() const { return mStartY.constData(); }
+    const qint32 *fixedStartX() const { return mFixedStartX.constData(); }
+    const qint32 *fixedStartY() const { return mFixedStartY.constData(); }
+
+    // Slope as used by the line tolerance check
+    static Scalar edgeSlope(const Scalar aAngle);
+
+private:
+    QVector<Scalar> mAngles;
+    QVector<Scalar> mSlopes;
+    QVector<Scalar> mLengths;
+    QVector<Scalar> mTurns;
+    bool mFixedPoint;
+    QVector<Scalar> mStartX;
+    QVector<Scalar> mStartY;
+    QVector<qint32> mFixedStartX;
+    QVector<qint32> mFixedStartY;
+};
+
+typedef BasicEdgeGeometry<double> EdgeGeometry;
+typedef BasicEdgeGeometry<float> FloatEdgeGeometry;
+
+#endif // EDGEGEOMETRY_H
@@ -0,0 +1,126 @@
+#include "edgegrid.h"
+#include <algorithm>
+#include <math.h>
+
+// Cells per side at most, so that the cell starts stay small for any layer
+const int MAX_GRID_SIDE = 2048;
+
+EdgeGrid::EdgeGrid()
+    : mEdgeCount(0)
+    , mColumns(0)
+    , mRows(0)
+    , mCellWidth(1.0)
+    , mCellHeight(1.0)
+{}
+
+void EdgeGrid::clear()
+{
+    mBounds = QRectF();
+    mEdgeCount = mColumns = mRows = 0;
+    mCellStarts.clear();
+    mCellEdges.clear();
+}
+
+int EdgeGrid::column(const double x) const
+{
+    return qBound(0, int(floor((x - mBounds.left()) / mCellWidth)), mColumns - 1);
+}
+
+int EdgeGrid::row(const double y) const
+{
+    return qBound(0, int(floor((y - mBounds.top()) / mCellHeight)), mRows - 1);
+}
+
+void EdgeGrid::build(const QList<PolygonEdge *> &aEdgeList, const int aEdgesPerCell)
+{
+    clear();
+    if (aEdgeList.isEmpty()) {
+        return;
+    }
+
+    double lMinX = aEdgeList.first()->getPoint1().x(), lMaxX = lMinX;
+    double lMinY = aEdgeList.first()->getPoint1().y(), lMaxY = lMinY;
+    for (const PolygonEdge *lEdge : aEdgeList) {
+        for (const QPointF &p : {lEdge->getPoint1(), lEdge->getPoint2()}) {
+            lMinX = qMin(lMinX, p.x());
+            lMaxX = qMax(lMaxX, p.x());
+            lMinY = qMin(lMinY, p.y());
+            lMaxY = qMax(lMaxY, p.y());
+        }
+    }
+    mBounds = QRectF(QPointF(lMinX, lMinY), QPointF(lMaxX, lMaxY));
+    mEdgeCount = aEdgeList.count();
+
+    // about aEdgesPerCell edges per cell, cells as square as the bounds allow
+    const double lWidth = qMax(mBounds.width(), EPSILON);
+    const double lHeight = qMax(mBounds.height(), EPSILON);
+    const double lCells = qMax(1.0, double(aEdgeList.count()) / qMax(aEdgesPerCell, 1));
+    mColumns = qBound(1, int(ceil(sqrt(lCells * lWidth / lHeight))), MAX_GRID_SIDE);
+    mRows = qBound(1, int(ceil(lCells / mColumns)), MAX_GRID_SIDE);
+    mCellWidth = lWidth / mColumns;
+    mCellHeight = lHeight / mRows;
+
+    // counted first, so that the edges of all cells go in one allocation
+    const int lCellCount = mColumns * mRows;
+    mCellStarts.fill(0, lCellCount + 1);
+    for (int pass = 0; pass < 2; pass++) {
+        QVector<int> lFill;
+        if (pass == 1) {
+            for (int c = 0; c < lCellCount; c++) {
+                mCellStarts[c + 1] += mCellStarts.at(c);
+            }
+            mCellEdges.resize(mCellStarts.last());
+            lFill = mCellStarts;
+        }
+        for (int i = 0; i < aEdgeList.count(); i++) {
+            const QPointF &p1 = aEdgeList.at(i)->getPoint1();
+            const QPointF &p2 = aEdgeList.at(i)->getPoint2();
+            const int lLastColumn = column(qMax(p1.x(), p2.x()));
+            const int lLastRow = row(qMax(p1.y(), p2.y()));
+            for (int r = row(qMin(p1.y(), p2.y())); r <= lLastRow; r++) {
+                for (int c = column(qMin(p1.x(), p2.x())); c <= lLastColumn; c++) {
+                    const int lCell = r * mColumns + c;
+                    if (pass == 0) {
+                        mCellStarts[lCell + 1]++;
+                    } else {
+                        mCellEdges[lFill[lCell]++] = i;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void EdgeGrid::query(const QRectF &aRect, QVector<int> &aEdges) const
+{
+    aEdges.clear();
+    const QRectF lRect = aRect.normalized();
+    if (isEmpty() || lRect.right() < mBounds.left() || lRect.left() > mBounds.right()
+        || lRect.bottom() < mBounds.top() || lRect.top() > mBounds.bottom()) {
+        return;
+    }
+
+    // everything in view, no need to look at the cells
+    if (lRect.left() <= mBounds.left() && lRect.right() >= mBounds.right()
+        && lRect.top() <= mBounds.top() && lRect.bottom() >= mBounds.bottom()) {
+        aEdges.resize(mEdgeCount);
+        for (int i = 0; i < mEdgeCount; i++) {
+            aEdges[i] = i;
+        }
+        return;
+    }
+
+    const int lLastRow = row(lRect.bottom());
+    const int lLastColumn = column(lRect.right());
+    for (int r = row(lRect.top()); r <= lLastRow; r++) {
+        for (int c = column(lRect.left()); c <= lLastColumn; c++) {
+            const int lCell = r * mColumns + c;
+            for (int k = mCellStarts.at(lCell); k < mCellStarts.at(lCell + 1); k++) {
+                aEdges.append(mCellEdges.at(k));
+            }
+        }
+    }
+    // an edge over several cells is listed in each of them
+    std::sort(aEdges.begin(), aEdges.end());
+    aEdges.erase(std::unique(aEdges.begin(), aEdges.end()), aEdges.end());
+}
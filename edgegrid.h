@@ -0,0 +1,45 @@
+#ifndef EDGEGRID_H
+#define EDGEGRID_H
+
+#include "polygonedge.h"
+#include <QList>
+#include <QRectF>
+#include <QVector>
+
+// Edges per grid cell aimed at by EdgeGrid::build()
+const int DEFAULT_EDGES_PER_CELL = 8;
+
+// Uniform grid over the bounding box of an edge list, for the edges near a
+// rectangle (e.g. the exposed part of a view) without going over all of them.
+// Every edge is listed in each cell its bounding box overlaps, in compressed
+// rows : the edges of cell c are mCellEdges[mCellStarts[c] .. mCellStarts[c + 1]).
+class EdgeGrid
+{
+public:
+    EdgeGrid();
+
+    // Indexes the edges of aEdgeList by their position in the list
+    void build(const QList<PolygonEdge *> &aEdgeList,
+               const int aEdgesPerCell = DEFAULT_EDGES_PER_CELL);
+    void clear();
+
+    bool isEmpty() const { return mCellEdges.isEmpty(); }
+    // Bounding box of all edges
+    const QRectF &bounds() const { return mBounds; }
+
+    // Indices of the edges in the cells overlapping aRect (all those crossing
+    // it, and some near it), ascending and each once
+    void query(const QRectF &aRect, QVector<int> &aEdges) const;
+
+private:
+    int column(const double x) const;
+    int row(const double y) const;
+
+    QRectF mBounds;
+    int mEdgeCount, mColumns, mRows;
+    double mCellWidth, mCellHeight;
+    QVector<int> mCellStarts;
+    QVector<int> mCellEdges;
+};
+
+#endif // EDGEGRID_H
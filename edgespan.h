@@ -0,0 +1,48 @@
+#ifndef EDGESPAN_H
+#define EDGESPAN_H
+
+#include "polygonedge.h"
+#include <QList>
+
+// Half-open range [begin, end) of indices into a polygon edge list. The end
+// index may run past the number of edges, in which case the span wraps around
+// to the start of the list (e.g. a feature that crosses the first vertex).
+class EdgeSpan
+{
+public:
+    EdgeSpan()
+        : mBegin(0)
+        , mEnd(0)
+    {}
+    EdgeSpan(const int aBegin, const int aEnd)
+        : mBegin(aBegin)
+        , mEnd(aEnd)
+    {}
+
+    int beginIndex() const { return mBegin; }
+    int endIndex() const { return mEnd; }
+    int count() const { return mEnd - mBegin; }
+    bool isEmpty() const { return mEnd <= mBegin; }
+    bool wraps(const int aEdgeCount) const { return mEnd > aEdgeCount; }
+
+    // Index into the edge list of the i-th edge of this span
+    int indexAt(const int i, const int aEdgeCount) const
+    {
+        int lIndex = mBegin + i;
+        return (lIndex < aEdgeCount) ? lIndex : lIndex - aEdgeCount;
+    }
+
+    PolygonEdge *at(const QList<PolygonEdge *> &aEdgeList, const int i) const
+    {
+        return aEdgeList.at(indexAt(i, aEdgeList.count()));
+    }
+
+    void popFront() { mBegin++; }
+
+private:
+    int mBegin, mEnd;
+};
+
+Q_DECLARE_TYPEINFO(EdgeSpan, Q_PRIMITIVE_TYPE);
+
+#endif // EDGESPAN_H
@@ -0,0 +1,179 @@
+#include "featurediff.h"
+#include <algorithm>
+#include <math.h>
+#include <QtNumeric>
+
+EdgeLabels EdgeLabels::fromEdges(const QList<PolygonEdge *> &aEdgeList)
+{
+    EdgeLabels lLabels;
+    lLabels.mFeatureIDs.reserve(aEdgeList.count());
+    lLabels.mSharpEdgeIDs.reserve(aEdgeList.count());
+    lLabels.mSplineErrors.reserve(aEdgeList.count());
+    for (auto lEdge : aEdgeList) {
+        lLabels.mFeatureIDs.append(lEdge->getFeatureID());
+        lLabels.mSharpEdgeIDs.append(lEdge->getSharpEdgeID());
+        lLabels.mSplineErrors.append(lEdge->getSplineError());
+    }
+    return lLabels;
+}
+
+QVector<FeatureRun> featureRuns(const EdgeLabels &aLabels)
+{
+    QVector<FeatureRun> lRuns;
+    int i = 0;
+    while (i < aLabels.count()) {
+        const long lFeatureID = aLabels.mFeatureIDs.at(i);
+        int lEnd = i + 1;
+        while (lEnd < aLabels.count() && aLabels.mFeatureIDs.at(lEnd) == lFeatureID) {
+            lEnd++;
+        }
+        if (featureKind(lFeatureID) != NoFeature) {
+            FeatureRun lRun;
+            lRun.mKind = featureKind(lFeatureID);
+            lRun.mFeatureID = lFeatureID;
+            lRun.mFirstEdge = i;
+            lRun.mEdgeCount = lEnd - i;
+            lRuns.append(lRun);
+        }
+        i = lEnd;
+    }
+    return lRuns;
+}
+
+static QString describeRun(const FeatureRun &aRun)
+{
+    return QString("%1 %2..%3")
+        .arg(featureKindName(aRun.mKind))
+        .arg(aRun.mFirstEdge)
+        .arg(aRun.lastEdge());
+}
+
+QString FeatureMismatch::describe() const
+{
+    if (mCandidate.mEdgeCount == 0) {
+        return QString("missing %1").arg(describeRun(mReference));
+    } else if (mReference.mEdgeCount == 0) {
+        return QString("extra %1").arg(describeRun(mCandidate));
+    }
+    return QString("%1 instead of %2").arg(describeRun(mCandidate), describeRun(mReference));
+}
+
+// difference of two spline errors, 0 for the same value (unset, infinite or nan)
+static double splineErrorDiff(const double aFirst, const double aSecond)
+{
+    if (aFirst == aSecond || (qIsNaN(aFirst) && qIsNaN(aSecond))) {
+        return 0.0;
+    }
+    double lDiff = fabs(aFirst - aSecond);
+    return qIsNaN(lDiff) ? qInf() : lDiff;
+}
+
+FeatureDiffReport compareFeatures(const EdgeLabels &aReference,
+                                  const EdgeLabels &aCandidate,
+                                  const FeatureDiffTolerance &aTolerance)
+{
+    FeatureDiffReport lReport;
+    const QVector<FeatureRun> lReferenceRuns = featureRuns(aReference);
+    const QVector<FeatureRun> lCandidateRuns = featureRuns(aCandidate);
+    lReport.mNumReferenceRuns = lReferenceRuns.count();
+    lReport.mNumCandidateRuns = lCandidateRuns.count();
+
+    if (aReference.count() != aCandidate.count()) {
+        // not the same polygon, report both as a whole
+        FeatureMismatch lMismatch;
+        lMismatch.mReference.mEdgeCount = aReference.count();
+        lMismatch.mCandidate.mEdgeCount = aCandidate.count();
+        lReport.mMismatches.append(lMismatch);
+        lReport.mSameLabels = false;
+        return lReport;
+    }
+
+    for (int i = 0; i < aReference.count(); i++) {
+        const long lReferenceID = aReference.mFeatureIDs.at(i);
+        const long lCandidateID = aCandidate.mFeatureIDs.at(i);
+        if (lReferenceID != lCandidateID
+            || aReference.mSharpEdgeIDs.at(i) != aCandidate.mSharpEdgeIDs.at(i)) {
+            lReport.mSameLabels = false;
+        }
+        if (featureKind(lReferenceID) != featureKind(lCandidateID)) {
+            lReport.mNumKindMismatchEdges++;
+        }
+        if (!aTolerance.mCompareSplineErrors) {
+            continue;
+        }
+        double lDiff = splineErrorDiff(aReference.mSplineErrors.at(i),
+                                       aCandidate.mSplineErrors.at(i));
+        if (lDiff > 0.0) {
+            lReport.mSameLabels = false;
+        }
+        if (lDiff > aTolerance.mSplineError) {
+            lReport.mNumSplineErrorMismatches++;
+        }
+        lReport.mMaxSplineErrorDiff = std::max(lReport.mMaxSplineErrorDiff, lDiff);
+    }
+
+    // Runs are in edge order and don't overlap, so the candidates of a
+    // reference run are found from where the previous search started
+    const int lSlack = std::max(0, aTolerance.mBoundaryEdges);
+    QVector<bool> lCandidateUsed(lCandidateRuns.count(), false);
+    QVector<bool> lCandidateReported(lCandidateRuns.count(), false);
+    int lStart = 0;
+    for (const FeatureRun &lRun : lReferenceRuns) {
+        while (lStart < lCandidateRuns.count()
+               && lCandidateRuns.at(lStart).lastEdge() < lRun.mFirstEdge - lSlack) {
+            lStart++;
+        }
+        int lMatch = -1;
+        for (int c = lStart; c < lCandidateRuns.count()
+                             && lCandidateRuns.at(c).mFirstEdge <= lRun.mFirstEdge + lSlack;
+             c++) {
+            const FeatureRun &lCandidate = lCandidateRuns.at(c);
+            if (!lCandidateUsed.at(c) && lCandidate.mKind == lRun.mKind
+                && abs(lCandidate.mFirstEdge - lRun.mFirstEdge) <= lSlack
+                && abs(lCandidate.lastEdge() - lRun.lastEdge()) <= lSlack) {
+                lMatch = c;
+                break;
+            }
+        }
+        if (lMatch >= 0) {
+            lCandidateUsed[lMatch] = true;
+            lReport.mNumMatchedRuns++;
+            continue;
+        }
+
+        // reported against the candidate run over its first edge, if any
+        FeatureMismatch lMismatch;
+        lMismatch.mReference = lRun;
+        auto lOver = std::upper_bound(lCandidateRuns.begin(),
+                                      lCandidateRuns.end(),
+                                      lRun.mFirstEdge,
+                                      [](const int aEdge, const FeatureRun &aCandidate) {
+                                          return aEdge < aCandidate.mFirstEdge;
+                                      });
+        if (lOver != lCandidateRuns.begin() && (lOver - 1)->lastEdge() >= lRun.mFirstEdge) {
+            const int c = int(lOver - lCandidateRuns.begin()) - 1;
+            lCandidateReported[c] = true;
+            lMismatch.mCandidate = lCandidateRuns.at(c);
+        }
+        lReport.mMismatches.append(lMismatch);
+    }
+
+    for (int c = 0; c < lCandidateRuns.count(); c++) {
+        if (!lCandidateUsed.at(c) && !lCandidateReported.at(c)) {
+            FeatureMismatch lMismatch;
+            lMismatch.mCandidate = lCandidateRuns.at(c);
+            lReport.mMismatches.append(lMismatch);
+        }
+    }
+
+    std::stable_sort(lReport.mMismatches.begin(),
+                     lReport.mMismatches.end(),
+                     [](const FeatureMismatch &a, const FeatureMismatch &b) {
+                         const FeatureRun &lA = (a.mReference.mEdgeCount > 0) ? a.mReference
+                                                                              : a.mCandidate;
+                         const FeatureRun &lB = (b.mReference.mEdgeCount > 0) ? b.mReference
+                                                                              : b.mCandidate;
+                         return lA.mFirstEdge < lB.mFirstEdge;
+                     });
+    return lReport;
+}
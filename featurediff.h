@@ -0,0 +1,84 @@
+#ifndef FEATUREDIFF_H
+#define FEATUREDIFF_H
+
+#include "featureruns.h"
+#include "polygonedge.h"
+#include <QList>
+#include <QString>
+#include <QVector>
+
+// Labels of an edge list, kept to compare them once the edges are relabelled
+class EdgeLabels
+{
+public:
+    static EdgeLabels fromEdges(const QList<PolygonEdge *> &aEdgeList);
+
+    int count() const { return mFeatureIDs.count(); }
+
+    QVector<long> mFeatureIDs;
+    QVector<long> mSharpEdgeIDs;
+    QVector<double> mSplineErrors;
+};
+
+// The features of aLabels in edge order, edges without a feature are skipped
+QVector<FeatureRun> featureRuns(const EdgeLabels &aLabels);
+
+// How far a candidate may be from the reference without being reported
+class FeatureDiffTolerance
+{
+public:
+    FeatureDiffTolerance()
+        : mBoundaryEdges(0)
+        , mCompareSplineErrors(true)
+        , mSplineError(1E-9)
+    {}
+
+    int mBoundaryEdges; // a run matches one of the same kind with both ends this close
+    // Off for runs without the spline check, whose spline errors are whatever
+    // an earlier run left on the edges
+    bool mCompareSplineErrors;
+    double mSplineError; // largest difference of the spline errors of an edge
+};
+
+// A reference run without a match in the candidate, or the other way round.
+// The missing side has mEdgeCount 0.
+class FeatureMismatch
+{
+public:
+    QString describe() const;
+
+    FeatureRun mReference;
+    FeatureRun mCandidate;
+};
+
+class FeatureDiffReport
+{
+public:
+    FeatureDiffReport()
+        : mSameLabels(true)
+        , mNumReferenceRuns(0)
+        , mNumCandidateRuns(0)
+        , mNumMatchedRuns(0)
+        , mNumKindMismatchEdges(0)
+        , mMaxSplineErrorDiff(0.0)
+        , mNumSplineErrorMismatches(0)
+    {}
+
+    bool matches() const { return mMismatches.isEmpty() && mNumSplineErrorMismatches == 0; }
+
+    bool mSameLabels; // identical feature IDs, sharp-edge IDs and compared spline errors
+    int mNumReferenceRuns, mNumCandidateRuns, mNumMatchedRuns;
+    int mNumKindMismatchEdges; // edges given another feature kind than in the reference
+    double mMaxSplineErrorDiff;
+    int mNumSplineErrorMismatches; // edges over FeatureDiffTolerance::mSplineError
+    QVector<FeatureMismatch> mMismatches;
+};
+
+// Matches the feature runs of aCandidate to those of aReference. Feature IDs
+// themselves are not compared, only the kind and the extent of every run, so
+// a candidate that numbers its features differently still matches.
+FeatureDiffReport compareFeatures(const EdgeLabels &aReference,
+                                  const EdgeLabels &aCandidate,
+                                  const FeatureDiffTolerance &aTolerance = FeatureDiffTolerance());
+
+#endif // FEATUREDIFF_H
@@ -0,0 +1,204 @@
+#include "featureexport.h"
+#include "featureruns.h"
+#include <math.h>
+#include <stdio.h>
+#include <QDataStream>
+#include <QLocale>
+#include <QMutexLocker>
+#include <QtEndian>
+
+const quint32 EXPORT_FILE_MAGIC = 0x52584650; // "PFXR"
+const quint32 EXPORT_FORMAT_VERSION = 1;
+
+// Shortest text that reads back as aValue, null for inf and nan
+static void appendJsonNumber(QByteArray &aOut, const double aValue)
+{
+    if (qIsFinite(aValue)) {
+        aOut += QByteArray::number(aValue, 'g', QLocale::FloatingPointShortest);
+    } else {
+        aOut += "null";
+    }
+}
+
+static void appendJsonPoint(QByteArray &aOut, const QPointF &aPoint)
+{
+    aOut += '[';
+    appendJsonNumber(aOut, aPoint.x());
+    aOut += ',';
+    appendJsonNumber(aOut, aPoint.y());
+    aOut += ']';
+}
+
+FeatureExportWriter::FeatureExportWriter(const FeatureExportFormat aFormat, const int aBufferSize)
+    : mFormat(aFormat)
+    , mBufferSize(qMax(aBufferSize, 1))
+    , mFlushSize(qMin(EXPORT_FLUSH_SIZE, mBufferSize))
+    , mOk(false)
+    , mPolygonCount(0)
+    , mBytesWritten(0)
+{}
+
+FeatureExportWriter::~FeatureExportWriter()
+{
+    close();
+}
+
+bool FeatureExportWriter::open(const QString &aFilePath)
+{
+    QMutexLocker lLocker(&mMutex);
+    mFile.close();
+    mPolygonCount = 0;
+    mBytesWritten = 0;
+
+    // unbuffered, mBuffer is the only buffer and a flush reaches the file
+    if (aFilePath == "-") {
+        mOk = mFile.open(stdout, QIODevice::WriteOnly | QIODevice::Unbuffered);
+    } else {
+        mFile.setFileName(aFilePath);
+        mOk = mFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered);
+    }
+    if (!mOk) {
+        return false;
+    }
+
+    // reserved, so the buffer keeps its allocation when emptied by resize(0)
+    mBuffer.reserve(mBufferSize);
+    mBuffer.resize(0);
+    if (mFormat == BinaryExport) {
+        QDataStream lStream(&mBuffer, QIODevice::WriteOnly);
+        lStream.setByteOrder(QDataStream::LittleEndian);
+        lStream << EXPORT_FILE_MAGIC << EXPORT_FORMAT_VERSION;
+    }
+    mFlushTimer.start();
+    return true;
+}
+
+bool FeatureExportWriter::close()
+{
+    QMutexLocker lLocker(&mMutex);
+    if (!mFile.isOpen()) {
+        return mOk;
+    }
+    flushBuffer();
+    mFile.close();
+    mBuffer = QByteArray();
+    return mOk;
+}
+
+bool FeatureExportWriter::isOpen() const
+{
+    QMutexLocker lLocker(&mMutex);
+    return mFile.isOpen();
+}
+
+bool FeatureExportWriter::writePolygon(const int aLayer,
+                                       const int aLoop,
+                                       const QList<PolygonEdge *> &aEdgeList)
+{
+    // encoded outside the lock, only the copy into the buffer is serialized
+    const QByteArray lRecord = encodePolygon(aLayer, aLoop, aEdgeList);
+
+    QMutexLocker lLocker(&mMutex);
+    if (!mFile.isOpen()) {
+        return false;
+    }
+    if (mBuffer.size() + lRecord.size() > mBufferSize) {
+        flushBuffer();
+    }
+    if (lRecord.size() > mBufferSize) {
+        // larger than the whole buffer, written as it is
+        const qint64 lWritten = mFile.write(lRecord);
+        mOk = mOk && (lWritten == lRecord.size());
+        mBytesWritten += qMax(lWritten, qint64(0));
+    } else {
+        mBuffer += lRecord;
+    }
+    mPolygonCount++;
+    // a reader of the file sees the record soon, the buffer still batches
+    // the small records of a busy run
+    if (mBuffer.size() >= mFlushSize || mFlushTimer.elapsed() >= EXPORT_FLUSH_INTERVAL) {
+        flushBuffer();
+    }
+    return mOk;
+}
+
+bool FeatureExportWriter::flush()
+{
+    QMutexLocker lLocker(&mMutex);
+    return mFile.isOpen() && flushBuffer();
+}
+
+int FeatureExportWriter::polygonCount() const
+{
+    QMutexLocker lLocker(&mMutex);
+    return mPolygonCount;
+}
+
+qint64 FeatureExportWriter::bytesWritten() const
+{
+    QMutexLocker lLocker(&mMutex);
+    return mBytesWritten;
+}
+
+QByteArray FeatureExportWriter::encodePolygon(const int aLayer,
+                                              const int aLoop,
+                                              const QList<PolygonEdge *> &aEdgeList) const
+{
+    const FeatureRunList lRuns = FeatureRunList::fromEdges(aEdgeList);
+    QByteArray lRecord;
+
+    if (mFormat == BinaryExport) {
+        QDataStream lStream(&lRecord, QIODevice::WriteOnly);
+        lStream.setByteOrder(QDataStream::LittleEndian);
+        lStream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+        lStream << quint32(0) // record size, set below
+                << quint32(aLayer) << quint32(aLoop) << quint32(lRuns.edgeCount())
+                << quint32(lRuns.runs().count());
+        for (const FeatureRun &lRun : lRuns.runs()) {
+            const QPointF &lStart = aEdgeList.at(lRun.mFirstEdge)->getPoint1();
+            lStream << quint32(lRun.mKind) << qint64(lRun.mFeatureID) << quint32(lRun.mFirstEdge)
+                    << quint32(lRun.mEdgeCount) << lStart.x() << lStart.y() << lRun.mCenter.x()
+                    << lRun.mCenter.y() << lRun.mRadius;
+        }
+        qToLittleEndian<quint32>(quint32(lRecord.size() - sizeof(quint32)), lRecord.data());
+        return lRecord;
+    }
+
+    lRecord += "{\"layer\":" + QByteArray::number(aLayer);
+    lRecord += ",\"loop\":" + QByteArray::number(aLoop);
+    lRecord += ",\"edges\":" + QByteArray::number(lRuns.edgeCount());
+    lRecord += ",\"runs\":[";
+    for (int i = 0; i < lRuns.runs().count(); i++) {
+        const FeatureRun &lRun = lRuns.runs().at(i);
+        if (i > 0) {
+            lRecord += ',';
+        }
+        lRecord += "{\"kind\":\"" + featureKindName(lRun.mKind).toLatin1();
+        lRecord += "\",\"id\":" + QByteArray::number(qint64(lRun.mFeatureID));
+        lRecord += ",\"first\":" + QByteArray::number(lRun.mFirstEdge);
+        lRecord += ",\"count\":" + QByteArray::number(lRun.mEdgeCount);
+        lRecord += ",\"start\":";
+        appendJsonPoint(lRecord, aEdgeList.at(lRun.mFirstEdge)->getPoint1());
+        if (lRun.mKind == ArcFeature) {
+            lRecord += ",\"center\":";
+            appendJsonPoint(lRecord, lRun.mCenter);
+            lRecord += ",\"radius\":";
+            appendJsonNumber(lRecord, lRun.mRadius);
+        }
+        lRecord += '}';
+    }
+    lRecord += "]}\n";
+    return lRecord;
+}
+
+bool FeatureExportWriter::flushBuffer()
+{
+    if (!mBuffer.isEmpty()) {
+        const qint64 lWritten = mFile.write(mBuffer);
+        mOk = mOk && (lWritten == mBuffer.size());
+        mBytesWritten += qMax(lWritten, qint64(0));
+        mBuffer.resize(0);
+    }
+    mFlushTimer.start();
+    return mOk;
+}
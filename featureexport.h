@@ -0,0 +1,81 @@
+#ifndef FEATUREEXPORT_H
+#define FEATUREEXPORT_H
+
+#include "polygonedge.h"
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+enum FeatureExportFormat {
+    JsonLinesExport, // one JSON object per polygon and line
+    BinaryExport     // little endian records, see FeatureExportWriter
+};
+
+// Bytes kept before they are written to the file
+const int DEFAULT_EXPORT_BUFFER_SIZE = 1 << 20;
+// writePolygon() writes the buffer out after a record once it holds this many
+// bytes, or once this many ms passed since it was last written
+const int EXPORT_FLUSH_SIZE = 64 << 10;
+const int EXPORT_FLUSH_INTERVAL = 100;
+
+// Writes the feature runs of polygons (FeatureRunList) to a file as they are
+// detected, so that a path planner can read the results of a batch while it
+// runs. Records go through a buffer allocated when the file is opened, which
+// is written out after a record once EXPORT_FLUSH_SIZE bytes or
+// EXPORT_FLUSH_INTERVAL ms are pending, on flush() and on close(). The file
+// thus only ever ends on a complete record.
+//
+// JSON Lines : {"layer":0,"loop":1,"edges":120,"runs":[{"kind":"arc",
+// "id":50001,"first":4,"count":12,"start":[x,y],"center":[x,y],"radius":r},
+// ...]}, center and radius only on arcs.
+//
+// Binary : the header "PFXR" and version as quint32, then per polygon the
+// size of the rest of the record, layer, loop, edge count and run count as
+// quint32, and per run the kind (FeatureKind) as quint32, feature ID as qint64,
+// first edge and edge count as quint32, then start x, start y, center x,
+// center y and radius as doubles (0 unless an arc).
+//
+// writePolygon() can be called from several threads; records of polygons
+// written concurrently are in no particular order.
+class FeatureExportWriter
+{
+public:
+    explicit FeatureExportWriter(const FeatureExportFormat aFormat = JsonLinesExport,
+                                 const int aBufferSize = DEFAULT_EXPORT_BUFFER_SIZE);
+    ~FeatureExportWriter();
+
+    // Creates or truncates aFilePath, "-" for stdout
+    bool open(const QString &aFilePath);
+    // Writes what is buffered, false if anything failed to be written
+    bool close();
+    bool isOpen() const;
+
+    // Appends the record of the labels left on aEdgeList by a detection
+    bool writePolygon(const int aLayer, const int aLoop, const QList<PolygonEdge *> &aEdgeList);
+    bool flush();
+
+    int polygonCount() const;
+    qint64 bytesWritten() const;
+
+private:
+    QByteArray encodePolygon(const int aLayer,
+                             const int aLoop,
+                             const QList<PolygonEdge *> &aEdgeList) const;
+    bool flushBuffer();
+
+    const FeatureExportFormat mFormat;
+    const int mBufferSize;
+    const int mFlushSize;
+    mutable QMutex mMutex;
+    QFile mFile;
+    QByteArray mBuffer;
+    QElapsedTimer mFlushTimer; // since the buffer was last written
+    bool mOk;
+    int mPolygonCount;
+    qint64 mBytesWritten;
+};
+
+#endif // FEATUREEXPORT_H
@@ -0,0 +1,355 @@
+#include "featureresultcache.h"
+#include "hashcombine.h"
+#include <math.h>
+#include <QDataStream>
+#include <QMutexLocker>
+
+// 64-bit finalizer (splitmix64), spreads the combined edge hashes before they
+// are summed
+static quint64 mixHash(quint64 aValue)
+{
+    aValue ^= aValue >> 30;
+    aValue *= Q_UINT64_C(0xbf58476d1ce4e5b9);
+    aValue ^= aValue >> 27;
+    aValue *= Q_UINT64_C(0x94d049bb133111eb);
+    aValue ^= aValue >> 31;
+    return aValue;
+}
+
+FeatureResultCache::FeatureResultCache(const int aCapacity, const double aQuantum)
+    : mCapacity(aCapacity)
+    , mQuantum(aQuantum)
+    , mHits(0)
+    , mMisses(0)
+    , mDiskCache(nullptr)
+{}
+
+void FeatureResultCache::quantize(const QList<PolygonEdge *> &aEdgeList,
+                                  QVector<GridPoint> &aVertices) const
+{
+    aVertices.resize(aEdgeList.count());
+    for (int i = 0; i < aEdgeList.count(); i++) {
+        aVertices[i] = GridPoint::snap(aEdgeList.at(i)->getPoint1(), mQuantum);
+    }
+}
+
+static bool lessThan(const GridPoint &aFirst, const GridPoint &aSecond)
+{
+    return aFirst.mX < aSecond.mX || (aFirst.mX == aSecond.mX && aFirst.mY < aSecond.mY);
+}
+
+int FeatureResultCache::canonicalStart(const QVector<GridPoint> &aVertices)
+{
+    // Start of the least rotation : the least vertex, and if it occurs more
+    // than once, the occurrence followed by the least vertices
+    const int lCount = aVertices.count();
+    int lStart = 0;
+    for (int i = 1; i < lCount; i++) {
+        if (lessThan(aVertices.at(i), aVertices.at(lStart))) {
+            lStart = i;
+        }
+    }
+    for (int r = lStart + 1; r < lCount; r++) {
+        if (aVertices.at(r) != aVertices.at(lStart)) {
+            continue;
+        }
+        for (int i = 1; i < lCount; i++) {
+            const GridPoint &lCandidate = aVertices.at((r + i) % lCount);
+            const GridPoint &lBest = aVertices.at((lStart + i) % lCount);
+            if (lCandidate != lBest) {
+                if (lessThan(lCandidate, lBest)) {
+                    lStart = r;
+                }
+                break;
+            }
+        }
+    }
+    return lStart;
+}
+
+void FeatureResultCache::canonicalize(const QList<PolygonEdge *> &aEdgeList,
+                                      QVector<GridPoint> &aVertices,
+                                      int &aStart) const
+{
+    QVector<GridPoint> lVertices;
+    quantize(aEdgeList, lVertices);
+    aStart = canonicalStart(lVertices);
+    const int lCount = lVertices.count();
+    aVertices.resize(lCount);
+    for (int i = 0; i < lCount; i++) {
+        aVertices[i] = lVertices.at((aStart + i) % lCount);
+    }
+}
+
+quint64 FeatureResultCache::canonicalHash(const QVector<GridPoint> &aVertices)
+{
+    std::size_t lSeed = 0;
+    hash_combine(lSeed, aVertices.count());
+    for (const GridPoint &lVertex : aVertices) {
+        hash_combine(lSeed, lVertex);
+    }
+    return mixHash(quint64(lSeed));
+}
+
+quint64 FeatureResultCache::contentHash(const QList<PolygonEdge *> &aEdgeList) const
+{
+    // Hash of the quantized vertices from the canonical start vertex, so the
+    // start vertex of the loop doesn't matter
+    QVector<GridPoint> lVertices;
+    int lStart = 0;
+    canonicalize(aEdgeList, lVertices, lStart);
+    return canonicalHash(lVertices);
+}
+
+quint64 FeatureResultCache::parameterHash(const DetectionParameters &aParams)
+{
+    std::size_t lSeed = 0;
+    hash_combine(lSeed, int(aParams.mMode));
+    hash_combine(lSeed, int(aParams.mCoordinates));
+    hash_combine(lSeed, int(aParams.mPrecision));
+    hash_combine(lSeed, aParams.mCheckLines);
+    hash_combine(lSeed, aParams.mCheckArcs);
+    hash_combine(lSeed, aParams.mCheckSplines);
+    hash_combine(lSeed, aParams.mCheckSharpEdges);
+    hash_combine(lSeed, aParams.mLineTolerance);
+    hash_combine(lSeed, aParams.mArcTolerance);
+    hash_combine(lSeed, aParams.mSplineTolerance);
+    hash_combine(lSeed, aParams.mSharpAngleTolerance);
+    return mixHash(quint64(lSeed));
+}
+
+bool FeatureResultCache::sameParameters(const DetectionParameters &aFirst,
+                                        const DetectionParameters &aSecond)
+{
+    return aFirst.mMode == aSecond.mMode && aFirst.mCoordinates == aSecond.mCoordinates
+           && aFirst.mPrecision == aSecond.mPrecision
+           && aFirst.mCheckLines == aSecond.mCheckLines
+           && aFirst.mCheckArcs == aSecond.mCheckArcs
+           && aFirst.mCheckSplines == aSecond.mCheckSplines
+           && aFirst.mCheckSharpEdges == aSecond.mCheckSharpEdges
+           && aFirst.mLineTolerance == aSecond.mLineTolerance
+           && aFirst.mArcTolerance == aSecond.mArcTolerance
+           && aFirst.mSplineTolerance == aSecond.mSplineTolerance
+           && aFirst.mSharpAngleTolerance == aSecond.mSharpAngleTolerance;
+}
+
+bool FeatureResultCache::sameContent(const QList<PolygonEdge *> &aFirst,
+                                     const QList<PolygonEdge *> &aSecond) const
+{
+    // Same quantized polygon, whatever the start vertex
+    QVector<GridPoint> lFirst, lSecond;
+    int lFirstStart = 0, lSecondStart = 0;
+    canonicalize(aFirst, lFirst, lFirstStart);
+    canonicalize(aSecond, lSecond, lSecondStart);
+    return lFirst == lSecond;
+}
+
+bool FeatureResultCache::applyEntry(const Entry &aEntry,
+                                    const QVector<GridPoint> &aVertices,
+                                    const int aStart,
+                                    QList<PolygonEdge *> &aEdgeList,
+                                    DetectionResult &aResult)
+{
+    // aVertices start at the canonical vertex, which is edge aStart of the
+    // loop; a mismatch is a hash collision
+    if (aEntry.mVertices != aVertices) {
+        return false;
+    }
+
+    const int lCount = aEdgeList.count();
+    for (int i = 0; i < lCount; i++) {
+        const int lStoredIdx = (i - aStart + lCount) % lCount;
+        PolygonEdge *lEdge = aEdgeList.at(i);
+        lEdge->setFeatureID(aEntry.mFeatureIDs.at(lStoredIdx));
+        lEdge->setSharpEdgeID(aEntry.mSharpEdgeIDs.at(lStoredIdx));
+        lEdge->setSplineError(aEntry.mSplineErrors.at(lStoredIdx));
+    }
+    aResult = aEntry.mResult;
+    return true;
+}
+
+bool FeatureResultCache::lookup(QList<PolygonEdge *> &aEdgeList,
+                                const DetectionParameters &aParams,
+                                DetectionResult &aResult)
+{
+    QVector<GridPoint> lVertices;
+    int lStart = 0;
+    canonicalize(aEdgeList, lVertices, lStart);
+    const quint64 lContentHash = canonicalHash(lVertices);
+    const quint64 lParameterHash = parameterHash(aParams);
+    const quint64 lKey = lContentHash ^ lParameterHash;
+
+    {
+        QMutexLocker lLocker(&mMutex);
+        auto lEntry = mEntries.constFind(lKey);
+        if (lEntry != mEntries.constEnd() && sameParameters(lEntry->mParams, aParams)
+            && applyEntry(*lEntry, lVertices, lStart, aEdgeList, aResult)) {
+            mHits++;
+            return true;
+        }
+    }
+
+    // stored by an earlier run
+    QByteArray lPayload;
+    Entry lEntry;
+    if (mDiskCache != nullptr
+        && mDiskCache->find(DiskRecordKey(lContentHash, lParameterHash, DetectionRecord), lPayload)
+        && readEntry(lPayload, lEntry) && sameParameters(lEntry.mParams, aParams)
+        && applyEntry(lEntry, lVertices, lStart, aEdgeList, aResult)) {
+        QMutexLocker lLocker(&mMutex);
+        storeEntry(lKey, lEntry);
+        mHits++;
+        return true;
+    }
+
+    QMutexLocker lLocker(&mMutex);
+    mMisses++;
+    return false;
+}
+
+void FeatureResultCache::insert(const QList<PolygonEdge *> &aEdgeList,
+                                const DetectionParameters &aParams,
+                                const DetectionResult &aResult)
+{
+    if (mCapacity <= 0 && mDiskCache == nullptr) {
+        return;
+    }
+
+    // stored from the canonical start vertex
+    Entry lEntry;
+    int lStart = 0;
+    canonicalize(aEdgeList, lEntry.mVertices, lStart);
+    const quint64 lContentHash = canonicalHash(lEntry.mVertices);
+    const quint64 lParameterHash = parameterHash(aParams);
+    lEntry.mParams = aParams;
+    lEntry.mResult = aResult;
+    const int lCount = aEdgeList.count();
+    lEntry.mFeatureIDs.resize(lCount);
+    lEntry.mSharpEdgeIDs.resize(lCount);
+    lEntry.mSplineErrors.resize(lCount);
+    for (int i = 0; i < lCount; i++) {
+        const PolygonEdge *lEdge = aEdgeList.at((lStart + i) % lCount);
+        lEntry.mFeatureIDs[i] = lEdge->getFeatureID();
+        lEntry.mSharpEdgeIDs[i] = lEdge->getSharpEdgeID();
+        lEntry.mSplineErrors[i] = lEdge->getSplineError();
+    }
+
+    {
+        QMutexLocker lLocker(&mMutex);
+        storeEntry(lContentHash ^ lParameterHash, lEntry);
+    }
+    if (mDiskCache != nullptr) {
+        mDiskCache->append(DiskRecordKey(lContentHash, lParameterHash, DetectionRecord),
+                           writeEntry(lEntry));
+    }
+}
+
+void FeatureResultCache::storeEntry(const quint64 aKey, const Entry &aEntry)
+{
+    // called with mMutex locked
+    if (mCapacity <= 0) {
+        return;
+    }
+    if (!mEntries.contains(aKey)) {
+        // oldest entries go first
+        while (mEntries.count() >= mCapacity && !mInsertOrder.isEmpty()) {
+            mEntries.remove(mInsertOrder.dequeue());
+        }
+        mInsertOrder.enqueue(aKey);
+    }
+    mEntries.insert(aKey, aEntry);
+}
+
+QByteArray FeatureResultCache::writeEntry(const Entry &aEntry)
+{
+    QByteArray lPayload;
+    QDataStream lStream(&lPayload, QIODevice::WriteOnly);
+    lStream << qint32(aEntry.mVertices.count());
+    for (const GridPoint &lVertex : aEntry.mVertices) {
+        lStream << lVertex.mX << lVertex.mY;
+    }
+
+    const DetectionParameters &lParams = aEntry.mParams;
+    lStream << qint32(lParams.mMode) << qint32(lParams.mCoordinates) << qint32(lParams.mPrecision)
+            << lParams.mCheckLines << lParams.mCheckArcs << lParams.mCheckSplines
+            << lParams.mCheckSharpEdges << lParams.mLineTolerance << lParams.mArcTolerance
+            << lParams.mSplineTolerance << lParams.mSharpAngleTolerance;
+
+    const DetectionResult &lResult = aEntry.mResult;
+    lStream << qint32(lResult.mNumLines) << qint32(lResult.mNumArcs) << qint32(lResult.mNumSplines)
+            << qint32(lResult.mNumSharpEdges);
+
+    for (int i = 0; i < aEntry.mVertices.count(); i++) {
+        lStream << qint64(aEntry.mFeatureIDs.at(i)) << qint64(aEntry.mSharpEdgeIDs.at(i))
+                << aEntry.mSplineErrors.at(i);
+    }
+    return lPayload;
+}
+
+bool FeatureResultCache::readEntry(const QByteArray &aPayload, Entry &aEntry)
+{
+    QDataStream lStream(aPayload);
+    qint32 lCount = 0;
+    lStream >> lCount;
+    if (lCount < 0 || lCount > aPayload.size() || lStream.status() != QDataStream::Ok) {
+        return false;
+    }
+    aEntry.mVertices.resize(lCount);
+    for (int i = 0; i < lCount; i++) {
+        lStream >> aEntry.mVertices[i].mX >> aEntry.mVertices[i].mY;
+    }
+
+    DetectionParameters &lParams = aEntry.mParams;
+    qint32 lMode = 0, lCoordinates = 0, lPrecision = 0;
+    lStream >> lMode >> lCoordinates >> lPrecision >> lParams.mCheckLines >> lParams.mCheckArcs
+        >> lParams.mCheckSplines >> lParams.mCheckSharpEdges >> lParams.mLineTolerance
+        >> lParams.mArcTolerance >> lParams.mSplineTolerance >> lParams.mSharpAngleTolerance;
+    lParams.mMode = DetectionMode(lMode);
+    lParams.mCoordinates = CoordinateMode(lCoordinates);
+    lParams.mPrecision = ScalarPrecision(lPrecision);
+
+    qint32 lNumLines = 0, lNumArcs = 0, lNumSplines = 0, lNumSharpEdges = 0;
+    lStream >> lNumLines >> lNumArcs >> lNumSplines >> lNumSharpEdges;
+    aEntry.mResult.mNumLines = lNumLines;
+    aEntry.mResult.mNumArcs = lNumArcs;
+    aEntry.mResult.mNumSplines = lNumSplines;
+    aEntry.mResult.mNumSharpEdges = lNumSharpEdges;
+
+    aEntry.mFeatureIDs.resize(lCount);
+    aEntry.mSharpEdgeIDs.resize(lCount);
+    aEntry.mSplineErrors.resize(lCount);
+    for (int i = 0; i < lCount; i++) {
+        qint64 lFeatureID = 0, lSharpEdgeID = 0;
+        lStream >> lFeatureID >> lSharpEdgeID >> aEntry.mSplineErrors[i];
+        aEntry.mFeatureIDs[i] = lFeatureID;
+        aEntry.mSharpEdgeIDs[i] = lSharpEdgeID;
+    }
+    return lStream.status() == QDataStream::Ok;
+}
+
+void FeatureResultCache::clear()
+{
+    QMutexLocker lLocker(&mMutex);
+    mEntries.clear();
+    mInsertOrder.clear();
+    mHits = 0;
+    mMisses = 0;
+}
+
+int FeatureResultCache::count() const
+{
+    QMutexLocker lLocker(&mMutex);
+    return mEntries.count();
+}
+
+int FeatureResultCache::hitCount() const
+{
+    QMutexLocker lLocker(&mMutex);
+    return mHits;
+}
+
+int FeatureResultCache::missCount() const
+{
+    QMutexLocker lLocker(&mMutex);
+    return mMisses;
+}
@@ -0,0 +1,101 @@
+#ifndef FEATURERESULTCACHE_H
+#define FEATURERESULTCACHE_H
+
+#include "detectiontypes.h"
+#include "diskresultcache.h"
+#include "gridhash.h"
+#include "polygonedge.h"
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QQueue>
+#include <QVector>
+
+const int DEFAULT_RESULT_CACHE_CAPACITY = 256;
+
+// Detection results keyed by polygon content and detection parameters, so a
+// layer that repeats an earlier one (e.g. the walls of a prismatic part) gets
+// its labels without running the checks again.
+//
+// Loops are stored from a canonical start vertex (the least quantized vertex),
+// so the content hash does not depend on where a loop starts : a copy of a
+// layer starting at another vertex hits the same entry and gets the stored
+// labels rotated onto its own edges. Those carry the feature breaks and the
+// numbering of the copy that was detected, which can differ from a detection
+// of the rotated copy next to its own seam. Lookups compare the quantized
+// vertices, so hash collisions never return the labels of a different polygon.
+// The cache can be shared between threads.
+//
+// With a DiskResultCache attached, entries are also written to disk, and
+// looked up there when they are not in memory, so results survive the process.
+class FeatureResultCache
+{
+public:
+    FeatureResultCache(const int aCapacity = DEFAULT_RESULT_CACHE_CAPACITY,
+                       const double aQuantum = DEFAULT_HASH_QUANTUM);
+
+    // Labels aEdgeList from a stored result, returns false on a miss
+    bool lookup(QList<PolygonEdge *> &aEdgeList,
+                const DetectionParameters &aParams,
+                DetectionResult &aResult);
+
+    // Stores the current labels of aEdgeList for aParams
+    void insert(const QList<PolygonEdge *> &aEdgeList,
+                const DetectionParameters &aParams,
+                const DetectionResult &aResult);
+
+    void clear();
+
+    // Backs the cache with aDiskCache (not owned), nullptr to detach it
+    void setDiskCache(DiskResultCache *aDiskCache) { mDiskCache = aDiskCache; }
+    DiskResultCache *diskCache() const { return mDiskCache; }
+
+    int count() const;
+    int hitCount() const;
+    int missCount() const;
+
+    quint64 contentHash(const QList<PolygonEdge *> &aEdgeList) const;
+    bool sameContent(const QList<PolygonEdge *> &aFirst,
+                     const QList<PolygonEdge *> &aSecond) const;
+    static quint64 parameterHash(const DetectionParameters &aParams);
+
+private:
+    class Entry
+    {
+    public:
+        QVector<GridPoint> mVertices; // start points, from the canonical one
+        DetectionParameters mParams;
+        DetectionResult mResult;
+        QVector<long> mFeatureIDs, mSharpEdgeIDs;
+        QVector<double> mSplineErrors;
+    };
+
+    static bool applyEntry(const Entry &aEntry,
+                           const QVector<GridPoint> &aVertices,
+                           const int aStart,
+                           QList<PolygonEdge *> &aEdgeList,
+                           DetectionResult &aResult);
+    void storeEntry(const quint64 aKey, const Entry &aEntry);
+    static QByteArray writeEntry(const Entry &aEntry);
+    static bool readEntry(const QByteArray &aPayload, Entry &aEntry);
+
+    void quantize(const QList<PolygonEdge *> &aEdgeList, QVector<GridPoint> &aVertices) const;
+    // Quantized start points from the canonical one, which is edge aStart
+    void canonicalize(const QList<PolygonEdge *> &aEdgeList,
+                      QVector<GridPoint> &aVertices,
+                      int &aStart) const;
+    static int canonicalStart(const QVector<GridPoint> &aVertices);
+    static quint64 canonicalHash(const QVector<GridPoint> &aVertices);
+    static bool sameParameters(const DetectionParameters &aFirst,
+                               const DetectionParameters &aSecond);
+
+    const int mCapacity;
+    const double mQuantum;
+    mutable QMutex mMutex;
+    QHash<quint64, Entry> mEntries;
+    QQueue<quint64> mInsertOrder;
+    int mHits, mMisses;
+    DiskResultCache *mDiskCache;
+};
+
+#endif // FEATURERESULTCACHE_H
@@ -0,0 +1,218 @@
+#include "featureruns.h"
+#include "Spline.h"
+#include <algorithm>
+#include <math.h>
+
+FeatureKind featureKind(const long aFeatureID)
+{
+    if (aFeatureID > SPLINE_FEATURE_ID) {
+        return SplineFeature;
+    } else if (aFeatureID > ARC_FEATURE_ID) {
+        return ArcFeature;
+    } else if (aFeatureID > LINE_FEATURE_ID) {
+        return LineFeature;
+    }
+    return NoFeature;
+}
+
+QString featureKindName(const FeatureKind aKind)
+{
+    switch (aKind) {
+    case LineFeature:
+        return "line";
+    case ArcFeature:
+        return "arc";
+    case SplineFeature:
+        return "spline";
+    default:
+        return "none";
+    }
+}
+
+QPointF SplineSegment::pointAt(const double t) const
+{
+    return QPointF(((mX[3] * t + mX[2]) * t + mX[1]) * t + mX[0],
+                   ((mY[3] * t + mY[2]) * t + mY[1]) * t + mY[0]);
+}
+
+// Vertex i of aRun, from its first vertex (i = 0) to its last (i = mEdgeCount)
+static const QPointF &runVertex(const QList<PolygonEdge *> &aEdgeList,
+                                const FeatureRun &aRun,
+                                const int i)
+{
+    if (i < aRun.mEdgeCount) {
+        return aEdgeList.at(aRun.mFirstEdge + i)->getPoint1();
+    }
+    return aEdgeList.at(aRun.lastEdge())->getPoint2();
+}
+
+FeatureRunList::FeatureRunList()
+    : mEdgeCount(0)
+{}
+
+FeatureRunList FeatureRunList::fromEdges(const QList<PolygonEdge *> &aEdgeList)
+{
+    FeatureRunList lList;
+    lList.mEdgeCount = aEdgeList.count();
+    int i = 0;
+    while (i < aEdgeList.count()) {
+        const long lFeatureID = aEdgeList.at(i)->getFeatureID();
+        int lEnd = i + 1;
+        while (lEnd < aEdgeList.count() && aEdgeList.at(lEnd)->getFeatureID() == lFeatureID) {
+            lEnd++;
+        }
+        if (lFeatureID != 0) {
+            FeatureRun lRun;
+            lRun.mKind = featureKind(lFeatureID);
+            lRun.mFeatureID = lFeatureID;
+            lRun.mFirstEdge = i;
+            lRun.mEdgeCount = lEnd - i;
+            if (lRun.mKind == ArcFeature) {
+                lList.fitArc(aEdgeList, lRun);
+            } else if (lRun.mKind == SplineFeature) {
+                lList.fitSpline(aEdgeList, lRun);
+            }
+            lList.mRuns.append(lRun);
+        }
+        i = lEnd;
+    }
+
+    for (int k = 0; k < aEdgeList.count(); k++) {
+        const long lSharpEdgeID = aEdgeList.at(k)->getSharpEdgeID();
+        if (k == 0 || lSharpEdgeID != lList.mSharpGroupIDs.last()) {
+            lList.mSharpGroupStarts.append(k);
+            lList.mSharpGroupIDs.append(lSharpEdgeID);
+        }
+    }
+    return lList;
+}
+
+void FeatureRunList::fitArc(const QList<PolygonEdge *> &aEdgeList, FeatureRun &aRun) const
+{
+    const QPointF &p1 = runVertex(aEdgeList, aRun, 0);
+    const QPointF &p2 = runVertex(aEdgeList, aRun, (aRun.mEdgeCount + 1) / 2);
+    const QPointF &p3 = runVertex(aEdgeList, aRun, aRun.mEdgeCount);
+
+    // relative to p1, so the centre keeps its digits far from the origin
+    const double bx = p2.x() - p1.x(), by = p2.y() - p1.y();
+    const double cx = p3.x() - p1.x(), cy = p3.y() - p1.y();
+    const double d = 2.0 * (bx * cy - by * cx);
+    if (d == 0.0) {
+        return;
+    }
+    const double b2 = bx * bx + by * by;
+    const double c2 = cx * cx + cy * cy;
+    const double ux = (cy * b2 - by * c2) / d;
+    const double uy = (bx * c2 - cx * b2) / d;
+    aRun.mCenter = QPointF(p1.x() + ux, p1.y() + uy);
+    aRun.mRadius = sqrt(ux * ux + uy * uy);
+}
+
+void FeatureRunList::fitSpline(const QList<PolygonEdge *> &aEdgeList, FeatureRun &aRun)
+{
+    // natural cubic splines of x and y over the chord length, which (unlike x)
+    // increases along any run without zero length edges
+    const int lVertexCount = aRun.mEdgeCount + 1;
+    QPolygonF lX(lVertexCount), lY(lVertexCount);
+    double t = 0.0;
+    for (int i = 0; i < lVertexCount; i++) {
+        const QPointF &p = runVertex(aEdgeList, aRun, i);
+        if (i > 0) {
+            const QPointF &lPrevious = runVertex(aEdgeList, aRun, i - 1);
+            t += hypot(p.x() - lPrevious.x(), p.y() - lPrevious.y());
+        }
+        lX[i] = QPointF(t, p.x());
+        lY[i] = QPointF(t, p.y());
+    }
+
+    QVector<SplineSegment> lSegments(aRun.mEdgeCount);
+    if (lVertexCount == 2) {
+        // too short for Spline, a straight segment
+        const double lLength = lX.at(1).x();
+        if (!(lLength > 0.0)) {
+            return;
+        }
+        SplineSegment &lSegment = lSegments[0];
+        lSegment.mLength = lLength;
+        lSegment.mX[0] = lX.at(0).y();
+        lSegment.mX[1] = (lX.at(1).y() - lX.at(0).y()) / lLength;
+        lSegment.mY[0] = lY.at(0).y();
+        lSegment.mY[1] = (lY.at(1).y() - lY.at(0).y()) / lLength;
+        lSegment.mX[2] = lSegment.mX[3] = lSegment.mY[2] = lSegment.mY[3] = 0.0;
+    } else {
+        Spline lSplineX, lSplineY;
+        if (!lSplineX.setPoints(lX) || !lSplineY.setPoints(lY)) {
+            return;
+        }
+        for (int i = 0; i < aRun.mEdgeCount; i++) {
+            SplineSegment &lSegment = lSegments[i];
+            lSegment.mLength = lX.at(i + 1).x() - lX.at(i).x();
+            lSegment.mX[0] = lX.at(i).y();
+            lSegment.mY[0] = lY.at(i).y();
+            lSplineX.coefficients(i, lSegment.mX[3], lSegment.mX[2], lSegment.mX[1]);
+            lSplineY.coefficients(i, lSegment.mY[3], lSegment.mY[2], lSegment.mY[1]);
+        }
+    }
+    aRun.mSplineOffset = mSplineSegments.count();
+    mSplineSegments << lSegments;
+}
+
+int FeatureRunList::runIndex(const int aEdge) const
+{
+    auto lOver = std::upper_bound(mRuns.begin(),
+                                  mRuns.end(),
+                                  aEdge,
+                                  [](const int aValue, const FeatureRun &aRun) {
+                                      return aValue < aRun.mFirstEdge;
+                                  });
+    if (lOver == mRuns.begin() || (lOver - 1)->lastEdge() < aEdge) {
+        return -1;
+    }
+    return int(lOver - mRuns.begin()) - 1;
+}
+
+long FeatureRunList::featureID(const int aEdge) const
+{
+    const int lRun = runIndex(aEdge);
+    return (lRun >= 0) ? mRuns.at(lRun).mFeatureID : 0;
+}
+
+long FeatureRunList::sharpEdgeID(const int aEdge) const
+{
+    auto lOver = std::upper_bound(mSharpGroupStarts.begin(), mSharpGroupStarts.end(), aEdge);
+    if (lOver == mSharpGroupStarts.begin()) {
+        return DEFAULT_SHARPEDGE_ID;
+    }
+    return mSharpGroupIDs.at(int(lOver - mSharpGroupStarts.begin()) - 1);
+}
+
+QVector<long> FeatureRunList::featureIDs() const
+{
+    QVector<long> lIDs(mEdgeCount, 0);
+    for (const FeatureRun &lRun : mRuns) {
+        std::fill(lIDs.begin() + lRun.mFirstEdge,
+                  lIDs.begin() + lRun.mFirstEdge + lRun.mEdgeCount,
+                  lRun.mFeatureID);
+    }
+    return lIDs;
+}
+
+QVector<long> FeatureRunList::sharpEdgeIDs() const
+{
+    QVector<long> lIDs(mEdgeCount, DEFAULT_SHARPEDGE_ID);
+    for (int j = 0; j < mSharpGroupStarts.count(); j++) {
+        const int lEnd = (j + 1 < mSharpGroupStarts.count()) ? mSharpGroupStarts.at(j + 1)
+                                                              : mEdgeCount;
+        std::fill(lIDs.begin() + mSharpGroupStarts.at(j),
+                  lIDs.begin() + lEnd,
+                  mSharpGroupIDs.at(j));
+    }
+    return lIDs;
+}
+
+qint64 FeatureRunList::byteSize() const
+{
+    return qint64(sizeof(*this)) + mRuns.count() * qint64(sizeof(FeatureRun))
+           + mSplineSegments.count() * qint64(sizeof(SplineSegment))
+           + mSharpGroupStarts.count() * qint64(sizeof(int) + sizeof(long));
+}
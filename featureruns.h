@@ -0,0 +1,98 @@
+#ifndef FEATURERUNS_H
+#define FEATURERUNS_H
+
+#include "polygonedge.h"
+#include <QList>
+#include <QPointF>
+#include <QString>
+#include <QVector>
+
+enum FeatureKind { NoFeature, LineFeature, ArcFeature, SplineFeature };
+
+// Kind of the feature IDs given by each check, see LINE_FEATURE_ID
+FeatureKind featureKind(const long aFeatureID);
+QString featureKindName(const FeatureKind aKind);
+
+// aEdgeCount consecutive edges with the same feature ID. The geometry is only
+// set on the runs of a FeatureRunList.
+class FeatureRun
+{
+public:
+    FeatureRun()
+        : mKind(NoFeature)
+        , mFeatureID(0)
+        , mFirstEdge(0)
+        , mEdgeCount(0)
+        , mRadius(0.0)
+        , mSplineOffset(-1)
+    {}
+
+    int lastEdge() const { return mFirstEdge + mEdgeCount - 1; }
+
+    FeatureKind mKind;
+    long mFeatureID;
+    int mFirstEdge, mEdgeCount;
+    // arcs : circle through the first, middle and last vertex of the run,
+    // radius 0 when they are collinear
+    QPointF mCenter;
+    double mRadius;
+    // splines : first of the mEdgeCount segments of the run in
+    // FeatureRunList::splineSegments(), -1 when none could be fitted
+    int mSplineOffset;
+};
+
+// One edge of a spline run as a cubic in the chord length t from its first
+// vertex, 0 <= t <= mLength : x(t) = ((mX[3] * t + mX[2]) * t + mX[1]) * t + mX[0],
+// and the same for y
+class SplineSegment
+{
+public:
+    QPointF pointAt(const double t) const;
+
+    double mLength;
+    double mX[4];
+    double mY[4];
+};
+
+// The labels of an edge list as runs : one entry per feature and per
+// sharp-angle group instead of three per edge, with the arc centre and radius
+// or the spline of every feature. Enough for a slicer to emit the features
+// without going over the edges again; the per-edge labels are there as a view.
+class FeatureRunList
+{
+public:
+    FeatureRunList();
+
+    // Runs of the labels left on aEdgeList by a detection. Edges with feature
+    // ID 0 are between runs.
+    static FeatureRunList fromEdges(const QList<PolygonEdge *> &aEdgeList);
+
+    int edgeCount() const { return mEdgeCount; }
+    const QVector<FeatureRun> &runs() const { return mRuns; }
+    const QVector<SplineSegment> &splineSegments() const { return mSplineSegments; }
+
+    // Per-edge view, a binary search over the runs
+    int runIndex(const int aEdge) const; // -1 for an edge with feature ID 0
+    long featureID(const int aEdge) const;
+    long sharpEdgeID(const int aEdge) const;
+
+    // The labels of all edges, as on the edge list
+    QVector<long> featureIDs() const;
+    QVector<long> sharpEdgeIDs() const;
+
+    // Memory held, to compare with the per-edge labels
+    qint64 byteSize() const;
+
+private:
+    void fitArc(const QList<PolygonEdge *> &aEdgeList, FeatureRun &aRun) const;
+    void fitSpline(const QList<PolygonEdge *> &aEdgeList, FeatureRun &aRun);
+
+    int mEdgeCount;
+    QVector<FeatureRun> mRuns;
+    QVector<SplineSegment> mSplineSegments;
+    // first edge and sharp edge ID of every run of equal sharp edge IDs
+    QVector<int> mSharpGroupStarts;
+    QVector<long> mSharpGroupIDs;
+};
+
+#endif // FEATURERUNS_H
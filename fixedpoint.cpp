@@ -0,0 +1,20 @@
+#include "fixedpoint.h"
+#include <math.h>
+
+bool toFixedPoint(const double aValue, qint32 &aFixed)
+{
+    const double lScaled = floor(aValue * FIXED_POINT_UNITS_PER_MM + 0.5);
+    if (!(fabs(lScaled) <= FIXED_POINT_LIMIT)) {
+        return false; // out of range or nan
+    }
+    aFixed = qint32(lScaled);
+    return fromFixedPoint(aFixed) == aValue;
+}
+
+double fixedEdgeAngle(const qint64 aDx, const qint64 aDy)
+{
+    if (aDx == 0) {
+        return 90;
+    }
+    return (atan2(double(aDy), double(aDx))) * (180 / 3.14);
+}
@@ -0,0 +1,57 @@
+#ifndef FIXEDPOINT_H
+#define FIXEDPOINT_H
+
+#include <QtGlobal>
+
+// Coordinates the edge geometry of a detection run is computed from
+enum CoordinateMode {
+    FloatingPointCoordinates, // the doubles of the edge end points
+    FixedPointCoordinates     // integer micrometres, see toFixedPoint()
+};
+
+// G-code coordinates have 3 decimals, so they are integers in micrometres
+const int FIXED_POINT_UNITS_PER_MM = 1000;
+
+// Largest fixed point coordinate (about 537 m). Differences then fit in 30
+// bits, and the squared edge lengths and the cross products of
+// fixedOrientation() in an int64.
+const qint32 FIXED_POINT_LIMIT = (1 << 29) - 1;
+
+// Fixed point value of aValue millimetres, false when aValue is not on the
+// micrometre grid (the value back in millimetres is not exactly aValue) or
+// out of range
+bool toFixedPoint(const double aValue, qint32 &aFixed);
+
+inline double fromFixedPoint(const qint32 aFixed)
+{
+    return double(aFixed) / FIXED_POINT_UNITS_PER_MM;
+}
+
+// Twice the signed area of the triangle (x1, y1), (x2, y2), (x3, y3) : > 0
+// when counter-clockwise, 0 when collinear. Exact for coordinates within
+// FIXED_POINT_LIMIT.
+inline qint64 fixedOrientation(const qint32 x1,
+                               const qint32 y1,
+                               const qint32 x2,
+                               const qint32 y2,
+                               const qint32 x3,
+                               const qint32 y3)
+{
+    return (qint64(x2) - x1) * (qint64(y3) - y1) - (qint64(y2) - y1) * (qint64(x3) - x1);
+}
+
+inline bool fixedCollinear(const qint32 x1,
+                           const qint32 y1,
+                           const qint32 x2,
+                           const qint32 y2,
+                           const qint32 x3,
+                           const qint32 y3)
+{
+    return fixedOrientation(x1, y1, x2, y2, x3, y3) == 0;
+}
+
+// Angle of the edge vector (aDx, aDy) in the degrees of PolygonEdge::getAngle(),
+// 90 exactly for vertical edges instead of within EPSILON of it
+double fixedEdgeAngle(const qint64 aDx, const qint64 aDy);
+
+#endif // FIXEDPOINT_H
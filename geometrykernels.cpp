@@ -0,0 +1,819 @@
+#include "geometrykernels.h"
+#include <atomic>
+#include <math.h>
+#include <QByteArray>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define GEOMETRY_KERNELS_X86
+#include <immintrin.h>
+#define KERNEL_TARGET(aTarget) __attribute__((target(aTarget)))
+#endif
+
+// AVX-512F has its own FMA instructions, which GCC would fuse a mul_pd and an
+// add_pd into. Clang only contracts within one expression.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+class KernelTable
+{
+public:
+    KernelIsa mIsa;
+    void (*mTurns)(const double *, const int, double *);
+    void (*mMinMax)(const double *, const int, double &, double &);
+    void (*mTurnsFloat)(const float *, const int, float *);
+    void (*mMinMaxFloat)(const float *, const int, float &, float &);
+    void (*mMinMaxFixed)(const qint32 *, const int, qint32 &, qint32 &);
+    void (*mCubic)(const double,
+                   const double,
+                   const double,
+                   const double,
+                   const double,
+                   const double *,
+                   const int,
+                   double *);
+    double (*mEdgeDistance)(const double,
+                            const double,
+                            const double,
+                            const double,
+                            const double *,
+                            const double *,
+                            const int,
+                            const double);
+};
+
+// Scalar kernels, also the tails of the vector ones
+
+template<typename Scalar>
+static void turnsScalar(const Scalar *aAngles, const int aCount, Scalar *aTurns)
+{
+    for (int i = 0; i < aCount - 1; i++) {
+        aTurns[i] = fabs(aAngles[i + 1] - aAngles[i]);
+    }
+}
+
+template<typename Scalar>
+static void minMaxScalar(const Scalar *aValues, const int aCount, Scalar &aMin, Scalar &aMax)
+{
+    for (int i = 0; i < aCount; i++) {
+        if (aValues[i] < aMin) {
+            aMin = aValues[i];
+        }
+        if (aValues[i] > aMax) {
+            aMax = aValues[i];
+        }
+    }
+}
+
+static void minMaxFixedScalar(const qint32 *aValues, const int aCount, qint32 &aMin, qint32 &aMax)
+{
+    for (int i = 0; i < aCount; i++) {
+        aMin = qMin(aMin, aValues[i]);
+        aMax = qMax(aMax, aValues[i]);
+    }
+}
+
+static void cubicScalar(const double aX0,
+                        const double aY0,
+                        const double aA,
+                        const double aB,
+                        const double aC,
+                        const double *aX,
+                        const int aCount,
+                        double *aY)
+{
+    for (int i = 0; i < aCount; i++) {
+        const double lDelta = aX[i] - aX0;
+        aY[i] = ((aA * lDelta + aB) * lDelta + aC) * lDelta + aY0;
+    }
+}
+
+static double edgeDistanceScalar(const double aX1,
+                                 const double aY1,
+                                 const double aX2,
+                                 const double aY2,
+                                 const double *aX,
+                                 const double *aY,
+                                 const int aCount,
+                                 const double aLeast)
+{
+    const double lMidX = (aX1 + aX2) / 2;
+    const double lMidY = (aY1 + aY2) / 2;
+    double lLeast = aLeast;
+    for (int i = 0; i < aCount; i++) {
+        const double lDx1 = aX[i] - aX1;
+        const double lDy1 = aY[i] - aY1;
+        const double lDx2 = aX[i] - aX2;
+        const double lDy2 = aY[i] - aY2;
+        const double lDx3 = aX[i] - lMidX;
+        const double lDy3 = aY[i] - lMidY;
+        const double lDist1 = sqrt(lDx1 * lDx1 + lDy1 * lDy1);
+        const double lDist2 = sqrt(lDx2 * lDx2 + lDy2 * lDy2);
+        const double lDist3 = sqrt(lDx3 * lDx3 + lDy3 * lDy3);
+        const double lError = sqrt(lDist1 * lDist1 + lDist2 * lDist2 + lDist3 * lDist3);
+        if (lError < lLeast) {
+            lLeast = lError;
+        }
+    }
+    return lLeast;
+}
+
+// Least of aLeast and aValues, for the lanes of a vector minimum (and the
+// greatest for a maximum)
+template<typename Scalar>
+static Scalar leastOf(const Scalar *aValues, const int aCount, const Scalar aLeast)
+{
+    Scalar lLeast = aLeast;
+    for (int i = 0; i < aCount; i++) {
+        if (aValues[i] < lLeast) {
+            lLeast = aValues[i];
+        }
+    }
+    return lLeast;
+}
+
+template<typename Scalar>
+static Scalar greatestOf(const Scalar *aValues, const int aCount, const Scalar aGreatest)
+{
+    Scalar lGreatest = aGreatest;
+    for (int i = 0; i < aCount; i++) {
+        if (aValues[i] > lGreatest) {
+            lGreatest = aValues[i];
+        }
+    }
+    return lGreatest;
+}
+
+static const KernelTable gScalarKernels = {ScalarKernels,
+                                           turnsScalar<double>,
+                                           minMaxScalar<double>,
+                                           turnsScalar<float>,
+                                           minMaxScalar<float>,
+                                           minMaxFixedScalar,
+                                           cubicScalar,
+                                           edgeDistanceScalar};
+
+#ifdef GEOMETRY_KERNELS_X86
+
+// The vector kernels below are the same for each width : lanes do what the
+// scalar loop does to one value, the remainder goes through the scalar kernel.
+// min_pd(a, b) and max_pd(a, b) return b unless a < b (a > b), like the
+// scalar compares. mul + add is never contracted, see fp-contract above.
+
+// SSE4.2, 2 lanes (4 for float and int32)
+
+KERNEL_TARGET("sse4.2")
+static void turnsSse42(const double *aAngles, const int aCount, double *aTurns)
+{
+    const __m128d lSign = _mm_set1_pd(-0.0);
+    int i = 0;
+    for (; i + 2 < aCount; i += 2) {
+        __m128d lDiff = _mm_sub_pd(_mm_loadu_pd(aAngles + i + 1), _mm_loadu_pd(aAngles + i));
+        _mm_storeu_pd(aTurns + i, _mm_andnot_pd(lSign, lDiff));
+    }
+    turnsScalar(aAngles + i, aCount - i, aTurns + i);
+}
+
+KERNEL_TARGET("sse4.2")
+static void minMaxSse42(const double *aValues, const int aCount, double &aMin, double &aMax)
+{
+    __m128d lMin = _mm_set1_pd(aMin);
+    __m128d lMax = _mm_set1_pd(aMax);
+    int i = 0;
+    for (; i + 2 <= aCount; i += 2) {
+        __m128d lValues = _mm_loadu_pd(aValues + i);
+        lMin = _mm_min_pd(lValues, lMin);
+        lMax = _mm_max_pd(lValues, lMax);
+    }
+    double lLanes[2];
+    _mm_storeu_pd(lLanes, lMin);
+    aMin = leastOf(lLanes, 2, aMin);
+    _mm_storeu_pd(lLanes, lMax);
+    aMax = greatestOf(lLanes, 2, aMax);
+    minMaxScalar(aValues + i, aCount - i, aMin, aMax);
+}
+
+KERNEL_TARGET("sse4.2")
+static void minMaxFixedSse42(const qint32 *aValues, const int aCount, qint32 &aMin, qint32 &aMax)
+{
+    __m128i lMin = _mm_set1_epi32(aMin);
+    __m128i lMax = _mm_set1_epi32(aMax);
+    int i = 0;
+    for (; i + 4 <= aCount; i += 4) {
+        __m128i lValues = _mm_loadu_si128((const __m128i *)(aValues + i));
+        lMin = _mm_min_epi32(lValues, lMin);
+        lMax = _mm_max_epi32(lValues, lMax);
+    }
+    qint32 lMinLanes[4], lMaxLanes[4];
+    _mm_storeu_si128((__m128i *)lMinLanes, lMin);
+    _mm_storeu_si128((__m128i *)lMaxLanes, lMax);
+    for (int j = 0; j < 4; j++) {
+        aMin = qMin(aMin, lMinLanes[j]);
+        aMax = qMax(aMax, lMaxLanes[j]);
+    }
+    minMaxFixedScalar(aValues + i, aCount - i, aMin, aMax);
+}
+
+KERNEL_TARGET("sse4.2")
+static void cubicSse42(const double aX0,
+                       const double aY0,
+                       const double aA,
+                       const double aB,
+                       const double aC,
+                       const double *aX,
+                       const int aCount,
+                       double *aY)
+{
+    const __m128d lX0 = _mm_set1_pd(aX0);
+    const __m128d lY0 = _mm_set1_pd(aY0);
+    const __m128d lA = _mm_set1_pd(aA);
+    const __m128d lB = _mm_set1_pd(aB);
+    const __m128d lC = _mm_set1_pd(aC);
+    int i = 0;
+    for (; i + 2 <= aCount; i += 2) {
+        __m128d lDelta = _mm_sub_pd(_mm_loadu_pd(aX + i), lX0);
+        __m128d lY = _mm_add_pd(_mm_mul_pd(lA, lDelta), lB);
+        lY = _mm_add_pd(_mm_mul_pd(lY, lDelta), lC);
+        lY = _mm_add_pd(_mm_mul_pd(lY, lDelta), lY0);
+        _mm_storeu_pd(aY + i, lY);
+    }
+    cubicScalar(aX0, aY0, aA, aB, aC, aX + i, aCount - i, aY + i);
+}
+
+KERNEL_TARGET("sse4.2")
+static inline __m128d distanceSse42(const __m128d aX, const __m128d aY, const __m128d aPX,
+                                    const __m128d aPY)
+{
+    __m128d lDx = _mm_sub_pd(aX, aPX);
+    __m128d lDy = _mm_sub_pd(aY, aPY);
+    return _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(lDx, lDx), _mm_mul_pd(lDy, lDy)));
+}
+
+KERNEL_TARGET("sse4.2")
+static double edgeDistanceSse42(const double aX1,
+                                const double aY1,
+                                const double aX2,
+                                const double aY2,
+                                const double *aX,
+                                const double *aY,
+                                const int aCount,
+                                const double aLeast)
+{
+    const __m128d lX1 = _mm_set1_pd(aX1);
+    const __m128d lY1 = _mm_set1_pd(aY1);
+    const __m128d lX2 = _mm_set1_pd(aX2);
+    const __m128d lY2 = _mm_set1_pd(aY2);
+    const __m128d lMidX = _mm_set1_pd((aX1 + aX2) / 2);
+    const __m128d lMidY = _mm_set1_pd((aY1 + aY2) / 2);
+    __m128d lLeast = _mm_set1_pd(aLeast);
+    int i = 0;
+    for (; i + 2 <= aCount; i += 2) {
+        const __m128d lX = _mm_loadu_pd(aX + i);
+        const __m128d lY = _mm_loadu_pd(aY + i);
+        __m128d lDist1 = distanceSse42(lX, lY, lX1, lY1);
+        __m128d lDist2 = distanceSse42(lX, lY, lX2, lY2);
+        __m128d lDist3 = distanceSse42(lX, lY, lMidX, lMidY);
+        __m128d lSum = _mm_add_pd(_mm_mul_pd(lDist1, lDist1), _mm_mul_pd(lDist2, lDist2));
+        lSum = _mm_add_pd(lSum, _mm_mul_pd(lDist3, lDist3));
+        lLeast = _mm_min_pd(_mm_sqrt_pd(lSum), lLeast);
+    }
+    double lLanes[2];
+    _mm_storeu_pd(lLanes, lLeast);
+    const double lResult = leastOf(lLanes, 2, aLeast);
+    return edgeDistanceScalar(aX1, aY1, aX2, aY2, aX + i, aY + i, aCount - i, lResult);
+}
+
+KERNEL_TARGET("sse4.2")
+static void turnsFloatSse42(const float *aAngles, const int aCount, float *aTurns)
+{
+    const __m128 lSign = _mm_set1_ps(-0.0f);
+    int i = 0;
+    for (; i + 4 < aCount; i += 4) {
+        __m128 lDiff = _mm_sub_ps(_mm_loadu_ps(aAngles + i + 1), _mm_loadu_ps(aAngles + i));
+        _mm_storeu_ps(aTurns + i, _mm_andnot_ps(lSign, lDiff));
+    }
+    turnsScalar(aAngles + i, aCount - i, aTurns + i);
+}
+
+KERNEL_TARGET("sse4.2")
+static void minMaxFloatSse42(const float *aValues, const int aCount, float &aMin, float &aMax)
+{
+    __m128 lMin = _mm_set1_ps(aMin);
+    __m128 lMax = _mm_set1_ps(aMax);
+    int i = 0;
+    for (; i + 4 <= aCount; i += 4) {
+        __m128 lValues = _mm_loadu_ps(aValues + i);
+        lMin = _mm_min_ps(lValues, lMin);
+        lMax = _mm_max_ps(lValues, lMax);
+    }
+    float lLanes[4];
+    _mm_storeu_ps(lLanes, lMin);
+    aMin = leastOf(lLanes, 4, aMin);
+    _mm_storeu_ps(lLanes, lMax);
+    aMax = greatestOf(lLanes, 4, aMax);
+    minMaxScalar(aValues + i, aCount - i, aMin, aMax);
+}
+
+static const KernelTable gSse42Kernels = {Sse42Kernels,
+                                          turnsSse42,
+                                          minMaxSse42,
+                                          turnsFloatSse42,
+                                          minMaxFloatSse42,
+                                          minMaxFixedSse42,
+                                          cubicSse42,
+                                          edgeDistanceSse42};
+
+// AVX2, 4 lanes (8 for float and int32)
+
+KERNEL_TARGET("avx2")
+static void turnsAvx2(const double *aAngles, const int aCount, double *aTurns)
+{
+    const __m256d lSign = _mm256_set1_pd(-0.0);
+    int i = 0;
+    for (; i + 4 < aCount; i += 4) {
+        __m256d lDiff = _mm256_sub_pd(_mm256_loadu_pd(aAngles + i + 1),
+                                      _mm256_loadu_pd(aAngles + i));
+        _mm256_storeu_pd(aTurns + i, _mm256_andnot_pd(lSign, lDiff));
+    }
+    turnsScalar(aAngles + i, aCount - i, aTurns + i);
+}
+
+KERNEL_TARGET("avx2")
+static void minMaxAvx2(const double *aValues, const int aCount, double &aMin, double &aMax)
+{
+    __m256d lMin = _mm256_set1_pd(aMin);
+    __m256d lMax = _mm256_set1_pd(aMax);
+    int i = 0;
+    for (; i + 4 <= aCount; i += 4) {
+        __m256d lValues = _mm256_loadu_pd(aValues + i);
+        lMin = _mm256_min_pd(lValues, lMin);
+        lMax = _mm256_max_pd(lValues, lMax);
+    }
+    double lLanes[4];
+    _mm256_storeu_pd(lLanes, lMin);
+    aMin = leastOf(lLanes, 4, aMin);
+    _mm256_storeu_pd(lLanes, lMax);
+    aMax = greatestOf(lLanes, 4, aMax);
+    minMaxScalar(aValues + i, aCount - i, aMin, aMax);
+}
+
+KERNEL_TARGET("avx2")
+static void minMaxFixedAvx2(const qint32 *aValues, const int aCount, qint32 &aMin, qint32 &aMax)
+{
+    __m256i lMin = _mm256_set1_epi32(aMin);
+    __m256i lMax = _mm256_set1_epi32(aMax);
+    int i = 0;
+    for (; i + 8 <= aCount; i += 8) {
+        __m256i lValues = _mm256_loadu_si256((const __m256i *)(aValues + i));
+        lMin = _mm256_min_epi32(lValues, lMin);
+        lMax = _mm256_max_epi32(lValues, lMax);
+    }
+    qint32 lMinLanes[8], lMaxLanes[8];
+    _mm256_storeu_si256((__m256i *)lMinLanes, lMin);
+    _mm256_storeu_si256((__m256i *)lMaxLanes, lMax);
+    for (int j = 0; j < 8; j++) {
+        aMin = qMin(aMin, lMinLanes[j]);
+        aMax = qMax(aMax, lMaxLanes[j]);
+    }
+    minMaxFixedScalar(aValues + i, aCount - i, aMin, aMax);
+}
+
+KERNEL_TARGET("avx2")
+static void cubicAvx2(const double aX0,
+                      const double aY0,
+                      const double aA,
+                      const double aB,
+                      const double aC,
+                      const double *aX,
+                      const int aCount,
+                      double *aY)
+{
+    const __m256d lX0 = _mm256_set1_pd(aX0);
+    const __m256d lY0 = _mm256_set1_pd(aY0);
+    const __m256d lA = _mm256_set1_pd(aA);
+    const __m256d lB = _mm256_set1_pd(aB);
+    const __m256d lC = _mm256_set1_pd(aC);
+    int i = 0;
+    for (; i + 4 <= aCount; i += 4) {
+        __m256d lDelta = _mm256_sub_pd(_mm256_loadu_pd(aX + i), lX0);
+        __m256d lY = _mm256_add_pd(_mm256_mul_pd(lA, lDelta), lB);
+        lY = _mm256_add_pd(_mm256_mul_pd(lY, lDelta), lC);
+        lY = _mm256_add_pd(_mm256_mul_pd(lY, lDelta), lY0);
+        _mm256_storeu_pd(aY + i, lY);
+    }
+    cubicScalar(aX0, aY0, aA, aB, aC, aX + i, aCount - i, aY + i);
+}
+
+KERNEL_TARGET("avx2")
+static inline __m256d distanceAvx2(const __m256d aX, const __m256d aY, const __m256d aPX,
+                                   const __m256d aPY)
+{
+    __m256d lDx = _mm256_sub_pd(aX, aPX);
+    __m256d lDy = _mm256_sub_pd(aY, aPY);
+    return _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(lDx, lDx), _mm256_mul_pd(lDy, lDy)));
+}
+
+KERNEL_TARGET("avx2")
+static double edgeDistanceAvx2(const double aX1,
+                               const double aY1,
+                               const double aX2,
+                               const double aY2,
+                               const double *aX,
+                               const double *aY,
+                               const int aCount,
+                               const double aLeast)
+{
+    const __m256d lX1 = _mm256_set1_pd(aX1);
+    const __m256d lY1 = _mm256_set1_pd(aY1);
+    const __m256d lX2 = _mm256_set1_pd(aX2);
+    const __m256d lY2 = _mm256_set1_pd(aY2);
+    const __m256d lMidX = _mm256_set1_pd((aX1 + aX2) / 2);
+    const __m256d lMidY = _mm256_set1_pd((aY1 + aY2) / 2);
+    __m256d lLeast = _mm256_set1_pd(aLeast);
+    int i = 0;
+    for (; i + 4 <= aCount; i += 4) {
+        const __m256d lX = _mm256_loadu_pd(aX + i);
+        const __m256d lY = _mm256_loadu_pd(aY + i);
+        __m256d lDist1 = distanceAvx2(lX, lY, lX1, lY1);
+        __m256d lDist2 = distanceAvx2(lX, lY, lX2, lY2);
+        __m256d lDist3 = distanceAvx2(lX, lY, lMidX, lMidY);
+        __m256d lSum = _mm256_add_pd(_mm256_mul_pd(lDist1, lDist1),
+                                     _mm256_mul_pd(lDist2, lDist2));
+        lSum = _mm256_add_pd(lSum, _mm256_mul_pd(lDist3, lDist3));
+        lLeast = _mm256_min_pd(_mm256_sqrt_pd(lSum), lLeast);
+    }
+    double lLanes[4];
+    _mm256_storeu_pd(lLanes, lLeast);
+    const double lResult = leastOf(lLanes, 4, aLeast);
+    return edgeDistanceScalar(aX1, aY1, aX2, aY2, aX + i, aY + i, aCount - i, lResult);
+}
+
+KERNEL_TARGET("avx2")
+static void turnsFloatAvx2(const float *aAngles, const int aCount, float *aTurns)
+{
+    const __m256 lSign = _mm256_set1_ps(-0.0f);
+    int i = 0;
+    for (; i + 8 < aCount; i += 8) {
+        __m256 lDiff = _mm256_sub_ps(_mm256_loadu_ps(aAngles + i + 1),
+                                     _mm256_loadu_ps(aAngles + i));
+        _mm256_storeu_ps(aTurns + i, _mm256_andnot_ps(lSign, lDiff));
+    }
+    turnsScalar(aAngles + i, aCount - i, aTurns + i);
+}
+
+KERNEL_TARGET("avx2")
+static void minMaxFloatAvx2(const float *aValues, const int aCount, float &aMin, float &aMax)
+{
+    __m256 lMin = _mm256_set1_ps(aMin);
+    __m256 lMax = _mm256_set1_ps(aMax);
+    int i = 0;
+    for (; i + 8 <= aCount; i += 8) {
+        __m256 lValues = _mm256_loadu_ps(aValues + i);
+        lMin = _mm256_min_ps(lValues, lMin);
+        lMax = _mm256_max_ps(lValues, lMax);
+    }
+    float lLanes[8];
+    _mm256_storeu_ps(lLanes, lMin);
+    aMin = leastOf(lLanes, 8, aMin);
+    _mm256_storeu_ps(lLanes, lMax);
+    aMax = greatestOf(lLanes, 8, aMax);
+    minMaxScalar(aValues + i, aCount - i, aMin, aMax);
+}
+
+static const KernelTable gAvx2Kernels = {Avx2Kernels,
+                                         turnsAvx2,
+                                         minMaxAvx2,
+                                         turnsFloatAvx2,
+                                         minMaxFloatAvx2,
+                                         minMaxFixedAvx2,
+                                         cubicAvx2,
+                                         edgeDistanceAvx2};
+
+// AVX-512, 8 lanes (16 for float and int32)
+
+KERNEL_TARGET("avx512f")
+static void turnsAvx512(const double *aAngles, const int aCount, double *aTurns)
+{
+    int i = 0;
+    for (; i + 8 < aCount; i += 8) {
+        __m512d lDiff = _mm512_sub_pd(_mm512_loadu_pd(aAngles + i + 1),
+                                      _mm512_loadu_pd(aAngles + i));
+        _mm512_storeu_pd(aTurns + i, _mm512_abs_pd(lDiff));
+    }
+    turnsScalar(aAngles + i, aCount - i, aTurns + i);
+}
+
+KERNEL_TARGET("avx512f")
+static void minMaxAvx512(const double *aValues, const int aCount, double &aMin, double &aMax)
+{
+    __m512d lMin = _mm512_set1_pd(aMin);
+    __m512d lMax = _mm512_set1_pd(aMax);
+    int i = 0;
+    for (; i + 8 <= aCount; i += 8) {
+        __m512d lValues = _mm512_loadu_pd(aValues + i);
+        lMin = _mm512_min_pd(lValues, lMin);
+        lMax = _mm512_max_pd(lValues, lMax);
+    }
+    double lLanes[8];
+    _mm512_storeu_pd(lLanes, lMin);
+    aMin = leastOf(lLanes, 8, aMin);
+    _mm512_storeu_pd(lLanes, lMax);
+    aMax = greatestOf(lLanes, 8, aMax);
+    minMaxScalar(aValues + i, aCount - i, aMin, aMax);
+}
+
+KERNEL_TARGET("avx512f")
+static void minMaxFixedAvx512(const qint32 *aValues, const int aCount, qint32 &aMin, qint32 &aMax)
+{
+    __m512i lMin = _mm512_set1_epi32(aMin);
+    __m512i lMax = _mm512_set1_epi32(aMax);
+    int i = 0;
+    for (; i + 16 <= aCount; i += 16) {
+        __m512i lValues = _mm512_loadu_si512(aValues + i);
+        lMin = _mm512_min_epi32(lValues, lMin);
+        lMax = _mm512_max_epi32(lValues, lMax);
+    }
+    qint32 lMinLanes[16], lMaxLanes[16];
+    _mm512_storeu_si512(lMinLanes, lMin);
+    _mm512_storeu_si512(lMaxLanes, lMax);
+    for (int j = 0; j < 16; j++) {
+        aMin = qMin(aMin, lMinLanes[j]);
+        aMax = qMax(aMax, lMaxLanes[j]);
+    }
+    minMaxFixedScalar(aValues + i, aCount - i, aMin, aMax);
+}
+
+KERNEL_TARGET("avx512f")
+static void cubicAvx512(const double aX0,
+                        const double aY0,
+                        const double aA,
+                        const double aB,
+                        const double aC,
+                        const double *aX,
+                        const int aCount,
+                        double *aY)
+{
+    const __m512d lX0 = _mm512_set1_pd(aX0);
+    const __m512d lY0 = _mm512_set1_pd(aY0);
+    const __m512d lA = _mm512_set1_pd(aA);
+    const __m512d lB = _mm512_set1_pd(aB);
+    const __m512d lC = _mm512_set1_pd(aC);
+    int i = 0;
+    for (; i + 8 <= aCount; i += 8) {
+        __m512d lDelta = _mm512_sub_pd(_mm512_loadu_pd(aX + i), lX0);
+        __m512d lY = _mm512_add_pd(_mm512_mul_pd(lA, lDelta), lB);
+        lY = _mm512_add_pd(_mm512_mul_pd(lY, lDelta), lC);
+        lY = _mm512_add_pd(_mm512_mul_pd(lY, lDelta), lY0);
+        _mm512_storeu_pd(aY + i, lY);
+    }
+    cubicScalar(aX0, aY0, aA, aB, aC, aX + i, aCount - i, aY + i);
+}
+
+KERNEL_TARGET("avx512f")
+static inline __m512d distanceAvx512(const __m512d aX, const __m512d aY, const __m512d aPX,
+                                     const __m512d aPY)
+{
+    __m512d lDx = _mm512_sub_pd(aX, aPX);
+    __m512d lDy = _mm512_sub_pd(aY, aPY);
+    return _mm512_sqrt_pd(_mm512_add_pd(_mm512_mul_pd(lDx, lDx), _mm512_mul_pd(lDy, lDy)));
+}
+
+KERNEL_TARGET("avx512f")
+static double edgeDistanceAvx512(const double aX1,
+                                 const double aY1,
+                                 const double aX2,
+                                 const double aY2,
+                                 const double *aX,
+                                 const double *aY,
+                                 const int aCount,
+                                 const double aLeast)
+{
+    const __m512d lX1 = _mm512_set1_pd(aX1);
+    const __m512d lY1 = _mm512_set1_pd(aY1);
+    const __m512d lX2 = _mm512_set1_pd(aX2);
+    const __m512d lY2 = _mm512_set1_pd(aY2);
+    const __m512d lMidX = _mm512_set1_pd((aX1 + aX2) / 2);
+    const __m512d lMidY = _mm512_set1_pd((aY1 + aY2) / 2);
+    __m512d lLeast = _mm512_set1_pd(aLeast);
+    int i = 0;
+    for (; i + 8 <= aCount; i += 8) {
+        const __m512d lX = _mm512_loadu_pd(aX + i);
+        const __m512d lY = _mm512_loadu_pd(aY + i);
+        __m512d lDist1 = distanceAvx512(lX, lY, lX1, lY1);
+        __m512d lDist2 = distanceAvx512(lX, lY, lX2, lY2);
+        __m512d lDist3 = distanceAvx512(lX, lY, lMidX, lMidY);
+        __m512d lSum = _mm512_add_pd(_mm512_mul_pd(lDist1, lDist1),
+                                     _mm512_mul_pd(lDist2, lDist2));
+        lSum = _mm512_add_pd(lSum, _mm512_mul_pd(lDist3, lDist3));
+        lLeast = _mm512_min_pd(_mm512_sqrt_pd(lSum), lLeast);
+    }
+    double lLanes[8];
+    _mm512_storeu_pd(lLanes, lLeast);
+    const double lResult = leastOf(lLanes, 8, aLeast);
+    return edgeDistanceScalar(aX1, aY1, aX2, aY2, aX + i, aY + i, aCount - i, lResult);
+}
+
+KERNEL_TARGET("avx512f")
+static void turnsFloatAvx512(const float *aAngles, const int aCount, float *aTurns)
+{
+    int i = 0;
+    for (; i + 16 < aCount; i += 16) {
+        __m512 lDiff = _mm512_sub_ps(_mm512_loadu_ps(aAngles + i + 1),
+                                     _mm512_loadu_ps(aAngles + i));
+        _mm512_storeu_ps(aTurns + i, _mm512_abs_ps(lDiff));
+    }
+    turnsScalar(aAngles + i, aCount - i, aTurns + i);
+}
+
+KERNEL_TARGET("avx512f")
+static void minMaxFloatAvx512(const float *aValues, const int aCount, float &aMin, float &aMax)
+{
+    __m512 lMin = _mm512_set1_ps(aMin);
+    __m512 lMax = _mm512_set1_ps(aMax);
+    int i = 0;
+    for (; i + 16 <= aCount; i += 16) {
+        __m512 lValues = _mm512_loadu_ps(aValues + i);
+        lMin = _mm512_min_ps(lValues, lMin);
+        lMax = _mm512_max_ps(lValues, lMax);
+    }
+    float lLanes[16];
+    _mm512_storeu_ps(lLanes, lMin);
+    aMin = leastOf(lLanes, 16, aMin);
+    _mm512_storeu_ps(lLanes, lMax);
+    aMax = greatestOf(lLanes, 16, aMax);
+    minMaxScalar(aValues + i, aCount - i, aMin, aMax);
+}
+
+static const KernelTable gAvx512Kernels = {Avx512Kernels,
+                                           turnsAvx512,
+                                           minMaxAvx512,
+                                           turnsFloatAvx512,
+                                           minMaxFloatAvx512,
+                                           minMaxFixedAvx512,
+                                           cubicAvx512,
+                                           edgeDistanceAvx512};
+
+#endif // GEOMETRY_KERNELS_X86
+
+static const KernelTable *kernelTable(const KernelIsa aIsa)
+{
+    switch (aIsa) {
+    case ScalarKernels:
+        return &gScalarKernels;
+#ifdef GEOMETRY_KERNELS_X86
+    case Sse42Kernels:
+        return &gSse42Kernels;
+    case Avx2Kernels:
+        return &gAvx2Kernels;
+    case Avx512Kernels:
+        return &gAvx512Kernels;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+static std::atomic<const KernelTable *> gKernels(nullptr);
+
+static const KernelTable *kernels()
+{
+    const KernelTable *lKernels = gKernels.load(std::memory_order_acquire);
+    if (lKernels == nullptr) {
+        // threads racing here all pick the same table
+        KernelIsa lIsa = GeometryKernels::bestIsa();
+        KernelIsa lRequested;
+        if (GeometryKernels::isaFromName(QString::fromLocal8Bit(qgetenv("POLYFEATURE_KERNELS")),
+                                         lRequested)
+            && GeometryKernels::isSupported(lRequested)) {
+            lIsa = lRequested;
+        }
+        lKernels = kernelTable(lIsa);
+        gKernels.store(lKernels, std::memory_order_release);
+    }
+    return lKernels;
+}
+
+KernelIsa GeometryKernels::isa()
+{
+    return kernels()->mIsa;
+}
+
+KernelIsa GeometryKernels::bestIsa()
+{
+    for (int i = NumKernelIsas - 1; i > ScalarKernels; i--) {
+        if (isSupported(KernelIsa(i))) {
+            return KernelIsa(i);
+        }
+    }
+    return ScalarKernels;
+}
+
+bool GeometryKernels::isSupported(const KernelIsa aIsa)
+{
+    if (kernelTable(aIsa) == nullptr) {
+        return false;
+    }
+#ifdef GEOMETRY_KERNELS_X86
+    // also checks that the OS saves the AVX registers
+    __builtin_cpu_init();
+    switch (aIsa) {
+    case Sse42Kernels:
+        return __builtin_cpu_supports("sse4.2");
+    case Avx2Kernels:
+        return __builtin_cpu_supports("avx2");
+    case Avx512Kernels:
+        return __builtin_cpu_supports("avx512f");
+    default:
+        break;
+    }
+#endif
+    return aIsa == ScalarKernels;
+}
+
+bool GeometryKernels::setIsa(const KernelIsa aIsa)
+{
+    if (!isSupported(aIsa)) {
+        return false;
+    }
+    gKernels.store(kernelTable(aIsa), std::memory_order_release);
+    return true;
+}
+
+const char *GeometryKernels::isaName(const KernelIsa aIsa)
+{
+    switch (aIsa) {
+    case ScalarKernels:
+        return "scalar";
+    case Sse42Kernels:
+        return "sse4.2";
+    case Avx2Kernels:
+        return "avx2";
+    case Avx512Kernels:
+        return "avx512";
+    default:
+        return "";
+    }
+}
+
+bool GeometryKernels::isaFromName(const QString &aName, KernelIsa &aIsa)
+{
+    for (int i = 0; i < NumKernelIsas; i++) {
+        if (aName.compare(isaName(KernelIsa(i)), Qt::CaseInsensitive) == 0) {
+            aIsa = KernelIsa(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void GeometryKernels::turns(const double *aAngles, const int aCount, double *aTurns)
+{
+    kernels()->mTurns(aAngles, aCount, aTurns);
+}
+
+void GeometryKernels::minMax(const double *aValues, const int aCount, double &aMin, double &aMax)
+{
+    kernels()->mMinMax(aValues, aCount, aMin, aMax);
+}
+
+void GeometryKernels::turns(const float *aAngles, const int aCount, float *aTurns)
+{
+    kernels()->mTurnsFloat(aAngles, aCount, aTurns);
+}
+
+void GeometryKernels::minMax(const float *aValues, const int aCount, float &aMin, float &aMax)
+{
+    kernels()->mMinMaxFloat(aValues, aCount, aMin, aMax);
+}
+
+void GeometryKernels::minMaxFixed(const qint32 *aValues,
+                                  const int aCount,
+                                  qint32 &aMin,
+                                  qint32 &aMax)
+{
+    kernels()->mMinMaxFixed(aValues, aCount, aMin, aMax);
+}
+
+void GeometryKernels::cubic(const double aX0,
+                            const double aY0,
+                            const double aA,
+                            const double aB,
+                            const double aC,
+                            const double *aX,
+                            const int aCount,
+                            double *aY)
+{
+    kernels()->mCubic(aX0, aY0, aA, aB, aC, aX, aCount, aY);
+}
+
+double GeometryKernels::edgeDistance(const double aX1,
+                                     const double aY1,
+                                     const double aX2,
+                                     const double aY2,
+                                     const double *aX,
+                                     const double *aY,
+                                     const int aCount,
+                                     const double aLeast)
+{
+    return kernels()->mEdgeDistance(aX1, aY1, aX2, aY2, aX, aY, aCount, aLeast);
+}
@@ -0,0 +1,66 @@
+#ifndef GEOMETRYKERNELS_H
+#define GEOMETRYKERNELS_H
+
+#include <QString>
+
+enum KernelIsa { ScalarKernels, Sse42Kernels, Avx2Kernels, Avx512Kernels, NumKernelIsas };
+
+// The inner loops of the checks, built for several x86 instruction sets in
+// the one binary. The widest set the CPU (cpuid) and the OS support is picked
+// on first use, or the one named by the POLYFEATURE_KERNELS environment
+// variable (scalar, sse4.2, avx2, avx512) if it is supported.
+//
+// Every implementation does the same IEEE operations in the same order as the
+// scalar one, without FMA, so the labels don't depend on the machine. Only
+// GCC and Clang on x86 get the vector implementations.
+class GeometryKernels
+{
+public:
+    static KernelIsa isa();
+    static KernelIsa bestIsa();
+    static bool isSupported(const KernelIsa aIsa);
+    // Switches the implementations for all threads, false if unsupported.
+    // For the tools, not to be called while a detection runs.
+    static bool setIsa(const KernelIsa aIsa);
+
+    static const char *isaName(const KernelIsa aIsa);
+    static bool isaFromName(const QString &aName, KernelIsa &aIsa);
+
+    // aTurns[i] = |aAngles[i + 1] - aAngles[i]| for the aCount - 1 pairs
+    static void turns(const double *aAngles, const int aCount, double *aTurns);
+    static void turns(const float *aAngles, const int aCount, float *aTurns);
+
+    // Lowers aMin and raises aMax to the least and greatest of aValues, with
+    // the < and > of a scalar loop (nan is skipped, the sign of a zero bound
+    // may differ)
+    static void minMax(const double *aValues, const int aCount, double &aMin, double &aMax);
+    // Single precision, for FloatEdgeGeometry
+    static void minMax(const float *aValues, const int aCount, float &aMin, float &aMax);
+    // The same for fixed point coordinates, twice the lanes of the doubles
+    static void minMaxFixed(const qint32 *aValues, const int aCount, qint32 &aMin, qint32 &aMax);
+
+    // aY[i] = ((aA * d + aB) * d + aC) * d + aY0 with d = aX[i] - aX0, the
+    // cubic of one spline segment
+    static void cubic(const double aX0,
+                      const double aY0,
+                      const double aA,
+                      const double aB,
+                      const double aC,
+                      const double *aX,
+                      const int aCount,
+                      double *aY);
+
+    // Least of aLeast and the spline errors of the points (aX, aY) to the edge
+    // (aX1, aY1) - (aX2, aY2) : sqrt(d1^2 + d2^2 + d3^2) with d1, d2, d3 the
+    // distances of a point to the edge end points and midpoint
+    static double edgeDistance(const double aX1,
+                               const double aY1,
+                               const double aX2,
+                               const double aY2,
+                               const double *aX,
+                               const double *aY,
+                               const int aCount,
+                               const double aLeast);
+};
+
+#endif // GEOMETRYKERNELS_H
@@ -0,0 +1,74 @@
+#include "gridhash.h"
+#include <math.h>
+
+GridPoint GridPoint::snap(const QPointF &aPoint, const double aQuantum)
+{
+    return GridPoint(qRound64(aPoint.x() / aQuantum), qRound64(aPoint.y() / aQuantum));
+}
+
+VertexIndex::VertexIndex(const double aTolerance)
+    : mTolerance(aTolerance)
+{}
+
+int VertexIndex::find(const QPointF &aPoint) const
+{
+    GridPoint lCell = GridPoint::snap(aPoint, mTolerance);
+    for (qint64 dx = -1; dx <= 1; dx++) {
+        for (qint64 dy = -1; dy <= 1; dy++) {
+            auto lFound = mCells.find(GridPoint(lCell.mX + dx, lCell.mY + dy));
+            if (lFound == mCells.end()) {
+                continue;
+            }
+            for (int lIndex : lFound->second) {
+                const QPointF &lPoint = mPoints.at(lIndex);
+                if (fabs(lPoint.x() - aPoint.x()) <= mTolerance
+                    && fabs(lPoint.y() - aPoint.y()) <= mTolerance) {
+                    return lIndex;
+                }
+            }
+        }
+    }
+    return -1;
+}
+
+int VertexIndex::insert(const QPointF &aPoint)
+{
+    int lIndex = find(aPoint);
+    if (lIndex < 0) {
+        lIndex = mPoints.count();
+        mPoints.append(aPoint);
+        mCells[GridPoint::snap(aPoint, mTolerance)].append(lIndex);
+    }
+    return lIndex;
+}
+
+void VertexIndex::clear()
+{
+    mPoints.clear();
+    mCells.clear();
+}
+
+int EdgeIndex::find(const int aFrom, const int aTo) const
+{
+    auto lFound = mEdgeIndices.find(EdgeKey(aFrom, aTo));
+    return (lFound == mEdgeIndices.end()) ? -1 : lFound->second;
+}
+
+int EdgeIndex::insert(const int aFrom, const int aTo)
+{
+    EdgeKey lKey(aFrom, aTo);
+    auto lFound = mEdgeIndices.find(lKey);
+    if (lFound != mEdgeIndices.end()) {
+        return lFound->second;
+    }
+    int lIndex = mEdges.count();
+    mEdges.append(lKey);
+    mEdgeIndices.emplace(lKey, lIndex);
+    return lIndex;
+}
+
+void EdgeIndex::clear()
+{
+    mEdges.clear();
+    mEdgeIndices.clear();
+}
@@ -0,0 +1,121 @@
+#ifndef GRIDHASH_H
+#define GRIDHASH_H
+
+#include "hashcombine.h"
+#include <QPointF>
+#include <QVector>
+#include <unordered_map>
+
+// Grid used to quantize vertex coordinates before hashing, in input units
+const double DEFAULT_HASH_QUANTUM = 1E-4;
+
+// Integer cell of a point on a square grid
+class GridPoint
+{
+public:
+    GridPoint()
+        : mX(0)
+        , mY(0)
+    {}
+    GridPoint(const qint64 aX, const qint64 aY)
+        : mX(aX)
+        , mY(aY)
+    {}
+
+    static GridPoint snap(const QPointF &aPoint, const double aQuantum);
+
+    bool operator==(const GridPoint &aOther) const { return mX == aOther.mX && mY == aOther.mY; }
+    bool operator!=(const GridPoint &aOther) const { return !(*this == aOther); }
+
+    qint64 mX, mY;
+};
+
+// Directed edge between two vertices of a VertexIndex
+class EdgeKey
+{
+public:
+    EdgeKey(const int aFrom, const int aTo)
+        : mFrom(aFrom)
+        , mTo(aTo)
+    {}
+
+    bool operator==(const EdgeKey &aOther) const
+    {
+        return mFrom == aOther.mFrom && mTo == aOther.mTo;
+    }
+
+    int mFrom, mTo;
+};
+
+namespace std {
+
+template<>
+struct hash<GridPoint>
+{
+    size_t operator()(const GridPoint &p) const
+    {
+        size_t seed = 0;
+        hash_combine(seed, p.mX);
+        hash_combine(seed, p.mY);
+        return seed;
+    }
+};
+
+template<>
+struct hash<EdgeKey>
+{
+    size_t operator()(const EdgeKey &e) const
+    {
+        size_t seed = 0;
+        hash_combine(seed, e.mFrom);
+        hash_combine(seed, e.mTo);
+        return seed;
+    }
+};
+
+} // namespace std
+
+// Points deduplicated within aTolerance (per coordinate). The grid cell size is
+// the tolerance, so two matching points can still snap to adjacent cells : a
+// lookup probes the cell of the point and its 8 neighbours.
+class VertexIndex
+{
+public:
+    VertexIndex(const double aTolerance = DEFAULT_HASH_QUANTUM);
+
+    // Index of a stored point within tolerance of aPoint, or -1
+    int find(const QPointF &aPoint) const;
+    // Index of the matching stored point, aPoint is added if there is none
+    int insert(const QPointF &aPoint);
+
+    int count() const { return mPoints.count(); }
+    const QPointF &at(const int i) const { return mPoints.at(i); }
+    void clear();
+
+private:
+    double mTolerance;
+    QVector<QPointF> mPoints;
+    std::unordered_map<GridPoint, QVector<int>> mCells;
+};
+
+// Directed edges between VertexIndex vertices, numbered in insertion order
+class EdgeIndex
+{
+public:
+    EdgeIndex() {}
+
+    // Index of the edge aFrom -> aTo, or -1
+    int find(const int aFrom, const int aTo) const;
+    // Index of the edge aFrom -> aTo, which is added if not there yet
+    int insert(const int aFrom, const int aTo);
+
+    int count() const { return mEdges.count(); }
+    const EdgeKey &at(const int i) const { return mEdges.at(i); }
+    void clear();
+
+private:
+    QVector<EdgeKey> mEdges;
+    std::unordered_map<EdgeKey, int> mEdgeIndices;
+};
+
+#endif // GRIDHASH_H
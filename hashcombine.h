@@ -3,7 +3,9 @@
 #define HASHCOMBINE_H
 
 #include <algorithm>
+#include <array>
 #include <functional>
+#include <utility>
 
 template<class T>
 inline void hash_combine(std::size_t &seed, const T &v)
@@ -12,6 +14,8 @@ inline void hash_combine(std::size_t &seed, const T &v)
     seed ^= hash_func(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
 }
 
+namespace std {
+
 // hash function for any std::pair of pointers
 template<typename T1, typename T2>
 struct hash<std::pair<T1 *, T2 *>>
@@ -38,4 +42,6 @@ struct hash<std::array<T *, N>>
     }
 };
 
+} // namespace std
+
 #endif // HASHCOMBINE_H
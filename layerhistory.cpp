@@ -0,0 +1,88 @@
+#include "layerhistory.h"
+
+LayerHistory::LayerHistory(const double aQuantum)
+    : mQuantum(aQuantum)
+    , mValid(false)
+    , mCheckSplines(false)
+    , mCheckArcs(false)
+    , mSplineTolerance(0.0)
+    , mArcTolerance(0.0)
+    , mSplineSize(0)
+    , mPrecision(DoublePrecision)
+    , mCoordinates(FloatingPointCoordinates)
+{}
+
+bool LayerHistory::matches(const DetectionParameters &aParams, const int aSplineSize) const
+{
+    return mValid && mCheckSplines == aParams.mCheckSplines && mCheckArcs == aParams.mCheckArcs
+           && (!mCheckSplines
+               || (mSplineTolerance == aParams.mSplineTolerance && mSplineSize == aSplineSize))
+           && (!mCheckArcs
+               || (mArcTolerance == aParams.mArcTolerance && mPrecision == aParams.mPrecision
+                   && mCoordinates == aParams.mCoordinates));
+}
+
+QVector<QPointF> LayerHistory::groupPoints(const QList<PolygonEdge *> &aEdgeList,
+                                           const EdgeSpan &aGroup)
+{
+    QVector<QPointF> lPoints;
+    if (aGroup.isEmpty()) {
+        return lPoints;
+    }
+    lPoints.reserve(aGroup.count() + 1);
+    for (int i = 0; i < aGroup.count(); i++) {
+        lPoints.append(aGroup.at(aEdgeList, i)->getPoint1());
+    }
+    lPoints.append(aGroup.at(aEdgeList, aGroup.count() - 1)->getPoint2());
+    return lPoints;
+}
+
+const GroupRecord *LayerHistory::find(const QVector<QPointF> &aPoints) const
+{
+    // labels are only the same for the same coordinates, the grid is only used
+    // for hashing
+    auto lRange = mIndex.equal_range(pointHash(aPoints));
+    for (auto lIt = lRange.first; lIt != lRange.second; ++lIt) {
+        const GroupRecord &lRecord = mRecords.at(lIt->second);
+        if (lRecord.mPoints == aPoints) {
+            return &lRecord;
+        }
+    }
+    return nullptr;
+}
+
+void LayerHistory::reset(const DetectionParameters &aParams,
+                         const int aSplineSize,
+                         QVector<GroupRecord> &aRecords)
+{
+    mRecords.swap(aRecords);
+    mIndex.clear();
+    mIndex.reserve(mRecords.count());
+    for (int j = 0; j < mRecords.count(); j++) {
+        mIndex.emplace(pointHash(mRecords.at(j).mPoints), j);
+    }
+    mCheckSplines = aParams.mCheckSplines;
+    mCheckArcs = aParams.mCheckArcs;
+    mSplineTolerance = aParams.mSplineTolerance;
+    mArcTolerance = aParams.mArcTolerance;
+    mSplineSize = aSplineSize;
+    mPrecision = aParams.mPrecision;
+    mCoordinates = aParams.mCoordinates;
+    mValid = true;
+}
+
+void LayerHistory::clear()
+{
+    mValid = false;
+    mRecords.clear();
+    mIndex.clear();
+}
+
+std::size_t LayerHistory::pointHash(const QVector<QPointF> &aPoints) const
+{
+    std::size_t lSeed = 0;
+    for (const QPointF &lPoint : aPoints) {
+        hash_combine(lSeed, GridPoint::snap(lPoint, mQuantum));
+    }
+    return lSeed;
+}
@@ -0,0 +1,78 @@
+#ifndef LAYERHISTORY_H
+#define LAYERHISTORY_H
+
+#include "detectiontypes.h"
+#include "edgespan.h"
+#include "gridhash.h"
+#include "polygonedge.h"
+#include <QList>
+#include <QPointF>
+#include <QVector>
+#include <unordered_map>
+
+// Spline and arc labels of one sharp-angle group, as fitted on an earlier layer
+class GroupRecord
+{
+public:
+    GroupRecord()
+        : mNumSplines(0)
+        , mNumArcs(0)
+    {}
+
+    QVector<QPointF> mPoints;      // first point of every edge plus the last end
+    QVector<long> mIDs;            // spline and arc IDs, relative to their family base ID
+    QVector<double> mSplineErrors; // per edge
+    int mNumSplines, mNumArcs;
+};
+
+// Groups of the last layer run through PolyFeatureDetection::detectFeatures()
+// with incremental detection on (see setIncrementalDetection()). Consecutive
+// layers of a part mostly repeat each other, so a group of the next layer with
+// exactly the vertices of a recorded group takes its spline and arc labels from
+// the record instead of being fitted again. Records are found by a hash of the
+// vertices on the quantum grid.
+//
+// The unit of reuse is the sharp-angle group, not a run of vertices with a
+// guard margin : the spline fit of a group runs over all of its vertices, so a
+// change anywhere in a group can move every spline label in it, while the
+// groups around it are independent of it. The spline size depends on the
+// vertex count of the whole layer, so records only apply to layers with the
+// same spline size.
+class LayerHistory
+{
+public:
+    LayerHistory(const double aQuantum = DEFAULT_HASH_QUANTUM);
+
+    // Whether the records were made with the spline and arc settings of aParams
+    // and spline fits of aSplineSize samples
+    bool matches(const DetectionParameters &aParams, const int aSplineSize) const;
+
+    static QVector<QPointF> groupPoints(const QList<PolygonEdge *> &aEdgeList,
+                                       const EdgeSpan &aGroup);
+
+    // Record with the same points, or nullptr
+    const GroupRecord *find(const QVector<QPointF> &aPoints) const;
+
+    // Replaces the records with those of the layer just labelled
+    void reset(const DetectionParameters &aParams,
+               const int aSplineSize,
+               QVector<GroupRecord> &aRecords);
+    void clear();
+
+    int count() const { return mRecords.count(); }
+
+private:
+    std::size_t pointHash(const QVector<QPointF> &aPoints) const;
+
+    double mQuantum;
+    bool mValid;
+    bool mCheckSplines, mCheckArcs;
+    double mSplineTolerance, mArcTolerance;
+    int mSplineSize;
+    ScalarPrecision mPrecision;   // of the arc labels
+    CoordinateMode mCoordinates; // idem
+    QVector<GroupRecord> mRecords;
+    std::unordered_multimap<std::size_t, int> mIndex;
+};
+
+#endif // LAYERHISTORY_H
@@ -0,0 +1,121 @@
+#include "loopassembler.h"
+#include <algorithm>
+
+double AssembledLoop::gap() const
+{
+    if (mClosed || mPoints.count() < 2) {
+        return 0.0;
+    }
+    return QLineF(mPoints.first(), mPoints.last()).length();
+}
+
+LoopAssembler::LoopAssembler(const double aTolerance)
+    : mTolerance(aTolerance)
+{}
+
+void LoopAssembler::addSegment(const QPointF &aStart, const QPointF &aEnd)
+{
+    mSegments.append(QLineF(aStart, aEnd));
+}
+
+void LoopAssembler::clear()
+{
+    mSegments.clear();
+}
+
+LoopAssemblyReport LoopAssembler::assemble(QVector<AssembledLoop> &aLoops) const
+{
+    LoopAssemblyReport lReport;
+    lReport.mNumSegments = mSegments.count();
+    aLoops.clear();
+
+    // Step 1 : merge segment ends into vertices, drop degenerate and repeated
+    // segments
+    VertexIndex lVertices(mTolerance);
+    EdgeIndex lEdges;
+    for (const QLineF &lSegment : mSegments) {
+        int lFrom = lVertices.insert(lSegment.p1());
+        int lTo = lVertices.insert(lSegment.p2());
+        if (lFrom == lTo) {
+            lReport.mNumDegenerateSegments++;
+        } else if (lEdges.find(lFrom, lTo) >= 0 || lEdges.find(lTo, lFrom) >= 0) {
+            lReport.mNumDuplicateSegments++;
+        } else {
+            lEdges.insert(lFrom, lTo);
+        }
+    }
+
+    // Step 2 : segments incident to every vertex
+    QVector<QVector<int>> lIncident(lVertices.count());
+    for (int e = 0; e < lEdges.count(); e++) {
+        lIncident[lEdges.at(e).mFrom].append(e);
+        lIncident[lEdges.at(e).mTo].append(e);
+    }
+    for (const QVector<int> &lVertexEdges : lIncident) {
+        if (lVertexEdges.count() > 2) {
+            lReport.mNumBranchVertices++;
+        }
+    }
+
+    // Step 3 : walk unused segments from vertex to vertex. A walk that comes
+    // back to its first vertex is a loop, otherwise it is extended backwards
+    // as well and reported as an open chain.
+    QVector<bool> lUsed(lEdges.count(), false);
+    auto lNextEdge = [&](const int aVertex) {
+        for (int e : lIncident.at(aVertex)) {
+            if (!lUsed.at(e)) {
+                return e;
+            }
+        }
+        return -1;
+    };
+    auto lOtherEnd = [&](const int aEdge, const int aVertex) {
+        const EdgeKey &lEdge = lEdges.at(aEdge);
+        return (lEdge.mFrom == aVertex) ? lEdge.mTo : lEdge.mFrom;
+    };
+
+    for (int e = 0; e < lEdges.count(); e++) {
+        if (lUsed.at(e)) {
+            continue;
+        }
+        lUsed[e] = true;
+        QVector<int> lChain;
+        lChain << lEdges.at(e).mFrom << lEdges.at(e).mTo;
+
+        int lEdge = lNextEdge(lChain.last());
+        while (lEdge >= 0 && lChain.last() != lChain.first()) {
+            lUsed[lEdge] = true;
+            lChain.append(lOtherEnd(lEdge, lChain.last()));
+            lEdge = lNextEdge(lChain.last());
+        }
+
+        AssembledLoop lLoop;
+        lLoop.mClosed = (lChain.last() == lChain.first());
+        if (!lLoop.mClosed) {
+            QVector<int> lBackwards;
+            int lVertex = lChain.first();
+            lEdge = lNextEdge(lVertex);
+            while (lEdge >= 0) {
+                lUsed[lEdge] = true;
+                lVertex = lOtherEnd(lEdge, lVertex);
+                lBackwards.append(lVertex);
+                lEdge = lNextEdge(lVertex);
+            }
+            std::reverse(lBackwards.begin(), lBackwards.end());
+            lChain = lBackwards + lChain;
+        }
+
+        for (int lVertex : lChain) {
+            lLoop.mPoints.append(lVertices.at(lVertex));
+        }
+        if (lLoop.mClosed) {
+            lReport.mNumClosedLoops++;
+        } else {
+            lReport.mNumOpenChains++;
+            lReport.mMaxGap = std::max(lReport.mMaxGap, lLoop.gap());
+        }
+        aLoops.append(lLoop);
+    }
+
+    return lReport;
+}
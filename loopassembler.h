@@ -0,0 +1,73 @@
+#ifndef LOOPASSEMBLER_H
+#define LOOPASSEMBLER_H
+
+#include "gridhash.h"
+#include <QLineF>
+#include <QPointF>
+#include <QVector>
+
+// One stitched chain of segments. Closed loops repeat their first point at the
+// end, as expected by PolyFeatureDetection::createEdgeList().
+class AssembledLoop
+{
+public:
+    AssembledLoop()
+        : mClosed(false)
+    {}
+
+    // distance between the two ends of an open chain, 0 for a closed loop
+    double gap() const;
+
+    QVector<QPointF> mPoints;
+    bool mClosed;
+};
+
+// What LoopAssembler::assemble() found in the segments it was given
+class LoopAssemblyReport
+{
+public:
+    LoopAssemblyReport()
+        : mNumSegments(0)
+        , mNumDegenerateSegments(0)
+        , mNumDuplicateSegments(0)
+        , mNumBranchVertices(0)
+        , mNumClosedLoops(0)
+        , mNumOpenChains(0)
+        , mMaxGap(0.0)
+    {}
+
+    bool isClean() const
+    {
+        return mNumOpenChains == 0 && mNumBranchVertices == 0 && mNumDuplicateSegments == 0;
+    }
+
+    int mNumSegments;
+    int mNumDegenerateSegments; // both ends on the same vertex, dropped
+    int mNumDuplicateSegments;  // same two vertices as an earlier segment, dropped
+    int mNumBranchVertices;     // vertices shared by more than two segments
+    int mNumClosedLoops;
+    int mNumOpenChains;
+    double mMaxGap; // largest gap() of the open chains
+};
+
+// Stitches unordered (and arbitrarily oriented) segments into loops. Segment
+// ends are matched through a VertexIndex, so ends within aTolerance of each
+// other are the same vertex and the whole stage is expected O(n).
+class LoopAssembler
+{
+public:
+    LoopAssembler(const double aTolerance = DEFAULT_HASH_QUANTUM);
+
+    void addSegment(const QPointF &aStart, const QPointF &aEnd);
+    void addSegment(const QLineF &aSegment) { addSegment(aSegment.p1(), aSegment.p2()); }
+    int segmentCount() const { return mSegments.count(); }
+    void clear();
+
+    LoopAssemblyReport assemble(QVector<AssembledLoop> &aLoops) const;
+
+private:
+    double mTolerance;
+    QVector<QLineF> mSegments;
+};
+
+#endif // LOOPASSEMBLER_H
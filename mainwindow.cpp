@@ -6,6 +6,8 @@
 #include "QString"
 #include "QTextStream"
 #include "ui_mainwindow.h"
+#include <loopassembler.h>
+#include <polygonfileio.h>
 #include <polygongraphicsitem.h>
 #include <QIODevice>
 #include <QStatusBar>
@@ -81,26 +83,13 @@ void MainWindow::on_pushButton_Load_clicked()
     } else {
         QFile lPointData(mFilePath);
         if (lPointData.exists()) {
-            if (lPointData.open(QFile::OpenMode{QIODevice::OpenModeFlag::ReadOnly})) {
-                // if (lPointData.isOpen()) {
-                mPointsList->clear();
-                QTextStream lInputStream(&lPointData);
-
-                // lInputStream.seek(0);
-                QString newLine = lInputStream.readLine();
-                //}
-                while (!newLine.isNull()) {
-                    QStringList lNewPtStr = newLine.split(QString(","));
-                    if (lNewPtStr.size() >= 2) {
-                        QString xVal = lNewPtStr[0];
-                        QString yVal = lNewPtStr[1];
-                        QPointF lNewPt(xVal.toDouble(), yVal.toDouble());
-                        mPointsList->append(lNewPt);
-                    }
-                    newLine = lInputStream.readLine();
-                }
-
-                lPointData.close();
+            // files with "x1, y1, x2, y2" lines hold unordered segments
+            QVector<QLineF> lSegments;
+            readSegmentFile(mFilePath, lSegments);
+            if (lSegments.isEmpty()) {
+                readPolygonFile(mFilePath, *mPointsList);
+            } else {
+                loadSegments(lSegments);
             }
 
             int pointsCount = mPointsList->count();
@@ -116,6 +105,37 @@ void MainWindow::on_pushButton_Load_clicked()
     }
 }
 
+void MainWindow::loadSegments(const QVector<QLineF> &aSegments)
+{
+    LoopAssembler lAssembler;
+    for (const QLineF &lSegment : aSegments) {
+        lAssembler.addSegment(lSegment);
+    }
+    QVector<AssembledLoop> lLoops;
+    LoopAssemblyReport lReport = lAssembler.assemble(lLoops);
+
+    // show the longest closed loop, without its repeated first point
+    mPointsList->clear();
+    for (const AssembledLoop &lLoop : lLoops) {
+        if (lLoop.mClosed && lLoop.mPoints.count() - 1 > mPointsList->count()) {
+            *mPointsList = lLoop.mPoints;
+            mPointsList->removeLast();
+        }
+    }
+
+    QString lMessage = QString("%1 segments, %2 closed loops").arg(lReport.mNumSegments).arg(
+        lReport.mNumClosedLoops);
+    if (!lReport.isClean()) {
+        lMessage += QString(", %1 open chains (largest gap %2), %3 branch vertices, "
+                            "%4 duplicate segments")
+                        .arg(lReport.mNumOpenChains)
+                        .arg(lReport.mMaxGap)
+                        .arg(lReport.mNumBranchVertices)
+                        .arg(lReport.mNumDuplicateSegments);
+    }
+    updateStatusBar(lMessage);
+}
+
 // Implement drag-start event on text box to clear the previous file path
 
 void MainWindow::on_textEdit_filePath_textChanged()
@@ -196,6 +216,12 @@ void MainWindow::on_checkBox_sharpAngle_clicked(bool checked)
     ui->graphicsView->setCheckSharpEdges(checked);
 }
 
+void MainWindow::on_checkBox_cascade_clicked(bool checked)
+{
+    ui->graphicsView->setCascadeDetection(checked);
+    ui->graphicsView->scene()->update();
+}
+
 void MainWindow::on_pushButton_OK_clicked()
 {
     this->close();
@@ -203,6 +229,7 @@ void MainWindow::on_pushButton_OK_clicked()
 
 void MainWindow::on_pushButton_Apply_clicked()
 {
+    ui->graphicsView->getPolyGraphicsItem()->showDetectionStats();
     ui->graphicsView->setScale(ui->doubleSpinBox_scale->value());
     ui->graphicsView->refreshGeometry();
     ui->graphicsView->scene()->update();
@@ -2,6 +2,7 @@
 #define MAINWINDOW_H
 
 #include "polygondisplayview.h"
+#include <QLineF>
 #include <QMainWindow>
 #include <QPointF>
 #include <QSharedPointer>
@@ -54,11 +55,16 @@ private slots:
 
     void on_checkBox_sharpAngle_clicked(bool checked);
 
+    void on_checkBox_cascade_clicked(bool checked);
+
     void on_pushButton_OK_clicked();
 
     void on_pushButton_Apply_clicked();
 
 private:
+    // Stitches aSegments into loops and loads the longest closed one
+    void loadSegments(const QVector<QLineF> &aSegments);
+
     Ui::MainWindow *ui;
     QSharedPointer<QVector<QPointF>> mPointsList;
     QString mFilePath;
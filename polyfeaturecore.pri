@@ -0,0 +1,56 @@
+# Feature detection core, shared by the GUI application and the command line
+# tools under tools/. Needs QT += core gui concurrent (QPolygonF and
+# QPainterPath are in QtGui).
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+SOURCES += \
+        $$PWD/CurveFitter.cpp \
+        $$PWD/Spline.cpp \
+        $$PWD/detectionstats.cpp \
+        $$PWD/detectiontrace.cpp \
+        $$PWD/diskresultcache.cpp \
+        $$PWD/edgegeometry.cpp \
+        $$PWD/edgegrid.cpp \
+        $$PWD/featurediff.cpp \
+        $$PWD/featureexport.cpp \
+        $$PWD/featureruns.cpp \
+        $$PWD/featureresultcache.cpp \
+        $$PWD/fixedpoint.cpp \
+        $$PWD/geometrykernels.cpp \
+        $$PWD/gridhash.cpp \
+        $$PWD/layerhistory.cpp \
+        $$PWD/loopassembler.cpp \
+        $$PWD/polyfeaturedetection.cpp \
+        $$PWD/polygonedge.cpp \
+        $$PWD/polygonfileio.cpp \
+        $$PWD/polygongenerator.cpp \
+        $$PWD/tolerancesweep.cpp
+
+HEADERS += \
+        $$PWD/CurveFitter.h \
+        $$PWD/Spline.h \
+        $$PWD/detectionmetrics.h \
+        $$PWD/detectionstats.h \
+        $$PWD/detectiontrace.h \
+        $$PWD/detectiontypes.h \
+        $$PWD/diskresultcache.h \
+        $$PWD/edgegeometry.h \
+        $$PWD/edgegrid.h \
+        $$PWD/edgespan.h \
+        $$PWD/featurediff.h \
+        $$PWD/featureexport.h \
+        $$PWD/featureruns.h \
+        $$PWD/featureresultcache.h \
+        $$PWD/fixedpoint.h \
+        $$PWD/geometrykernels.h \
+        $$PWD/gridhash.h \
+        $$PWD/hashcombine.h \
+        $$PWD/layerhistory.h \
+        $$PWD/loopassembler.h \
+        $$PWD/polyfeaturedetection.h \
+        $$PWD/polygonedge.h \
+        $$PWD/polygonfileio.h \
+        $$PWD/polygongenerator.h \
+        $$PWD/tolerancesweep.h
@@ -1,38 +1,84 @@
 #include "polyfeaturedetection.h"
+#include "geometrykernels.h"
 #include <CurveFitter.h>
+#include <cmath>
+#include <limits>
 #include <limits.h>
 #include <math.h>
 #include <QLineF>
 #include <QPainterPath>
 #include <QPointF>
+#include <QtConcurrent>
+#include <QtNumeric>
 
 PolyFeatureDetection::PolyFeatureDetection(QSharedPointer<QVector<QPointF>> &aPointsList)
+    : mParallelGroups(true)
+    , mCacheMetrics(false)
+    , mResultCache(nullptr)
+    , mIncremental(false)
+    , mReusedGroups(0)
 {
     mPolyPoints = aPointsList;
 }
 
+void PolyFeatureDetection::setMetricsCaching(const bool aCache)
+{
+    mCacheMetrics = aCache;
+    if (!mCacheMetrics) {
+        mMetrics.clear();
+    }
+}
+
+void PolyFeatureDetection::setIncrementalDetection(const bool aIncremental)
+{
+    mIncremental = aIncremental;
+    if (!mIncremental) {
+        mLayerHistory.clear();
+    }
+}
+
 void PolyFeatureDetection::createEdgeList(QList<PolygonEdge *> &aEdgeList)
+{
+    createEdgeList(*mPolyPoints, aEdgeList);
+}
+
+void PolyFeatureDetection::createEdgeList(const QVector<QPointF> &aPoints,
+                                          QList<PolygonEdge *> &aEdgeList)
 {
     // recreate edge list
     aEdgeList.clear();
     QPointF lPrev, lCurrent;
-    for (int i = 1; i < mPolyPoints->count(); i++) {
-        lPrev = mPolyPoints->at(i - 1);
-        lCurrent = mPolyPoints->at(i);
+    for (int i = 1; i < aPoints.count(); i++) {
+        lPrev = aPoints.at(i - 1);
+        lCurrent = aPoints.at(i);
         aEdgeList.append(new PolygonEdge(lPrev, lCurrent));
     }
 }
 
-void PolyFeatureDetection::getMinMax(
-    QList<PolygonEdge *> &aEdgeList, double &aMinX, double &aMinY, double &aMaxX, double &aMaxY)
+void PolyFeatureDetection::getMinMax(const QList<PolygonEdge *> &aEdgeList,
+                                     double &aMinX,
+                                     double &aMinY,
+                                     double &aMaxX,
+                                     double &aMaxY)
+{
+    getMinMax(aEdgeList, EdgeSpan(0, aEdgeList.count()), aMinX, aMinY, aMaxX, aMaxY);
+}
+
+void PolyFeatureDetection::getMinMax(const QList<PolygonEdge *> &aEdgeList,
+                                     const EdgeSpan &aSpan,
+                                     double &aMinX,
+                                     double &aMinY,
+                                     double &aMaxX,
+                                     double &aMaxY)
 {
     aMinX = 99999.0;
     aMinY = 99999.0;
     aMaxX = -99999.0;
     aMaxY = -99999.0;
 
-    if (aEdgeList.count() > 0) {
-        for (auto lEdge : aEdgeList) {
+    if (aSpan.count() > 0) {
+        for (int i = 0; i < aSpan.count(); i++) {
+            const PolygonEdge *lEdge = aSpan.at(aEdgeList, i);
             double x1 = lEdge->getPoint1().x();
             double y1 = lEdge->getPoint1().y();
             if (x1 < aMinX) {
@@ -49,8 +95,8 @@ void PolyFeatureDetection::getMinMax(
             }
         }
         // check endpoint of last edge.
-        double x2 = aEdgeList.at(aEdgeList.count() - 1)->getPoint2().x();
-        double y2 = aEdgeList.at(aEdgeList.count() - 1)->getPoint2().y();
+        double x2 = aSpan.at(aEdgeList, aSpan.count() - 1)->getPoint2().x();
+        double y2 = aSpan.at(aEdgeList, aSpan.count() - 1)->getPoint2().y();
         if (x2 < aMinX) {
             aMinX = x2;
         }
@@ -71,67 +117,198 @@ void PolyFeatureDetection::getMinMax(
     }
 }
 
+template<typename Scalar>
+void PolyFeatureDetection::getMinMax(const QList<PolygonEdge *> &aEdgeList,
+                                     const BasicEdgeGeometry<Scalar> &aGeometry,
+                                     const EdgeSpan &aSpan,
+                                     double &aMinX,
+                                     double &aMinY,
+                                     double &aMaxX,
+                                     double &aMaxY)
+{
+    if (aSpan.count() <= 0) {
+        getMinMax(aEdgeList, aSpan, aMinX, aMinY, aMaxX, aMaxY);
+        return;
+    }
+
+    aMinX = 99999.0;
+    aMinY = 99999.0;
+    aMaxX = -99999.0;
+    aMaxY = -99999.0;
+
+    // start points of the span, in two runs when it wraps around
+    const int lBegin = aSpan.beginIndex();
+    const int lFirstRun = std::min(aSpan.count(), aGeometry.count() - lBegin);
+    const int lSecondRun = aSpan.count() - lFirstRun;
+    if (aGeometry.isFixedPoint()) {
+        // same start values in micrometres, which convert back to the same doubles
+        const qint32 lStart = 99999 * FIXED_POINT_UNITS_PER_MM;
+        qint32 lMinX = lStart, lMinY = lStart, lMaxX = -lStart, lMaxY = -lStart;
+        GeometryKernels::minMaxFixed(aGeometry.fixedStartX() + lBegin, lFirstRun, lMinX, lMaxX);
+        GeometryKernels::minMaxFixed(aGeometry.fixedStartY() + lBegin, lFirstRun, lMinY, lMaxY);
+        GeometryKernels::minMaxFixed(aGeometry.fixedStartX(), lSecondRun, lMinX, lMaxX);
+        GeometryKernels::minMaxFixed(aGeometry.fixedStartY(), lSecondRun, lMinY, lMaxY);
+        aMinX = fromFixedPoint(lMinX);
+        aMinY = fromFixedPoint(lMinY);
+        aMaxX = fromFixedPoint(lMaxX);
+        aMaxY = fromFixedPoint(lMaxY);
+    } else {
+        Scalar lMinX = aMinX, lMinY = aMinY, lMaxX = aMaxX, lMaxY = aMaxY;
+        GeometryKernels::minMax(aGeometry.startX() + lBegin, lFirstRun, lMinX, lMaxX);
+        GeometryKernels::minMax(aGeometry.startY() + lBegin, lFirstRun, lMinY, lMaxY);
+        GeometryKernels::minMax(aGeometry.startX(), lSecondRun, lMinX, lMaxX);
+        GeometryKernels::minMax(aGeometry.startY(), lSecondRun, lMinY, lMaxY);
+        aMinX = lMinX;
+        aMinY = lMinY;
+        aMaxX = lMaxX;
+        aMaxY = lMaxY;
+    }
+
+    // check endpoint of last edge, rounded to Scalar like the start points
+    const QPointF lEnd = aSpan.at(aEdgeList, aSpan.count() - 1)->getPoint2();
+    const double x2 = Scalar(lEnd.x());
+    const double y2 = Scalar(lEnd.y());
+    GeometryKernels::minMax(&x2, 1, aMinX, aMaxX);
+    GeometryKernels::minMax(&y2, 1, aMinY, aMaxY);
+}
+
+// A vertex coordinate in Scalar arithmetic. Single precision works relative to
+// a nearby vertex (aOrigin), so that the arc fit keeps the digits the position
+// on the bed would take; double uses the coordinates as they are.
+template<typename Scalar>
+static Scalar localCoordinate(const double aValue, const double aOrigin)
+{
+    return Scalar(aValue - aOrigin);
+}
+
+template<>
+double localCoordinate<double>(const double aValue, const double)
+{
+    return aValue;
+}
+
+template<typename Scalar>
 bool PolyFeatureDetection::calculateArcParameters(const PolygonEdge *aCurrentEdge,
                                                   const PolygonEdge *aNextEdge,
-                                                  double &aCenterX,
-                                                  double &aCenterY,
-                                                  double &aRadius)
+                                                  const QPointF &aOrigin,
+                                                  const bool aFixedPoint,
+                                                  Scalar &aCenterX,
+                                                  Scalar &aCenterY,
+                                                  Scalar &aRadius)
 {
+    // On the micrometre grid, collinear vertices (and repeated ones) are told
+    // apart exactly : there is no arc through them, where the slopes below
+    // give a circle of rounding noise or divide by zero.
+    qint32 lFixed[6];
+    const bool lFixedPoint = aFixedPoint && aCurrentEdge != nullptr && aNextEdge != nullptr
+                             && toFixedPoint(aCurrentEdge->getPoint1().x(), lFixed[0])
+                             && toFixedPoint(aCurrentEdge->getPoint1().y(), lFixed[1])
+                             && toFixedPoint(aCurrentEdge->getPoint2().x(), lFixed[2])
+                             && toFixedPoint(aCurrentEdge->getPoint2().y(), lFixed[3])
+                             && toFixedPoint(aNextEdge->getPoint2().x(), lFixed[4])
+                             && toFixedPoint(aNextEdge->getPoint2().y(), lFixed[5]);
+    if (lFixedPoint
+        && fixedCollinear(lFixed[0], lFixed[1], lFixed[2], lFixed[3], lFixed[4], lFixed[5])) {
+        return false;
+    }
+
     bool lArcOk = false;
     if (aCurrentEdge != nullptr && aNextEdge != nullptr) {
-        double x1 = aCurrentEdge->getPoint1().x();
-        double y1 = aCurrentEdge->getPoint1().y();
-        double x2 = aCurrentEdge->getPoint2().x();
-        double y2 = aCurrentEdge->getPoint2().y();
-        double x3 = aNextEdge->getPoint2().x();
-        double y3 = aNextEdge->getPoint2().y();
+        Scalar x1 = localCoordinate<Scalar>(aCurrentEdge->getPoint1().x(), aOrigin.x());
+        Scalar y1 = localCoordinate<Scalar>(aCurrentEdge->getPoint1().y(), aOrigin.y());
+        Scalar x2 = localCoordinate<Scalar>(aCurrentEdge->getPoint2().x(), aOrigin.x());
+        Scalar y2 = localCoordinate<Scalar>(aCurrentEdge->getPoint2().y(), aOrigin.y());
+        Scalar x3 = localCoordinate<Scalar>(aNextEdge->getPoint2().x(), aOrigin.x());
+        Scalar y3 = localCoordinate<Scalar>(aNextEdge->getPoint2().y(), aOrigin.y());
 
         // Calculate center and radius of arc formed by 3 previous points
-        double centerY_denom = (y1 - y2) / (x1 - x2) - (y2 - y3) / (x2 - x3);
-        double centerY_num = ((x1 * x1 + y1 * y1 - x2 * x2 - y2 * y2) / (2 * (x1 - x2)))
+        Scalar centerY_denom = (y1 - y2) / (x1 - x2) - (y2 - y3) / (x2 - x3);
+        Scalar centerY_num = ((x1 * x1 + y1 * y1 - x2 * x2 - y2 * y2) / (2 * (x1 - x2)))
                              - ((x2 * x2 + y2 * y2 - x3 * x3 - y3 * y3) / (2 * (x2 - x3)));
         aCenterY = centerY_num / centerY_denom;
         aCenterX = ((x1 * x1 + y1 * y1 - x2 * x2 - y2 * y2) / (2 * (x1 - x2)))
                    - (aCenterY * (y1 - y2) / (x1 - x2));
-        aRadius = sqrt((aCenterX - x1) * (aCenterX - x1) + (aCenterY - y1) * (aCenterY - y1));
+        aRadius = std::sqrt((aCenterX - x1) * (aCenterX - x1) + (aCenterY - y1) * (aCenterY - y1));
         lArcOk = true;
+
+        if (lFixedPoint && !(std::isfinite(aCenterX) && std::isfinite(aCenterY))) {
+            // a vertical edge, or slopes rounded to the same value : the
+            // circumcentre from the exact differences to the first vertex
+            const qint64 bx = qint64(lFixed[2]) - lFixed[0], by = qint64(lFixed[3]) - lFixed[1];
+            const qint64 cx = qint64(lFixed[4]) - lFixed[0], cy = qint64(lFixed[5]) - lFixed[1];
+            const double d = 2.0 * double(bx * cy - by * cx);
+            const double b2 = double(bx * bx + by * by), c2 = double(cx * cx + cy * cy);
+            const double ux = (double(cy) * b2 - double(by) * c2) / d;
+            const double uy = (double(bx) * c2 - double(cx) * b2) / d;
+            aCenterX = localCoordinate<Scalar>(fromFixedPoint(lFixed[0])
+                                                   + ux / FIXED_POINT_UNITS_PER_MM,
+                                               aOrigin.x());
+            aCenterY = localCoordinate<Scalar>(fromFixedPoint(lFixed[1])
+                                                   + uy / FIXED_POINT_UNITS_PER_MM,
+                                               aOrigin.y());
+            aRadius = Scalar(std::sqrt(ux * ux + uy * uy) / FIXED_POINT_UNITS_PER_MM);
+        }
     }
     return lArcOk;
 }
 
-void PolyFeatureDetection::getListOfSharpFeatures(
-    QList<PolygonEdge *> &aEdgeList,
-    const double aAngleTol,
-    QList<QSharedPointer<QList<PolygonEdge *>>> &aSharpFeaturesList)
+void PolyFeatureDetection::getListOfSharpFeatures(QList<PolygonEdge *> &aEdgeList,
+                                                  const double aAngleTol,
+                                                  QVector<EdgeSpan> &aSharpFeaturesList)
 {
-    sharpAngleToleranceCheck(aEdgeList, aAngleTol);
+    EdgeGeometry lGeometry;
+    lGeometry.build(aEdgeList);
+    getListOfSharpFeatures(aEdgeList, lGeometry, aAngleTol, aSharpFeaturesList);
+}
 
-    if (aEdgeList.count() > 0) {
-        QSharedPointer<QList<PolygonEdge *>> lCurrentSharpEdgeList
-            = QSharedPointer<QList<PolygonEdge *>>(new QList<PolygonEdge *>());
-        lCurrentSharpEdgeList->append(aEdgeList.at(0));
-        aSharpFeaturesList.append(lCurrentSharpEdgeList);
+template<typename Scalar>
+void PolyFeatureDetection::getListOfSharpFeatures(QList<PolygonEdge *> &aEdgeList,
+                                                  const BasicEdgeGeometry<Scalar> &aGeometry,
+                                                  const double aAngleTol,
+                                                  QVector<EdgeSpan> &aSharpFeaturesList)
+{
+    sharpAngleToleranceCheck(aEdgeList, aGeometry, aAngleTol);
 
+    if (aEdgeList.count() > 0) {
+        int lSpanBegin = 0;
         int i = 1;
         while (i <= aEdgeList.count() - 1) {
-            PolygonEdge *lPrevEdge = aEdgeList.at(i - 1);
-            int lSharpEdgeID = lPrevEdge->getSharpEdgeID();
-            PolygonEdge *lCurrentEdge = aEdgeList.at(i);
-            if (lCurrentEdge->getSharpEdgeID() == lSharpEdgeID) {
-                lCurrentSharpEdgeList->append(lCurrentEdge);
-            } else {
-                lCurrentSharpEdgeList = QSharedPointer<QList<PolygonEdge *>>(
-                    new QList<PolygonEdge *>());
-                lCurrentSharpEdgeList->append(lCurrentEdge);
-                aSharpFeaturesList.append(lCurrentSharpEdgeList);
+            if (aEdgeList.at(i)->getSharpEdgeID() != aEdgeList.at(i - 1)->getSharpEdgeID()) {
+                aSharpFeaturesList.append(EdgeSpan(lSpanBegin, i));
+                lSpanBegin = i;
             }
             i++;
         }
+        aSharpFeaturesList.append(EdgeSpan(lSpanBegin, aEdgeList.count()));
+    }
+}
+
+template<typename Scalar>
+void PolyFeatureDetection::getFeatureSpans(QList<PolygonEdge *> &aEdgeList,
+                                           const BasicEdgeGeometry<Scalar> &aGeometry,
+                                           const bool aSharpAngleCheck,
+                                           const double aSharpAngleTol,
+                                           QVector<EdgeSpan> &aSpans)
+{
+    if (aSharpAngleCheck) {
+        getListOfSharpFeatures(aEdgeList, aGeometry, aSharpAngleTol, aSpans);
+    } else {
+        aSpans.append(EdgeSpan(0, aEdgeList.count()));
     }
 }
 
 int PolyFeatureDetection::sharpAngleToleranceCheck(QList<PolygonEdge *> &aEdgeList,
                                                    const double aAngleTol)
+{
+    EdgeGeometry lGeometry;
+    lGeometry.build(aEdgeList);
+    return sharpAngleToleranceCheck(aEdgeList, lGeometry, aAngleTol);
+}
+
+template<typename Scalar>
+int PolyFeatureDetection::sharpAngleToleranceCheck(QList<PolygonEdge *> &aEdgeList,
+                                                   const BasicEdgeGeometry<Scalar> &aGeometry,
+                                                   const double aAngleTol)
 {
     // Reset all sharp edge IDs
     for (auto lEdge : aEdgeList) {
@@ -143,13 +320,13 @@ int PolyFeatureDetection::sharpAngleToleranceCheck(QList<PolygonEdge *> &aEdgeLi
         PolygonEdge *firstEdge = aEdgeList.at(0);
         firstEdge->setSharpEdgeID(lSharpEdgeCount);
         bool lCurrentAngleDir = false;
-        bool lPrevAngleDir = (firstEdge->getAngle() >= 0);
+        bool lPrevAngleDir = (aGeometry.angle(0) >= 0);
 
         int i = 0;
         while (i <= aEdgeList.count() - 2) {
             PolygonEdge *lCurrentEdge = aEdgeList.at(i);
             PolygonEdge *lNextEdge = aEdgeList.at(i + 1);
-            double lAngleDiff = abs(lNextEdge->getAngle() - lCurrentEdge->getAngle());
+            Scalar lAngleDiff = aGeometry.turn(i);
             lCurrentAngleDir = (lAngleDiff >= 0) & (lPrevAngleDir);
             if ((lAngleDiff <= aAngleTol)) {
                 lNextEdge->setSharpEdgeID(lSharpEdgeCount);
@@ -162,8 +339,7 @@ int PolyFeatureDetection::sharpAngleToleranceCheck(QList<PolygonEdge *> &aEdgeLi
         } // while (i <= aEdgeList.count() - 2)
 
         // check angle between first and last edge.
-        PolygonEdge *lastEdge = aEdgeList.at(aEdgeList.count() - 1);
-        double lAngleDiff = (lastEdge->getAngle()) - (firstEdge->getAngle());
+        Scalar lAngleDiff = (aGeometry.angle(aEdgeList.count() - 1)) - (aGeometry.angle(0));
         lCurrentAngleDir = (lAngleDiff >= 0) & (lPrevAngleDir);
 
         if (lAngleDiff <= aAngleTol) {
@@ -182,7 +358,7 @@ int PolyFeatureDetection::sharpAngleToleranceCheck(QList<PolygonEdge *> &aEdgeLi
             while (i <= aEdgeList.count() - 2) {
                 PolygonEdge *lCurrentEdge = aEdgeList.at(i);
                 PolygonEdge *lNextEdge = aEdgeList.at(i + 1);
-                double lAngleDiff = lNextEdge->getAngle() - lCurrentEdge->getAngle();
+                Scalar lAngleDiff = aGeometry.angle(i + 1) - aGeometry.angle(i);
                 lCurrentAngleDir = (lAngleDiff >= 0) & (lPrevAngleDir);
                 if ((lAngleDiff <= aAngleTol)) {
                     lNextEdge->setSharpEdgeID(lCurrentEdge->getSharpEdgeID());
@@ -200,6 +376,64 @@ int PolyFeatureDetection::sharpAngleToleranceCheck(QList<PolygonEdge *> &aEdgeLi
     return lSharpEdgeCount;
 }
 
+template<typename GroupFunc>
+void PolyFeatureDetection::forEachGroup(const int aGroupCount,
+                                        const int aEdgeCount,
+                                        GroupFunc aGroupFunc)
+{
+    if (mParallelGroups && aGroupCount > 1 && aEdgeCount >= PARALLEL_GROUP_MIN_EDGES) {
+        QVector<int> lGroupIndices(aGroupCount);
+        for (int j = 0; j < aGroupCount; j++) {
+            lGroupIndices[j] = j;
+        }
+        QtConcurrent::blockingMap(lGroupIndices, [&](const int &j) {
+            DETECTION_TRACE_SCOPE_ARG("task", "group", "group", j);
+            aGroupFunc(j);
+        });
+    } else {
+        for (int j = 0; j < aGroupCount; j++) {
+            DETECTION_TRACE_SCOPE_ARG("task", "group", "group", j);
+            aGroupFunc(j);
+        }
+    }
+}
+
+template<typename GroupCheck>
+long PolyFeatureDetection::labelGroups(const QList<PolygonEdge *> &aEdgeList,
+                                       const QVector<EdgeSpan> &aGroups,
+                                       const long aBaseFeatureID,
+                                       GroupCheck aGroupCheck)
+{
+    // Every group is labelled independently with local feature IDs : 1..N for
+    // features, 0 for edges that are reset, and -1 for edges left untouched.
+    // Each group returns the number of feature IDs it consumed.
+    const int lGroupCount = aGroups.count();
+    QVector<QVector<long>> lLocalIDs(lGroupCount);
+    QVector<int> lFeatureCounts(lGroupCount, 0);
+
+    forEachGroup(lGroupCount, aEdgeList.count(), [&](const int j) {
+        lFeatureCounts[j] = aGroupCheck(aGroups.at(j), lLocalIDs[j]);
+    });
+
+    // Exclusive prefix scan over the per-group feature counts gives the first
+    // feature ID of every group, so the numbering matches a serial pass.
+    long lFeatureID = aBaseFeatureID;
+    for (int j = 0; j < lGroupCount; j++) {
+        const EdgeSpan &lGroup = aGroups.at(j);
+        const QVector<long> &lGroupIDs = lLocalIDs.at(j);
+        for (int i = 0; i < lGroupIDs.count(); i++) {
+            long lLocalID = lGroupIDs.at(i);
+            if (lLocalID > 0) {
+                lGroup.at(aEdgeList, i)->setFeatureID(lFeatureID + lLocalID);
+            } else if (lLocalID == 0) {
+                lGroup.at(aEdgeList, i)->setFeatureID(0);
+            }
+        }
+        lFeatureID += lFeatureCounts.at(j);
+    }
+    return lFeatureID;
+}
+
 int PolyFeatureDetection::lineToleranceCheck(QList<PolygonEdge *> &aEdgeList,
                                              const double aTolerance,
                                              const bool aSharpAngleCheck,
@@ -207,75 +441,87 @@ int PolyFeatureDetection::lineToleranceCheck(QList<PolygonEdge *> &aEdgeList,
 {
     // Poly Edges that do NOT pass the tolerance check will be marked with feature
     // ID "0" or a special feature ID "99999" indicating ---- NOT IMPLEMENTED
-    long lFeatureID = LINE_FEATURE_ID;
+    EdgeGeometry lGeometry;
+    lGeometry.build(aEdgeList);
 
-    QList<QSharedPointer<QList<PolygonEdge *>>> lSharpEdges;
-    if (aSharpAngleCheck) {
-        getListOfSharpFeatures(aEdgeList, aSharpAngleTol, lSharpEdges);
-    } else {
-        QSharedPointer<QList<PolygonEdge *>> lEdgeListPtr = QSharedPointer<QList<PolygonEdge *>>(
-            new QList<PolygonEdge *>());
-        for (auto lEdge : aEdgeList) {
-            lEdgeListPtr->append(lEdge);
-        }
-        lSharpEdges.append(lEdgeListPtr);
-    }
+    QVector<EdgeSpan> lSharpEdges;
+    getFeatureSpans(aEdgeList, lGeometry, aSharpAngleCheck, aSharpAngleTol, lSharpEdges);
 
     double lMinX, lMinY, lMaxX, lMaxY;
-    getMinMax(aEdgeList, lMinX, lMinY, lMaxX, lMaxY);
+    getMinMax(aEdgeList,
+              lGeometry,
+              EdgeSpan(0, aEdgeList.count()),
+              lMinX,
+              lMinY,
+              lMaxX,
+              lMaxY);
     double lNormalizeFactor = std::max((lMaxY - lMinY), (lMaxX - lMinX));
 
-    for (int j = 0; j <= lSharpEdges.count() - 1; j++) {
-        QSharedPointer<QList<PolygonEdge *>> lCandidateEdgeListPtr = lSharpEdges.at(j);
-        QList<PolygonEdge *> lCandidateEdgeList = *(lCandidateEdgeListPtr.data());
-        lFeatureID++;
-
-        // Remove all edges tagged as SPLINEs
-        QList<PolygonEdge *> lCandidateLineEdges;
-        for (auto lEdge : lCandidateEdgeList) {
-            if (lEdge->getFeatureID() < ARC_FEATURE_ID) {
-                lCandidateLineEdges.append(lEdge);
-            }
-        }
-
-        if (lCandidateLineEdges.count() > 1) {
-            PolygonEdge *lFirstEdge = lCandidateLineEdges.at(0);
-            lFirstEdge->setFeatureID(lFeatureID);
+    long lFeatureID = labelGroups(aEdgeList,
+                                  lSharpEdges,
+                                  LINE_FEATURE_ID,
+                                  [&](const EdgeSpan &aGroup, QVector<long> &aLocalIDs) {
+                                      QVector<long> lCurrentIDs(aGroup.count());
+                                      for (int i = 0; i < aGroup.count(); i++) {
+                                          lCurrentIDs[i] = aGroup.at(aEdgeList, i)->getFeatureID();
+                                      }
+                                      return lineToleranceGroup(lGeometry,
+                                                                aGroup,
+                                                                lCurrentIDs,
+                                                                aTolerance,
+                                                                lNormalizeFactor,
+                                                                aLocalIDs);
+                                  });
 
-            for (int i = 1; i <= lCandidateLineEdges.count() - 1; i++) {
-                PolygonEdge *lCurrentEdge = lCandidateLineEdges.at(i);
-                PolygonEdge *lPrevEdge = lCandidateLineEdges.at(i - 1);
+    return (lFeatureID - LINE_FEATURE_ID);
+}
 
-                double lPrevSlope, lCurrentSlope;
-                double lPrevAngle = lPrevEdge->getAngle();
-                if (fabs(lPrevAngle - 90) <= EPSILON) {
-                    lPrevSlope = 1.0;
-                } else {
-                    lPrevSlope = tan(lPrevAngle);
-                }
+template<typename Scalar, bool SkipClaimed>
+int PolyFeatureDetection::lineToleranceGroup(const BasicEdgeGeometry<Scalar> &aGeometry,
+                                             const EdgeSpan &aGroup,
+                                             const QVector<long> &aCurrentIDs,
+                                             const double aTolerance,
+                                             const double aNormalizeFactor,
+                                             QVector<long> &aLocalIDs)
+{
+    long lFeatureID = 1;
+    aLocalIDs.fill(-1, aGroup.count());
 
-                double lCurrentAngle = lCurrentEdge->getAngle();
-                if (fabs(lCurrentAngle - 90) <= EPSILON) {
-                    lCurrentSlope = 1.0;
-                } else {
-                    lCurrentSlope = tan(lCurrentAngle);
-                }
+    // Skip all edges tagged as SPLINEs or ARCs (see aCurrentIDs); consecutive
+    // candidates are compared in place.
+    int lPrevIdx = -1;
+    int lCandidateCount = 0;
+    Scalar lPrevSlope = 0;
+    for (int i = 0; i < aGroup.count(); i++) {
+        if (SkipClaimed && aCurrentIDs.at(i) >= ARC_FEATURE_ID) {
+            continue;
+        }
 
-                double lSlopeDiff = fabs(lCurrentSlope - lPrevSlope) / lNormalizeFactor;
-                if (lSlopeDiff <= aTolerance) {
-                    lCurrentEdge->setFeatureID(lPrevEdge->getFeatureID());
-                } else {
-                    lFeatureID++;
-                    lCurrentEdge->setFeatureID(lFeatureID);
-                }
+        Scalar lCurrentSlope = aGeometry.slope(aGroup.indexAt(i, aGeometry.count()));
+        if (lPrevIdx < 0) {
+            aLocalIDs[i] = lFeatureID;
+        } else {
+            Scalar lSlopeDiff = std::fabs(lCurrentSlope - lPrevSlope) / Scalar(aNormalizeFactor);
+            if (lSlopeDiff <= aTolerance) {
+                aLocalIDs[i] = aLocalIDs.at(lPrevIdx);
+            } else {
+                lFeatureID++;
+                aLocalIDs[i] = lFeatureID;
+            }
+        }
+        lPrevIdx = i;
+        lPrevSlope = lCurrentSlope;
+        lCandidateCount++;
+    } // for i
 
-            } // for i
+    // a single candidate edge is not a line feature, leave it untouched
+    if (lCandidateCount == 1) {
+        aLocalIDs[lPrevIdx] = -1;
+    }
 
-            // calculate slope between last edge and first edge
-        }
-    } // for j
+    // calculate slope between last edge and first edge
 
-    return (lFeatureID - LINE_FEATURE_ID);
+    return lFeatureID;
 }
 
 int PolyFeatureDetection::arcToleranceCheck(QList<PolygonEdge *> &aEdgeList,
@@ -294,73 +540,147 @@ int PolyFeatureDetection::arcToleranceCheck(QList<PolygonEdge *> &aEdgeList,
     // points 2-3-4.  //
     // Edge 1-2 will be not be tagged (will retain feature ID from line tolerance
     // checks)
-    long lFeatureID = ARC_FEATURE_ID;
+    EdgeGeometry lGeometry;
+    lGeometry.build(aEdgeList);
 
-    QList<QSharedPointer<QList<PolygonEdge *>>> lSharpEdges;
-    if (aSharpAngleCheck) {
-        getListOfSharpFeatures(aEdgeList, aSharpAngleTol, lSharpEdges);
-    } else {
-        QSharedPointer<QList<PolygonEdge *>> lEdgeListPtr = QSharedPointer<QList<PolygonEdge *>>(
-            new QList<PolygonEdge *>());
-        for (auto lEdge : aEdgeList) {
-            lEdgeListPtr->append(lEdge);
+    QVector<EdgeSpan> lSharpEdges;
+    getFeatureSpans(aEdgeList, lGeometry, aSharpAngleCheck, aSharpAngleTol, lSharpEdges);
+
+    long lFeatureID = labelGroups(aEdgeList,
+                                  lSharpEdges,
+                                  ARC_FEATURE_ID,
+                                  [&](const EdgeSpan &aGroup, QVector<long> &aLocalIDs) {
+                                      double lMinX, lMinY, lMaxX, lMaxY;
+                                      getMinMax(aEdgeList,
+                                                lGeometry,
+                                                aGroup,
+                                                lMinX,
+                                                lMinY,
+                                                lMaxX,
+                                                lMaxY);
+                                      double lNormalizeFactor = std::max((lMaxY - lMinY),
+                                                                         (lMaxX - lMinX));
+                                      return arcToleranceGroup<double>(aEdgeList,
+                                                                       aGroup,
+                                                                       aTolerance,
+                                                                       lNormalizeFactor,
+                                                                       true,
+                                                                       false,
+                                                                       aLocalIDs);
+                                  });
+
+    return (lFeatureID - ARC_FEATURE_ID);
+}
+
+template<typename Scalar>
+int PolyFeatureDetection::arcToleranceGroup(const QList<PolygonEdge *> &aEdgeList,
+                                            const EdgeSpan &aGroup,
+                                            const double aTolerance,
+                                            const double aNormalizeFactor,
+                                            const bool aClosed,
+                                            const bool aFixedPoint,
+                                            QVector<long> &aLocalIDs)
+{
+    QVector<double> lResiduals;
+    arcResidualsGroup<Scalar>(aEdgeList,
+                              aGroup,
+                              aNormalizeFactor,
+                              aClosed,
+                              aFixedPoint,
+                              lResiduals);
+    return arcLabelGroup(lResiduals, aTolerance, aClosed, aLocalIDs);
+}
+
+template<typename Scalar>
+void PolyFeatureDetection::arcResidualsGroup(const QList<PolygonEdge *> &aEdgeList,
+                                             const EdgeSpan &aGroup,
+                                             const double aNormalizeFactor,
+                                             const bool aClosed,
+                                             const bool aFixedPoint,
+                                             QVector<double> &aResiduals)
+{
+    // Residual of edge i : normalised distance of the end point of edge i+1 to
+    // the arc through edges i-1 and i. Edge 0 has none, and neither has the
+    // last edge of an open span. Without an arc through edges i-1 and i the
+    // residual is infinite.
+    aResiduals.fill(0.0, aGroup.count());
+
+    for (int lCurrentEdgeIdx = 1; lCurrentEdgeIdx <= aGroup.count() - 1; lCurrentEdgeIdx++) {
+        int lNextEdgeIdx;
+        if (lCurrentEdgeIdx == aGroup.count() - 1) {
+            if (!aClosed) {
+                break;
+            }
+            lNextEdgeIdx = 0;
+        } else {
+            lNextEdgeIdx = lCurrentEdgeIdx + 1;
         }
-        lSharpEdges.append(lEdgeListPtr);
+
+        // Calculate center and radius of arc formed by 3 previous points
+        Scalar lCenterX, lCenterY, lArcRad;
+        PolygonEdge *lCurrentEdge = aGroup.at(aEdgeList, lCurrentEdgeIdx);
+        PolygonEdge *lPreviousEdge = aGroup.at(aEdgeList, lCurrentEdgeIdx - 1);
+        const QPointF lOrigin = lCurrentEdge->getPoint1();
+        if (!calculateArcParameters(lPreviousEdge,
+                                    lCurrentEdge,
+                                    lOrigin,
+                                    aFixedPoint,
+                                    lCenterX,
+                                    lCenterY,
+                                    lArcRad)) {
+            aResiduals[lCurrentEdgeIdx] = std::numeric_limits<double>::infinity();
+            continue;
+        }
+
+        // Calculate distance of next edge end point to center of circle
+        PolygonEdge *lNextEdge = aGroup.at(aEdgeList, lNextEdgeIdx);
+        const Scalar lNextX = localCoordinate<Scalar>(lNextEdge->getPoint2().x(), lOrigin.x());
+        const Scalar lNextY = localCoordinate<Scalar>(lNextEdge->getPoint2().y(), lOrigin.y());
+        Scalar lDist = std::sqrt(Scalar(pow((lNextY - lCenterY), 2))
+                                 + Scalar(pow(lNextX - lCenterX, 2)));
+        aResiduals[lCurrentEdgeIdx] = std::fabs(lDist - lArcRad) / Scalar(aNormalizeFactor);
     }
+}
 
-    for (int j = 0; j <= lSharpEdges.count() - 1; j++) {
-        QSharedPointer<QList<PolygonEdge *>> lCandidateEdgeListPtr = lSharpEdges.at(j);
-        QList<PolygonEdge *> lCandidateArcEdges = *(lCandidateEdgeListPtr.data());
-        long lFirstEdgeFeatID = 0;
+int PolyFeatureDetection::arcLabelGroup(const QVector<double> &aResiduals,
+                                        const double aTolerance,
+                                        const bool aClosed,
+                                        QVector<long> &aLocalIDs)
+{
+    const int lEdgeCount = aResiduals.count();
+    aLocalIDs.fill(-1, lEdgeCount);
 
-        // Get all edges that are NOT tagged as SPLINEs
-        lFeatureID++;
-        lCandidateArcEdges.at(0)->setFeatureID(0);
+    long lFeatureID = 1;
+    aLocalIDs[0] = 0;
 
-        int lCurrentEdgeIdx = 1;
-        while (lCurrentEdgeIdx <= lCandidateArcEdges.count() - 1) {
-            double lMinX, lMinY, lMaxX, lMaxY;
-            getMinMax(lCandidateArcEdges, lMinX, lMinY, lMaxX, lMaxY);
-            double lNormalizeFactor = std::max((lMaxY - lMinY), (lMaxX - lMinX));
+    for (int lCurrentEdgeIdx = 1; lCurrentEdgeIdx <= lEdgeCount - 1; lCurrentEdgeIdx++) {
+        aLocalIDs[lCurrentEdgeIdx] = aLocalIDs.at(lCurrentEdgeIdx - 1);
 
-            // Calculate center and radius of arc formed by 3 previous points
-            double lCenterX, lCenterY, lArcRad;
-            PolygonEdge *lCurrentEdge = lCandidateArcEdges.at(lCurrentEdgeIdx);
-            PolygonEdge *lPreviousEdge = lCandidateArcEdges.at(lCurrentEdgeIdx - 1);
-            lCurrentEdge->setFeatureID(lPreviousEdge->getFeatureID());
-            calculateArcParameters(lPreviousEdge, lCurrentEdge, lCenterX, lCenterY, lArcRad);
-
-            // Calculate distance of next edge end point to center of circle
-            PolygonEdge *lNextEdge;
-            if (lCurrentEdgeIdx == lCandidateArcEdges.count() - 1) {
-                lNextEdge = lCandidateArcEdges.at(0);
-            } else {
-                lNextEdge = lCandidateArcEdges.at(lCurrentEdgeIdx + 1);
+        // (open spans have no edge after the last one)
+        int lNextEdgeIdx;
+        if (lCurrentEdgeIdx == lEdgeCount - 1) {
+            if (!aClosed) {
+                break;
             }
-            double lDist = sqrt(pow((lNextEdge->getPoint2().y() - lCenterY), 2)
-                                + pow(lNextEdge->getPoint2().x() - lCenterX, 2));
-            if ((fabs(lDist - lArcRad) / lNormalizeFactor) <= aTolerance) {
-                // tag this Edge (and previous & next edge) with arc feature ID
-                lPreviousEdge->setFeatureID(lFeatureID);
-                lCurrentEdge->setFeatureID(lFeatureID);
-                lNextEdge->setFeatureID(lFeatureID);
-            } else {
-                // edge is connected to previous, but has a different radius from
-                // previous arc
-                // calculate new ARC parameters.
-                // lPreviousEdge->setFeatureID(0);
-                lCurrentEdge->setFeatureID(0);
-                // lNextEdge->setFeatureID(0);
-                calculateArcParameters(lCurrentEdge, lNextEdge, lCenterX, lCenterY, lArcRad);
-                lFeatureID++;
-            }
-
-            lCurrentEdgeIdx++;
-        } // while (i <= lCandidateArcEdges.count() - 2)
+            lNextEdgeIdx = 0;
+        } else {
+            lNextEdgeIdx = lCurrentEdgeIdx + 1;
+        }
 
-    } // for j
+        if (aResiduals.at(lCurrentEdgeIdx) <= aTolerance) {
+            // tag this Edge (and previous & next edge) with arc feature ID
+            aLocalIDs[lCurrentEdgeIdx - 1] = lFeatureID;
+            aLocalIDs[lCurrentEdgeIdx] = lFeatureID;
+            aLocalIDs[lNextEdgeIdx] = lFeatureID;
+        } else {
+            // edge is connected to previous, but has a different radius from
+            // previous arc, start a new arc with the next edge
+            aLocalIDs[lCurrentEdgeIdx] = 0;
+            lFeatureID++;
+        }
+    }
 
-    return (lFeatureID - ARC_FEATURE_ID);
+    return lFeatureID;
 }
 
 // QList<PolygonEdge *> &lineToleranceCheck(const QPolygonF& aPolygon);
@@ -381,73 +701,696 @@ int PolyFeatureDetection::splineToleranceCheck(QList<PolygonEdge *> &aEdgeList,
     // Step 4 : Repeat step 3
     // until all points with spline errors have been removed OR approximated with
     // new splines
-    long lFeatureID = SPLINE_FEATURE_ID;
-    QList<QSharedPointer<QList<PolygonEdge *>>> lSharpEdges;
-    if (aSharpAngleCheck) {
-        getListOfSharpFeatures(aEdgeList, aSharpAngleTol, lSharpEdges);
+    EdgeGeometry lGeometry;
+    lGeometry.build(aEdgeList);
+
+    QVector<EdgeSpan> lSharpEdges;
+    getFeatureSpans(aEdgeList, lGeometry, aSharpAngleCheck, aSharpAngleTol, lSharpEdges);
+
+    long lFeatureID = labelGroups(aEdgeList,
+                                  lSharpEdges,
+                                  SPLINE_FEATURE_ID,
+                                  [&](const EdgeSpan &aGroup, QVector<long> &aLocalIDs) {
+                                      return splineToleranceGroup(aEdgeList,
+                                                                  aGroup,
+                                                                  aTolerance,
+                                                                  aLocalIDs);
+                                  });
+
+    return (lFeatureID - SPLINE_FEATURE_ID);
+}
+
+int PolyFeatureDetection::splineToleranceGroup(const QList<PolygonEdge *> &aEdgeList,
+                                               const EdgeSpan &aGroup,
+                                               const double aTolerance,
+                                               QVector<long> &aLocalIDs)
+{
+    EdgeSpan lCandidateSpan = aGroup;
+    aLocalIDs.fill(-1, aGroup.count());
+
+    long lFeatureID = 1;
+    if (lCandidateSpan.count() >= 3) {
+        QVector<QPointF> lInputPoints;
+        lInputPoints.reserve(lCandidateSpan.count() + 1);
+        // append first point
+        for (int j = 0; j < lCandidateSpan.count(); j++) {
+            lInputPoints << lCandidateSpan.at(aEdgeList, j)->getPoint1();
+        }
+        // append last point - why is this required?
+        lInputPoints << lCandidateSpan.at(aEdgeList, lCandidateSpan.count() - 1)->getPoint2();
+
+        // recursively calculate splines
+        calcSplineApprox_recursive(lInputPoints, aEdgeList, lCandidateSpan, aTolerance);
+
+        // At this point all the spline candidates have been identified, and
+        // spline error set for each edge. Set a unique feature ID, starting
+        // with SPLINE_FEATURE_ID+1 for every new set of points that constitute
+        // a spline if spline approximation fails, feature ID stays unchanged.
+        // The recursion trims edges from the front of the candidate span, so
+        // offset candidate indices back into aGroup.
+        const int lOffset = aGroup.count() - lCandidateSpan.count();
+        aLocalIDs[lOffset] = lFeatureID;
+
+        int i = 1;
+        while (i <= lCandidateSpan.count() - 1) {
+            PolygonEdge *lPrevEdge = lCandidateSpan.at(aEdgeList, i - 1);
+            PolygonEdge *lCurrEdge = lCandidateSpan.at(aEdgeList, i);
+            if (lPrevEdge->isSplineCandidate(aTolerance)
+                && lCurrEdge->isSplineCandidate(aTolerance)) {
+                aLocalIDs[lOffset + i] = aLocalIDs.at(lOffset + i - 1);
+            } else if (!lPrevEdge->isSplineCandidate(aTolerance)
+                       && lCurrEdge->isSplineCandidate(aTolerance)) {
+                lFeatureID++;
+                aLocalIDs[lOffset + i] = lFeatureID;
+            } else if (!lCurrEdge->isSplineCandidate(aTolerance)) {
+                aLocalIDs[lOffset + i] = 0;
+            }
+            i++;
+        } // while (i <= lCandidateSpan.count()-1)
+
+    } // if (lCandidateSpan.count() >= 3)
+
+    return lFeatureID;
+}
+
+// Fold the local IDs of one check into the running IDs of a group. Feature
+// IDs are kept relative to their family (e.g. ARC_FEATURE_ID + k) until the
+// per-group feature counts of every family are known.
+static void mergeLocalIDs(const QVector<long> &aLocalIDs,
+                          const long aBaseFeatureID,
+                          QVector<long> &aGroupIDs)
+{
+    for (int i = 0; i < aLocalIDs.count(); i++) {
+        long lLocalID = aLocalIDs.at(i);
+        if (lLocalID > 0) {
+            aGroupIDs[i] = aBaseFeatureID + lLocalID;
+        } else if (lLocalID == 0) {
+            aGroupIDs[i] = 0;
+        }
+    }
+}
+
+DetectionResult PolyFeatureDetection::detectFeatures(QList<PolygonEdge *> &aEdgeList,
+                                                     const DetectionParameters &aParams)
+{
+    DETECTION_STATS_BEGIN();
+    DETECTION_TRACE_SCOPE_ARG("detection", "detectFeatures", "edges", aEdgeList.count());
+    DetectionResult lResult;
+    mReusedGroups = 0;
+    if (mResultCache != nullptr && mResultCache->lookup(aEdgeList, aParams, lResult)) {
+        DETECTION_STAT_ADD(ResultCacheHits, 1);
     } else {
-        QSharedPointer<QList<PolygonEdge *>> lEdgeListPtr = QSharedPointer<QList<PolygonEdge *>>(
-            new QList<PolygonEdge *>());
+        // the cached metrics are kept in double precision
+        if (mCacheMetrics && aParams.mMode == SequentialDetection
+            && aParams.mPrecision == DoublePrecision
+            && (aParams.mCheckLines || aParams.mCheckArcs || aParams.mCheckSplines)) {
+            lResult = relabelFeatures(aEdgeList, aParams);
+        } else {
+            lResult = (this->*detector(aParams))(aEdgeList, aParams);
+        }
+
+        if (mResultCache != nullptr) {
+            mResultCache->insert(aEdgeList, aParams, lResult);
+        }
+    }
+
+    // stats describe this call, never a cached run
+    DETECTION_STATS_END(lResult.mStats);
+    return lResult;
+}
+
+PolyFeatureDetection::Detector PolyFeatureDetection::detector(const DetectionParameters &aParams)
+{
+    // indexed by DetectionParameters::enabledChecks()
+    static const Detector lDouble[] = {&PolyFeatureDetection::runDetection<double, 0>,
+                                       &PolyFeatureDetection::runDetection<double, 1>,
+                                       &PolyFeatureDetection::runDetection<double, 2>,
+                                       &PolyFeatureDetection::runDetection<double, 3>,
+                                       &PolyFeatureDetection::runDetection<double, 4>,
+                                       &PolyFeatureDetection::runDetection<double, 5>,
+                                       &PolyFeatureDetection::runDetection<double, 6>,
+                                       &PolyFeatureDetection::runDetection<double, 7>};
+    static const Detector lFloat[] = {&PolyFeatureDetection::runDetection<float, 0>,
+                                      &PolyFeatureDetection::runDetection<float, 1>,
+                                      &PolyFeatureDetection::runDetection<float, 2>,
+                                      &PolyFeatureDetection::runDetection<float, 3>,
+                                      &PolyFeatureDetection::runDetection<float, 4>,
+                                      &PolyFeatureDetection::runDetection<float, 5>,
+                                      &PolyFeatureDetection::runDetection<float, 6>,
+                                      &PolyFeatureDetection::runDetection<float, 7>};
+    const int lChecks = aParams.enabledChecks();
+    return (aParams.mPrecision == SinglePrecision) ? lFloat[lChecks] : lDouble[lChecks];
+}
+
+template<typename Scalar, int Checks>
+DetectionResult PolyFeatureDetection::runDetection(QList<PolygonEdge *> &aEdgeList,
+                                                   const DetectionParameters &aParams)
+{
+    // Same labelling as running splineToleranceCheck, arcToleranceCheck and
+    // lineToleranceCheck one after the other, but edge geometry and the
+    // sharp-angle grouping are computed once, and every group goes through all
+    // the enabled checks before moving on to the next group.
+    // In CascadeDetection mode the order is reversed, see cascadeGroup().
+    DetectionResult lResult;
+    BasicEdgeGeometry<Scalar> lGeometry;
+    QVector<EdgeSpan> lGroups;
+    double lLineNormalizeFactor = 1.0;
+    {
+        DETECTION_STAGE_TIMER(GeometryStage);
+        DETECTION_STAT_ADD(EdgesProcessed, aEdgeList.count());
+
+        // Reset feature IDs and sharp-edge IDs
         for (auto lEdge : aEdgeList) {
-            lEdgeListPtr->append(lEdge);
+            lEdge->setFeatureID(0);
+            lEdge->setSharpEdgeID(0);
+        }
+
+        lGeometry.build(aEdgeList, aParams.mCoordinates);
+
+        if (Checks == 0) {
+            if (aParams.mCheckSharpEdges) {
+                lResult.mNumSharpEdges = sharpAngleToleranceCheck(aEdgeList,
+                                                                  lGeometry,
+                                                                  aParams.mSharpAngleTolerance);
+            }
+            return lResult;
+        }
+
+        getFeatureSpans(aEdgeList,
+                        lGeometry,
+                        aParams.mCheckSharpEdges,
+                        aParams.mSharpAngleTolerance,
+                        lGroups);
+        if (aParams.mCheckSharpEdges) {
+            lResult.mNumSharpEdges = lGroups.count();
         }
-        lSharpEdges.append(lEdgeListPtr);
+
+        double lMinX, lMinY, lMaxX, lMaxY;
+        getMinMax(aEdgeList,
+                  lGeometry,
+                  EdgeSpan(0, aEdgeList.count()),
+                  lMinX,
+                  lMinY,
+                  lMaxX,
+                  lMaxY);
+        lLineNormalizeFactor = std::max((lMaxY - lMinY), (lMaxX - lMinX));
     }
 
-    for (int k = 0; k <= lSharpEdges.count() - 1; k++) {
-        QSharedPointer<QList<PolygonEdge *>> lCandidateEdgeListPtr = lSharpEdges.at(k);
-        QList<PolygonEdge *> lCandidateEdgeList = *(lCandidateEdgeListPtr.data());
+    const int lGroupCount = lGroups.count();
+    QVector<QVector<long>> lGroupIDs(lGroupCount);
+    QVector<int> lSplineCounts(lGroupCount, 0);
+    QVector<int> lArcCounts(lGroupCount, 0);
+    QVector<int> lLineCounts(lGroupCount, 0);
+
+    // Spline and arc labels only depend on the edges of a group, so groups seen
+    // on the previous layer are copied from its records (see LayerHistory)
+    const bool lIncremental = mIncremental && aParams.mMode == SequentialDetection
+                              && (Checks & (SplineCheck | ArcCheck)) != 0;
+    const bool lReuse = lIncremental && mLayerHistory.matches(aParams, splineSize());
+    QVector<GroupRecord> lRecords(lIncremental ? lGroupCount : 0);
+    QVector<int> lReused(lGroupCount, 0);
+
+    forEachGroup(lGroupCount, aEdgeList.count(), [&](const int j) {
+        const EdgeSpan &lGroup = lGroups.at(j);
+        QVector<long> &lIDs = lGroupIDs[j];
+        QVector<long> lLocalIDs;
+        lIDs.fill(0, lGroup.count());
+        DETECTION_STAT_ADD(BytesAllocated, 2 * lGroup.count() * qint64(sizeof(long)));
+
+        const GroupRecord *lPrevious = nullptr;
+        if (lIncremental) {
+            lRecords[j].mPoints = LayerHistory::groupPoints(aEdgeList, lGroup);
+            if (lReuse) {
+                lPrevious = mLayerHistory.find(lRecords.at(j).mPoints);
+            }
+        }
+        if (lPrevious != nullptr) {
+            lIDs = lPrevious->mIDs;
+            lSplineCounts[j] = lPrevious->mNumSplines;
+            lArcCounts[j] = lPrevious->mNumArcs;
+            for (int i = 0; i < lGroup.count(); i++) {
+                lGroup.at(aEdgeList, i)->setSplineError(lPrevious->mSplineErrors.at(i));
+            }
+            lRecords[j] = *lPrevious;
+            lReused[j] = 1;
+        }
+
+        if (aParams.mMode == CascadeDetection) {
+            DETECTION_STAGE_TIMER(CascadeStage);
+            DETECTION_STAT_ADD(EdgesProcessed, lGroup.count());
+            cascadeGroup(aEdgeList,
+                         lGeometry,
+                         lGroup,
+                         aParams,
+                         lLineNormalizeFactor,
+                         lIDs,
+                         lLineCounts[j],
+                         lArcCounts[j],
+                         lSplineCounts[j]);
+            return;
+        }
 
-        lFeatureID++;
-        if (lCandidateEdgeList.count() >= 3) {
-            QVector<QPointF> lInputPoints;
-            // append first point
-            lInputPoints << lCandidateEdgeList.at(0)->getPoint1();
-            int j;
-            for (j = 0; j < lCandidateEdgeList.count() - 1; j++) {
-                PolygonEdge *lCurrEdge = lCandidateEdgeList.at(j);
-                PolygonEdge *lNextEdge = lCandidateEdgeList.at(j + 1);
-                lInputPoints << lNextEdge->getPoint1();
+        if ((Checks & SplineCheck) != 0 && lPrevious == nullptr) {
+            DETECTION_STAGE_TIMER(SplineStage);
+            DETECTION_STAT_ADD(EdgesProcessed, lGroup.count());
+            lSplineCounts[j] = splineToleranceGroup(aEdgeList,
+                                                    lGroup,
+                                                    aParams.mSplineTolerance,
+                                                    lLocalIDs);
+            mergeLocalIDs(lLocalIDs, SPLINE_FEATURE_ID, lIDs);
+        }
+        if ((Checks & ArcCheck) != 0 && lPrevious == nullptr) {
+            DETECTION_STAGE_TIMER(ArcStage);
+            DETECTION_STAT_ADD(EdgesProcessed, lGroup.count());
+            double lGroupMinX, lGroupMinY, lGroupMaxX, lGroupMaxY;
+            getMinMax(aEdgeList,
+                      lGeometry,
+                      lGroup,
+                      lGroupMinX,
+                      lGroupMinY,
+                      lGroupMaxX,
+                      lGroupMaxY);
+            double lNormalizeFactor = std::max((lGroupMaxY - lGroupMinY),
+                                               (lGroupMaxX - lGroupMinX));
+            lArcCounts[j] = arcToleranceGroup<Scalar>(aEdgeList,
+                                                      lGroup,
+                                                      aParams.mArcTolerance,
+                                                      lNormalizeFactor,
+                                                      true,
+                                                      lGeometry.isFixedPoint(),
+                                                      lLocalIDs);
+            mergeLocalIDs(lLocalIDs, ARC_FEATURE_ID, lIDs);
+        }
+        if (lIncremental && lPrevious == nullptr) {
+            GroupRecord &lRecord = lRecords[j];
+            lRecord.mIDs = lIDs;
+            lRecord.mNumSplines = lSplineCounts.at(j);
+            lRecord.mNumArcs = lArcCounts.at(j);
+            lRecord.mSplineErrors.resize(lGroup.count());
+            for (int i = 0; i < lGroup.count(); i++) {
+                lRecord.mSplineErrors[i] = lGroup.at(aEdgeList, i)->getSplineError();
             }
-            // append last point - why is this required?
-            lInputPoints << lCandidateEdgeList.at(lCandidateEdgeList.count() - 1)->getPoint2();
+        }
+        if ((Checks & LineCheck) != 0) {
+            DETECTION_STAGE_TIMER(LineStage);
+            DETECTION_STAT_ADD(EdgesProcessed, lGroup.count());
+            const bool lSkipClaimed = (Checks & (SplineCheck | ArcCheck)) != 0;
+            lLineCounts[j] = lineToleranceGroup<Scalar, lSkipClaimed>(lGeometry,
+                                                                      lGroup,
+                                                                      lIDs,
+                                                                      aParams.mLineTolerance,
+                                                                      lLineNormalizeFactor,
+                                                                      lLocalIDs);
+            mergeLocalIDs(lLocalIDs, LINE_FEATURE_ID, lIDs);
+        }
+    });
+
+    mReusedGroups = lReused.count(1);
+    if (lIncremental) {
+        mLayerHistory.reset(aParams, splineSize(), lRecords);
+    }
+
+    DETECTION_STAGE_TIMER(NumberingStage);
+    assignFeatureIDs<Checks>(aEdgeList,
+                             lGroups,
+                             lGroupIDs,
+                             lSplineCounts,
+                             lArcCounts,
+                             lLineCounts,
+                             aParams,
+                             lResult);
+    return lResult;
+}
+
+template<int Checks>
+void PolyFeatureDetection::assignFeatureIDs(QList<PolygonEdge *> &aEdgeList,
+                                            const QVector<EdgeSpan> &aGroups,
+                                            const QVector<QVector<long>> &aGroupIDs,
+                                            const QVector<int> &aSplineCounts,
+                                            const QVector<int> &aArcCounts,
+                                            const QVector<int> &aLineCounts,
+                                            const DetectionParameters &aParams,
+                                            DetectionResult &aResult)
+{
+    // Exclusive prefix scan per feature family, as in labelGroups(). Only the
+    // families of Checks can occur.
+    long lSplineID = SPLINE_FEATURE_ID;
+    long lArcID = ARC_FEATURE_ID;
+    long lLineID = LINE_FEATURE_ID;
+    for (int j = 0; j < aGroups.count(); j++) {
+        const EdgeSpan &lGroup = aGroups.at(j);
+        const QVector<long> &lIDs = aGroupIDs.at(j);
+        for (int i = 0; i < lIDs.count(); i++) {
+            long lFeatureID = lIDs.at(i);
+            if ((Checks & SplineCheck) != 0 && lFeatureID > SPLINE_FEATURE_ID) {
+                lFeatureID += lSplineID - SPLINE_FEATURE_ID;
+            } else if ((Checks & ArcCheck) != 0 && lFeatureID > ARC_FEATURE_ID) {
+                lFeatureID += lArcID - ARC_FEATURE_ID;
+            } else if ((Checks & LineCheck) != 0 && lFeatureID > LINE_FEATURE_ID) {
+                lFeatureID += lLineID - LINE_FEATURE_ID;
+            }
+            lGroup.at(aEdgeList, i)->setFeatureID(lFeatureID);
+        }
+        lSplineID += aSplineCounts.at(j);
+        lArcID += aArcCounts.at(j);
+        lLineID += aLineCounts.at(j);
+    }
+
+    if (aParams.mCheckSplines) {
+        aResult.mNumSplines = lSplineID - SPLINE_FEATURE_ID;
+    }
+    if (aParams.mCheckArcs) {
+        aResult.mNumArcs = lArcID - ARC_FEATURE_ID;
+    }
+    if (aParams.mCheckLines) {
+        aResult.mNumLines = lLineID - LINE_FEATURE_ID;
+    }
+}
+
+void PolyFeatureDetection::updateMetrics(QList<PolygonEdge *> &aEdgeList,
+                                         const DetectionParameters &aParams)
+{
+    // Grouping and arc residuals only depend on the edges and the sharp-angle
+    // settings, recompute them when either changes.
+    if (!mMetrics.mValid || mMetrics.mEdgeList != aEdgeList
+        || mMetrics.mSharpAngleCheck != aParams.mCheckSharpEdges
+        || mMetrics.mCoordinates != aParams.mCoordinates
+        || (aParams.mCheckSharpEdges
+            && mMetrics.mSharpAngleTolerance != aParams.mSharpAngleTolerance)) {
+        DETECTION_STAGE_TIMER(GeometryStage);
+        DETECTION_STAT_ADD(EdgesProcessed, aEdgeList.count());
+        mMetrics.clear();
+        mMetrics.mEdgeList = aEdgeList;
+        mMetrics.mSharpAngleCheck = aParams.mCheckSharpEdges;
+        mMetrics.mSharpAngleTolerance = aParams.mSharpAngleTolerance;
+        mMetrics.mCoordinates = aParams.mCoordinates;
+        mMetrics.mGeometry.build(aEdgeList, aParams.mCoordinates);
+
+        for (auto lEdge : aEdgeList) {
+            lEdge->setSharpEdgeID(0);
+        }
+        getFeatureSpans(aEdgeList,
+                        mMetrics.mGeometry,
+                        aParams.mCheckSharpEdges,
+                        aParams.mSharpAngleTolerance,
+                        mMetrics.mGroups);
+        mMetrics.mSharpEdgeIDs.resize(aEdgeList.count());
+        for (int i = 0; i < aEdgeList.count(); i++) {
+            mMetrics.mSharpEdgeIDs[i] = aEdgeList.at(i)->getSharpEdgeID();
+        }
+
+        double lMinX, lMinY, lMaxX, lMaxY;
+        getMinMax(aEdgeList,
+                  mMetrics.mGeometry,
+                  EdgeSpan(0, aEdgeList.count()),
+                  lMinX,
+                  lMinY,
+                  lMaxX,
+                  lMaxY);
+        mMetrics.mLineNormalizeFactor = std::max((lMaxY - lMinY), (lMaxX - lMinX));
 
-            // recursively calculate splines
+        const int lGroupCount = mMetrics.mGroups.count();
+        mMetrics.mArcResiduals.resize(lGroupCount);
+        forEachGroup(lGroupCount, aEdgeList.count(), [&](const int j) {
+            DETECTION_STAGE_TIMER(ArcStage);
+            const EdgeSpan &lGroup = mMetrics.mGroups.at(j);
+            DETECTION_STAT_ADD(EdgesProcessed, lGroup.count());
             double lMinX, lMinY, lMaxX, lMaxY;
-            getMinMax(lCandidateEdgeList, lMinX, lMinY, lMaxX, lMaxY);
+            getMinMax(aEdgeList, mMetrics.mGeometry, lGroup, lMinX, lMinY, lMaxX, lMaxY);
             double lNormalizeFactor = std::max((lMaxY - lMinY), (lMaxX - lMinX));
-            // double lSplineTolerance = aTolerance/lNormalizeFactor;
-            calcSplineApprox_recursive(lInputPoints, lCandidateEdgeList, aTolerance);
-
-            // At this point all the spline candidates have been identified, and
-            // spline error set for each edge. Set a unique feature ID, starting
-            // with SPLINE_FEATURE_ID+1 for every new set of points that constitute
-            // a spline if spline approximation fails, feature ID stays unchanged.
-            PolygonEdge *lPrevEdge = lCandidateEdgeList.at(0);
-            lPrevEdge->setFeatureID(lFeatureID);
-
-            int i = 1;
-            while (i <= lCandidateEdgeList.count() - 1) {
-                lPrevEdge = lCandidateEdgeList.at(i - 1);
-                PolygonEdge *lCurrEdge = lCandidateEdgeList.at(i);
-                if (lPrevEdge->isSplineCandidate(aTolerance)
-                    && lCurrEdge->isSplineCandidate(aTolerance)) {
-                    lCurrEdge->setFeatureID(lPrevEdge->getFeatureID());
-                } else if (!lPrevEdge->isSplineCandidate(aTolerance)
-                           && lCurrEdge->isSplineCandidate(aTolerance)) {
-                    lFeatureID++;
-                    lCurrEdge->setFeatureID(lFeatureID);
-                } else if (!lCurrEdge->isSplineCandidate(aTolerance)) {
-                    lCurrEdge->setFeatureID(0);
+            arcResidualsGroup<double>(aEdgeList,
+                                      lGroup,
+                                      lNormalizeFactor,
+                                      true,
+                                      mMetrics.mGeometry.isFixedPoint(),
+                                      mMetrics.mArcResiduals[j]);
+        });
+        mMetrics.mValid = true;
+    }
+
+    // Where the recursive spline fit breaks depends on the tolerance, so the
+    // fit is only reused for the tolerance it was made with.
+    if (aParams.mCheckSplines
+        && (!mMetrics.mSplinesValid || mMetrics.mSplineTolerance != aParams.mSplineTolerance)) {
+        for (auto lEdge : aEdgeList) {
+            lEdge->setSplineError(0.0);
+        }
+        const int lGroupCount = mMetrics.mGroups.count();
+        mMetrics.mSplineIDs.resize(lGroupCount);
+        mMetrics.mSplineCounts.fill(0, lGroupCount);
+        forEachGroup(lGroupCount, aEdgeList.count(), [&](const int j) {
+            DETECTION_STAGE_TIMER(SplineStage);
+            DETECTION_STAT_ADD(EdgesProcessed, mMetrics.mGroups.at(j).count());
+            mMetrics.mSplineCounts[j] = splineToleranceGroup(aEdgeList,
+                                                             mMetrics.mGroups.at(j),
+                                                             aParams.mSplineTolerance,
+                                                             mMetrics.mSplineIDs[j]);
+        });
+        mMetrics.mSplineErrors.resize(aEdgeList.count());
+        for (int i = 0; i < aEdgeList.count(); i++) {
+            mMetrics.mSplineErrors[i] = aEdgeList.at(i)->getSplineError();
+        }
+        mMetrics.mSplineTolerance = aParams.mSplineTolerance;
+        mMetrics.mSplinesValid = true;
+    }
+}
+
+DetectionResult PolyFeatureDetection::relabelFeatures(QList<PolygonEdge *> &aEdgeList,
+                                                      const DetectionParameters &aParams)
+{
+    // Same labelling as detectFeatures() in SequentialDetection mode, from the
+    // cached metrics : once they are known this is a single threshold pass.
+    DetectionResult lResult;
+    updateMetrics(aEdgeList, aParams);
+
+    for (int i = 0; i < aEdgeList.count(); i++) {
+        PolygonEdge *lEdge = aEdgeList.at(i);
+        lEdge->setFeatureID(0);
+        lEdge->setSharpEdgeID(mMetrics.mSharpEdgeIDs.at(i));
+        if (aParams.mCheckSplines) {
+            lEdge->setSplineError(mMetrics.mSplineErrors.at(i));
+        }
+    }
+
+    const QVector<EdgeSpan> &lGroups = mMetrics.mGroups;
+    const int lGroupCount = lGroups.count();
+    if (aParams.mCheckSharpEdges) {
+        lResult.mNumSharpEdges = lGroupCount;
+    }
+
+    QVector<QVector<long>> lGroupIDs(lGroupCount);
+    QVector<int> lSplineCounts(lGroupCount, 0);
+    QVector<int> lArcCounts(lGroupCount, 0);
+    QVector<int> lLineCounts(lGroupCount, 0);
+    QVector<long> lLocalIDs;
+    for (int j = 0; j < lGroupCount; j++) {
+        const EdgeSpan &lGroup = lGroups.at(j);
+        QVector<long> &lIDs = lGroupIDs[j];
+        lIDs.fill(0, lGroup.count());
+
+        if (aParams.mCheckSplines) {
+            lSplineCounts[j] = mMetrics.mSplineCounts.at(j);
+            mergeLocalIDs(mMetrics.mSplineIDs.at(j), SPLINE_FEATURE_ID, lIDs);
+        }
+        if (aParams.mCheckArcs) {
+            DETECTION_STAGE_TIMER(ArcStage);
+            DETECTION_STAT_ADD(EdgesProcessed, lGroup.count());
+            lArcCounts[j] = arcLabelGroup(mMetrics.mArcResiduals.at(j),
+                                          aParams.mArcTolerance,
+                                          true,
+                                          lLocalIDs);
+            mergeLocalIDs(lLocalIDs, ARC_FEATURE_ID, lIDs);
+        }
+        if (aParams.mCheckLines) {
+            DETECTION_STAGE_TIMER(LineStage);
+            DETECTION_STAT_ADD(EdgesProcessed, lGroup.count());
+            lLineCounts[j] = lineToleranceGroup(mMetrics.mGeometry,
+                                                lGroup,
+                                                lIDs,
+                                                aParams.mLineTolerance,
+                                                mMetrics.mLineNormalizeFactor,
+                                                lLocalIDs);
+            mergeLocalIDs(lLocalIDs, LINE_FEATURE_ID, lIDs);
+        }
+    }
+
+    DETECTION_STAGE_TIMER(NumberingStage);
+    assignFeatureIDs<AllChecks>(aEdgeList,
+                                lGroups,
+                                lGroupIDs,
+                                lSplineCounts,
+                                lArcCounts,
+                                lLineCounts,
+                                aParams,
+                                lResult);
+    return lResult;
+}
+
+double PolyFeatureDetection::featureFitError(const QList<PolygonEdge *> &aEdgeList) const
+{
+    // Mean normalised residual of the edges tagged with a feature, against the
+    // model of that feature : slope change for lines, distance to the arc for
+    // arcs, spline error for splines. Uses the metrics of the last
+    // detectFeatures() run, so metrics caching has to be on.
+    if (!mMetrics.mValid || mMetrics.mEdgeList != aEdgeList) {
+        return 0.0;
+    }
+
+    double lErrorSum = 0.0;
+    int lLabelledCount = 0;
+    for (int j = 0; j < mMetrics.mGroups.count(); j++) {
+        const EdgeSpan &lGroup = mMetrics.mGroups.at(j);
+        const QVector<double> &lArcResiduals = mMetrics.mArcResiduals.at(j);
+        for (int i = 0; i < lGroup.count(); i++) {
+            const PolygonEdge *lEdge = lGroup.at(aEdgeList, i);
+            long lFeatureID = lEdge->getFeatureID();
+            double lError = 0.0;
+            if (lFeatureID > SPLINE_FEATURE_ID) {
+                lError = lEdge->getSplineError() / mMetrics.mLineNormalizeFactor;
+            } else if (lFeatureID > ARC_FEATURE_ID) {
+                lError = lArcResiduals.at(i);
+            } else if (lFeatureID > LINE_FEATURE_ID) {
+                if (i > 0 && lGroup.at(aEdgeList, i - 1)->getFeatureID() == lFeatureID) {
+                    const int lEdgeCount = mMetrics.mGeometry.count();
+                    lError = fabs(mMetrics.mGeometry.slope(lGroup.indexAt(i, lEdgeCount))
+                                  - mMetrics.mGeometry.slope(lGroup.indexAt(i - 1, lEdgeCount)))
+                             / mMetrics.mLineNormalizeFactor;
                 }
-                i++;
-            } // while (i <= lCandidateEdgeList.count()-1)
+            } else {
+                continue;
+            }
+            // degenerate arcs (collinear points) have no finite residual
+            if (qIsFinite(lError)) {
+                lErrorSum += lError;
+            }
+            lLabelledCount++;
+        }
+    }
 
-        } // if (lCandidateEdgeList.count() >= 3)
+    return (lLabelledCount > 0) ? (lErrorSum / lLabelledCount) : 0.0;
+}
 
-    } // for (int k = 0; k <= lSharpEdges.count()-1; k++)
+// Visit the maximal runs of unclaimed edges in a group, as sub-spans of it
+template<typename SpanFunc>
+static void forEachUnclaimedSpan(const EdgeSpan &aGroup,
+                                 const QVector<bool> &aClaimed,
+                                 SpanFunc aSpanFunc)
+{
+    int i = 0;
+    while (i < aGroup.count()) {
+        if (aClaimed.at(i)) {
+            i++;
+            continue;
+        }
+        int lRunEnd = i + 1;
+        while (lRunEnd < aGroup.count() && !aClaimed.at(lRunEnd)) {
+            lRunEnd++;
+        }
+        aSpanFunc(EdgeSpan(aGroup.beginIndex() + i, aGroup.beginIndex() + lRunEnd), i);
+        i = lRunEnd;
+    }
+}
 
-    return (lFeatureID - SPLINE_FEATURE_ID);
+template<typename Scalar>
+void PolyFeatureDetection::cascadeGroup(const QList<PolygonEdge *> &aEdgeList,
+                                        const BasicEdgeGeometry<Scalar> &aGeometry,
+                                        const EdgeSpan &aGroup,
+                                        const DetectionParameters &aParams,
+                                        const double aLineNormalizeFactor,
+                                        QVector<long> &aGroupIDs,
+                                        int &aNumLines,
+                                        int &aNumArcs,
+                                        int &aNumSplines)
+{
+    // Cheapest check first : long runs of edges passing the (linear time) line
+    // check are claimed as lines, the arc check runs over what is left, and
+    // only the remaining edges are sent to the spline fitter. Feature IDs stay
+    // family-relative (e.g. LINE_FEATURE_ID + k) like in detectFeatures().
+    QVector<long> lLocalIDs;
+    QVector<bool> lClaimed(aGroup.count(), false);
+    aNumLines = 0;
+    aNumArcs = 0;
+    aNumSplines = 0;
+
+    if (aParams.mCheckLines) {
+        lineToleranceGroup(aGeometry,
+                           aGroup,
+                           aGroupIDs,
+                           aParams.mLineTolerance,
+                           aLineNormalizeFactor,
+                           lLocalIDs);
+
+        int lRunBegin = 0;
+        while (lRunBegin < aGroup.count()) {
+            int lRunEnd = lRunBegin + 1;
+            Scalar lRunLength = aGeometry.length(aGroup.indexAt(lRunBegin, aGeometry.count()));
+            while (lRunEnd < aGroup.count() && lLocalIDs.at(lRunEnd) == lLocalIDs.at(lRunBegin)) {
+                lRunLength += aGeometry.length(aGroup.indexAt(lRunEnd, aGeometry.count()));
+                lRunEnd++;
+            }
+            if (lLocalIDs.at(lRunBegin) > 0
+                && ((lRunEnd - lRunBegin) >= CASCADE_MIN_LINE_RUN_EDGES
+                    || lRunLength >= CASCADE_LINE_RUN_LENGTH_FACTOR * aLineNormalizeFactor)) {
+                aNumLines++;
+                for (int i = lRunBegin; i < lRunEnd; i++) {
+                    aGroupIDs[i] = LINE_FEATURE_ID + aNumLines;
+                    lClaimed[i] = true;
+                }
+            }
+            lRunBegin = lRunEnd;
+        }
+    }
+
+    if (aParams.mCheckArcs) {
+        forEachUnclaimedSpan(aGroup, lClaimed, [&](const EdgeSpan &aSpan, const int aOffset) {
+            double lMinX, lMinY, lMaxX, lMaxY;
+            getMinMax(aEdgeList, aGeometry, aSpan, lMinX, lMinY, lMaxX, lMaxY);
+            double lNormalizeFactor = std::max((lMaxY - lMinY), (lMaxX - lMinX));
+            arcToleranceGroup<Scalar>(aEdgeList,
+                                      aSpan,
+                                      aParams.mArcTolerance,
+                                      lNormalizeFactor,
+                                      false,
+                                      aGeometry.isFixedPoint(),
+                                      lLocalIDs);
+
+            // arc IDs only increase along an open span, renumber them densely
+            long lPrevLocalID = 0;
+            for (int i = 0; i < aSpan.count(); i++) {
+                long lLocalID = lLocalIDs.at(i);
+                if (lLocalID > 0) {
+                    if (lLocalID != lPrevLocalID) {
+                        aNumArcs++;
+                        lPrevLocalID = lLocalID;
+                    }
+                    aGroupIDs[aOffset + i] = ARC_FEATURE_ID + aNumArcs;
+                    lClaimed[aOffset + i] = true;
+                }
+            }
+        });
+    }
+
+    if (aParams.mCheckSplines) {
+        forEachUnclaimedSpan(aGroup, lClaimed, [&](const EdgeSpan &aSpan, const int aOffset) {
+            if (aSpan.count() < 3) {
+                return;
+            }
+            splineToleranceGroup(aEdgeList, aSpan, aParams.mSplineTolerance, lLocalIDs);
+
+            long lPrevLocalID = 0;
+            for (int i = 0; i < aSpan.count(); i++) {
+                long lLocalID = lLocalIDs.at(i);
+                if (lLocalID > 0) {
+                    if (lLocalID != lPrevLocalID) {
+                        aNumSplines++;
+                        lPrevLocalID = lLocalID;
+                    }
+                    aGroupIDs[aOffset + i] = SPLINE_FEATURE_ID + aNumSplines;
+                    lClaimed[aOffset + i] = true;
+                }
+            }
+        });
+    }
 }
 
 // int PolyFeatureDetection::splineToleranceCheck_method2(QList<PolygonEdge *>
@@ -467,21 +1410,27 @@ int PolyFeatureDetection::splineToleranceCheck(QList<PolygonEdge *> &aEdgeList,
 //}
 
 void PolyFeatureDetection::calcSplineApprox_recursive(QVector<QPointF> &aInputPts,
-                                                      QList<PolygonEdge *> &aEdgeCandidateList,
-                                                      const double aTolerance)
+                                                      const QList<PolygonEdge *> &aEdgeList,
+                                                      EdgeSpan &aCandidateSpan,
+                                                      const double aTolerance,
+                                                      const int aDepth)
 {
+    DETECTION_STAT_MAX(SplineRecursionDepth, aDepth);
     QVector<QPointF> lSplinePoints;
     calcSpline(aInputPts, lSplinePoints);
 
     aInputPts.clear();
     aInputPts << lSplinePoints; // create new input polygon
     // Tag edges as spline candidates if they qualify for spline approximation
-    identifySplineErrors(lSplinePoints, aEdgeCandidateList, aTolerance);
+    identifySplineErrors(lSplinePoints, aEdgeList, aCandidateSpan, aTolerance);
     // remove any edges with spline errors > tolerance and
     // formulate new list of points that are spline candidates
-    bool lEdgeListModified = removeEdgeswithSplineErrors(aEdgeCandidateList, aInputPts, aTolerance);
-    if (lEdgeListModified && aEdgeCandidateList.count() >= 3) {
-        calcSplineApprox_recursive(aInputPts, aEdgeCandidateList, aTolerance);
+    bool lEdgeListModified = removeEdgeswithSplineErrors(aEdgeList,
+                                                         aCandidateSpan,
+                                                         aInputPts,
+                                                         aTolerance);
+    if (lEdgeListModified && aCandidateSpan.count() >= 3) {
+        calcSplineApprox_recursive(aInputPts, aEdgeList, aCandidateSpan, aTolerance, aDepth + 1);
     }
 }
 
@@ -489,24 +1438,34 @@ void PolyFeatureDetection::calcSpline(QVector<QPointF> &aInputPts, QVector<QPoin
 {
     // aSplineCurvePts is an output parameter, will be recreated every time
     SplineCurveFitter lCurveFitter;
-    lCurveFitter.setSplineSize(100 * mPolyPoints->count());
+    lCurveFitter.setSplineSize(splineSize());
 
     QPolygonF lInputPoly(aInputPts);
     QPolygonF lSplineCurve = lCurveFitter.fitCurve(lInputPoly);
+    DETECTION_STAT_ADD(SplineFits, 1);
+    DETECTION_STAT_ADD(SplineSamples, lSplineCurve.count());
 
     aSplineCurvePts.clear();
     aSplineCurvePts << lSplineCurve;
+    DETECTION_STAT_ADD(BytesAllocated,
+                       (lInputPoly.count() + 2 * lSplineCurve.count()) * qint64(sizeof(QPointF)));
+}
+
+int PolyFeatureDetection::splineSize() const
+{
+    return qBound(10, 100 * mPolyPoints->count(), MAX_SPLINE_SIZE);
 }
 
-bool PolyFeatureDetection::removeEdgeswithSplineErrors(QList<PolygonEdge *> &aEdgeList,
+bool PolyFeatureDetection::removeEdgeswithSplineErrors(const QList<PolygonEdge *> &aEdgeList,
+                                                       EdgeSpan &aCandidateSpan,
                                                        QVector<QPointF> &aCandidatePts,
                                                        const double aTolerance)
 {
     bool aEdgeListModified = false;
     // find index of first non-spline entity.
     int lSplineStartIndex = -1;
-    for (int j = 0; j < aEdgeList.count(); j++) {
-        PolygonEdge *lEdge = aEdgeList.at(j);
+    for (int j = 0; j < aCandidateSpan.count(); j++) {
+        PolygonEdge *lEdge = aCandidateSpan.at(aEdgeList, j);
         if (j >= 3 && lEdge->getSplineError() > aTolerance) {
             lSplineStartIndex = j;
             break;
@@ -515,18 +1474,18 @@ bool PolyFeatureDetection::removeEdgeswithSplineErrors(QList<PolygonEdge *> &aEd
     if (lSplineStartIndex >= 3) {
         // remove all entities upto lSplineStartIndex
         int k = 0;
-        while (k >= lSplineStartIndex && aEdgeList.count() >= 3) {
-            aEdgeList.removeAt(0);
+        while (k >= lSplineStartIndex && aCandidateSpan.count() >= 3) {
+            aCandidateSpan.popFront();
             aEdgeListModified = true;
             k++;
         }
     }
     // populate new list of points based on removed edges : aCandidatePts
     aCandidatePts.clear(); // aCandidatePts is OUTPUT list
-    for (int j = 0; j < aEdgeList.count(); j++) {
-        PolygonEdge *lEdge = aEdgeList.at(j);
+    for (int j = 0; j < aCandidateSpan.count(); j++) {
+        PolygonEdge *lEdge = aCandidateSpan.at(aEdgeList, j);
         aCandidatePts << lEdge->getPoint1();
-        if (j == aEdgeList.count() - 1) {
+        if (j == aCandidateSpan.count() - 1) {
             aCandidatePts << lEdge->getPoint2();
         }
     }
@@ -535,31 +1494,49 @@ bool PolyFeatureDetection::removeEdgeswithSplineErrors(QList<PolygonEdge *> &aEd
 }
 
 void PolyFeatureDetection::identifySplineErrors(QVector<QPointF> &aSplineCurvePts,
-                                                QList<PolygonEdge *> &aEdgeList,
+                                                const QList<PolygonEdge *> &aEdgeList,
+                                                const EdgeSpan &aCandidateSpan,
                                                 const double aTolerance)
 {
-    for (int j = 0; j < aEdgeList.count(); j++) {
-        PolygonEdge *lEdge = aEdgeList.at(j);
-        double lDistToSpline = 99999;
-
-        for (int k = 0; k <= aSplineCurvePts.count() - 1; k++) {
-            QPointF lSplinePt = aSplineCurvePts.at(k);
-            // calculate error/distance of spline point from lEdge
-            QPointF p1 = lEdge->getPoint1();
-            QPointF p2 = lEdge->getPoint2();
-            QPointF lMidPoint((p1.x() + p2.x()) / 2, (p1.y() + p2.y()) / 2);
-
-            qreal lDist1 = sqrt(pow(lSplinePt.x() - p1.x(), 2) + pow(lSplinePt.y() - p1.y(), 2));
-            qreal lDist2 = sqrt(pow(lSplinePt.x() - p2.x(), 2) + pow(lSplinePt.y() - p2.y(), 2));
-            qreal lDist3 = sqrt(pow(lSplinePt.x() - lMidPoint.x(), 2)
-                                + pow(lSplinePt.y() - lMidPoint.y(), 2));
-
-            qreal leastSqrError = sqrt(lDist1 * lDist1 + lDist2 * lDist2 + lDist3 * lDist3);
-            if (leastSqrError < lDistToSpline) {
-                lDistToSpline = leastSqrError;
-            }
-        } // for k
+    // spline points as x and y arrays for GeometryKernels::edgeDistance()
+    const int lNumSplinePts = aSplineCurvePts.count();
+    QVector<double> lSplineX(lNumSplinePts);
+    QVector<double> lSplineY(lNumSplinePts);
+    for (int k = 0; k < lNumSplinePts; k++) {
+        lSplineX[k] = aSplineCurvePts.at(k).x();
+        lSplineY[k] = aSplineCurvePts.at(k).y();
+    }
+    DETECTION_STAT_ADD(BytesAllocated, 2 * lNumSplinePts * qint64(sizeof(double)));
 
-        aEdgeList.at(j)->setSplineError(lDistToSpline);
+    for (int j = 0; j < aCandidateSpan.count(); j++) {
+        PolygonEdge *lEdge = aCandidateSpan.at(aEdgeList, j);
+        // calculate error/distance of spline points from lEdge
+        QPointF p1 = lEdge->getPoint1();
+        QPointF p2 = lEdge->getPoint2();
+        double lDistToSpline = GeometryKernels::edgeDistance(p1.x(),
+                                                             p1.y(),
+                                                             p2.x(),
+                                                             p2.y(),
+                                                             lSplineX.constData(),
+                                                             lSplineY.constData(),
+                                                             lNumSplinePts,
+                                                             99999);
+        lEdge->setSplineError(lDistToSpline);
     } // for j
 }
+
+// the public getMinMax() for both geometries
+template void PolyFeatureDetection::getMinMax(const QList<PolygonEdge *> &aEdgeList,
+                                              const EdgeGeometry &aGeometry,
+                                              const EdgeSpan &aSpan,
+                                              double &aMinX,
+                                              double &aMinY,
+                                              double &aMaxX,
+                                              double &aMaxY);
+template void PolyFeatureDetection::getMinMax(const QList<PolygonEdge *> &aEdgeList,
+                                              const FloatEdgeGeometry &aGeometry,
+                                              const EdgeSpan &aSpan,
+                                              double &aMinX,
+                                              double &aMinY,
+                                              double &aMaxX,
+                                              double &aMaxY);
@@ -1,12 +1,28 @@
 #ifndef POLYFEATUREDETECTION_H
 #define POLYFEATUREDETECTION_H
 
+#include "detectionmetrics.h"
+#include "detectiontypes.h"
+#include "edgegeometry.h"
+#include "edgespan.h"
+#include "featureresultcache.h"
+#include "layerhistory.h"
 #include "polygonedge.h"
 #include <QList>
 #include <QPolygonF>
 #include <QSharedPointer>
 #include <QVector>
 
+// Minimum number of edges in a polygon before its sharp-feature groups are
+// labelled concurrently; below this the thread pool overhead dominates.
+const int PARALLEL_GROUP_MIN_EDGES = 64;
+
+// Cascade detection claims a run of edges passing the line check as a line when
+// it has at least CASCADE_MIN_LINE_RUN_EDGES edges, or when its length is at
+// least CASCADE_LINE_RUN_LENGTH_FACTOR times the size of the polygon.
+const int CASCADE_MIN_LINE_RUN_EDGES = 3;
+const double CASCADE_LINE_RUN_LENGTH_FACTOR = 0.05;
+
 class PolyFeatureDetection : public QObject
 {
     Q_OBJECT
@@ -15,7 +31,28 @@ public:
 
     void createEdgeList(QList<PolygonEdge *> &aEdgeList);
 
-    void getMinMax(QList<PolygonEdge *> &aEdgeList,
+    // Edges between consecutive points of a closed point list (first point
+    // repeated at the end), e.g. the mPoints of an AssembledLoop
+    static void createEdgeList(const QVector<QPointF> &aPoints, QList<PolygonEdge *> &aEdgeList);
+
+    void getMinMax(const QList<PolygonEdge *> &aEdgeList,
+                   double &aMinX,
+                   double &aMinY,
+                   double &aMaxX,
+                   double &aMaxY);
+
+    void getMinMax(const QList<PolygonEdge *> &aEdgeList,
+                   const EdgeSpan &aSpan,
+                   double &aMinX,
+                   double &aMinY,
+                   double &aMaxX,
+                   double &aMaxY);
+
+    // Same bounds from the edge start points of aGeometry, built from aEdgeList
+    template<typename Scalar>
+    void getMinMax(const QList<PolygonEdge *> &aEdgeList,
+                   const BasicEdgeGeometry<Scalar> &aGeometry,
+                   const EdgeSpan &aSpan,
                    double &aMinX,
                    double &aMinY,
                    double &aMaxX,
@@ -40,29 +77,184 @@ public:
 
     void getListOfSharpFeatures(QList<PolygonEdge *> &aEdgeList,
                                 const double aAngleTol,
-                                QList<QSharedPointer<QList<PolygonEdge *>>> &aSharpFeatures);
+                                QVector<EdgeSpan> &aSharpFeatures);
+
+    DetectionResult detectFeatures(QList<PolygonEdge *> &aEdgeList,
+                                   const DetectionParameters &aParams);
+
+    void setParallelGroupProcessing(const bool aParallel) { mParallelGroups = aParallel; }
+    bool parallelGroupProcessing() const { return mParallelGroups; }
+
+    // Keep tolerance-independent per-edge metrics between detectFeatures() calls,
+    // so that changing the line or arc tolerance only relabels the edges.
+    // The metrics must be invalidated whenever the edges change.
+    void setMetricsCaching(const bool aCache);
+    bool metricsCaching() const { return mCacheMetrics; }
+    void invalidateMetrics() { mMetrics.clear(); }
+
+    double featureFitError(const QList<PolygonEdge *> &aEdgeList) const;
+
+    // Looks detectFeatures() results up in aCache before running the checks,
+    // and stores them after. The cache is not owned, and may be shared.
+    void setResultCache(FeatureResultCache *aCache) { mResultCache = aCache; }
+    FeatureResultCache *resultCache() const { return mResultCache; }
+
+    // Detect a sequence of layers incrementally : sharp-angle groups with the
+    // vertices of a group of the previous detectFeatures() call take its spline
+    // and arc labels, so only the groups that changed are fitted. Applies to
+    // SequentialDetection runs that do not go through cached metrics.
+    void setIncrementalDetection(const bool aIncremental);
+    bool incrementalDetection() const { return mIncremental; }
+    void clearLayerHistory() { mLayerHistory.clear(); }
+    // Number of groups of the last run labelled from the previous layer
+    int reusedGroupCount() const { return mReusedGroups; }
+
 private:
+    // The checks below are done in the Scalar of the edge geometry, see
+    // DetectionParameters::mPrecision
+    template<typename Scalar>
+    int sharpAngleToleranceCheck(QList<PolygonEdge *> &aEdgeList,
+                                 const BasicEdgeGeometry<Scalar> &aGeometry,
+                                 const double aAngleTol);
+
+    template<typename Scalar>
+    void getListOfSharpFeatures(QList<PolygonEdge *> &aEdgeList,
+                                const BasicEdgeGeometry<Scalar> &aGeometry,
+                                const double aAngleTol,
+                                QVector<EdgeSpan> &aSharpFeatures);
+
+    template<typename Scalar>
+    void getFeatureSpans(QList<PolygonEdge *> &aEdgeList,
+                         const BasicEdgeGeometry<Scalar> &aGeometry,
+                         const bool aSharpAngleCheck,
+                         const double aSharpAngleTol,
+                         QVector<EdgeSpan> &aSpans);
+
+    template<typename GroupFunc>
+    void forEachGroup(const int aGroupCount, const int aEdgeCount, GroupFunc aGroupFunc);
+
+    template<typename GroupCheck>
+    long labelGroups(const QList<PolygonEdge *> &aEdgeList,
+                     const QVector<EdgeSpan> &aGroups,
+                     const long aBaseFeatureID,
+                     GroupCheck aGroupCheck);
+
+    // SkipClaimed false when no spline or arc check ran before, so there are
+    // no claimed edges to skip
+    template<typename Scalar, bool SkipClaimed = true>
+    int lineToleranceGroup(const BasicEdgeGeometry<Scalar> &aGeometry,
+                           const EdgeSpan &aGroup,
+                           const QVector<long> &aCurrentIDs,
+                           const double aTolerance,
+                           const double aNormalizeFactor,
+                           QVector<long> &aLocalIDs);
+
+    // aFixedPoint : the vertices are on the micrometre grid, see
+    // calculateArcParameters()
+    template<typename Scalar>
+    void arcResidualsGroup(const QList<PolygonEdge *> &aEdgeList,
+                           const EdgeSpan &aGroup,
+                           const double aNormalizeFactor,
+                           const bool aClosed,
+                           const bool aFixedPoint,
+                           QVector<double> &aResiduals);
+
+    int arcLabelGroup(const QVector<double> &aResiduals,
+                      const double aTolerance,
+                      const bool aClosed,
+                      QVector<long> &aLocalIDs);
+
+    template<typename Scalar>
+    int arcToleranceGroup(const QList<PolygonEdge *> &aEdgeList,
+                          const EdgeSpan &aGroup,
+                          const double aTolerance,
+                          const double aNormalizeFactor,
+                          const bool aClosed,
+                          const bool aFixedPoint,
+                          QVector<long> &aLocalIDs);
+
+    int splineToleranceGroup(const QList<PolygonEdge *> &aEdgeList,
+                             const EdgeSpan &aGroup,
+                             const double aTolerance,
+                             QVector<long> &aLocalIDs);
+
+    // Circle through the three vertices of two edges, false when there is
+    // none. Only fixed point vertices are tested for collinearity, exactly.
+    template<typename Scalar>
     bool calculateArcParameters(const PolygonEdge *aCurrentEdge,
                                 const PolygonEdge *aNextEdge,
-                                double &aCenterX,
-                                double &aCenterY,
-                                double &aRadius);
+                                const QPointF &aOrigin,
+                                const bool aFixedPoint,
+                                Scalar &aCenterX,
+                                Scalar &aCenterY,
+                                Scalar &aRadius);
+
+    template<typename Scalar>
+    void cascadeGroup(const QList<PolygonEdge *> &aEdgeList,
+                      const BasicEdgeGeometry<Scalar> &aGeometry,
+                      const EdgeSpan &aGroup,
+                      const DetectionParameters &aParams,
+                      const double aLineNormalizeFactor,
+                      QVector<long> &aGroupIDs,
+                      int &aNumLines,
+                      int &aNumArcs,
+                      int &aNumSplines);
+
+    // runDetection() for the Checks (CheckFlags) of aParams known at compile
+    // time, one instantiation per combination, see detector()
+    template<typename Scalar, int Checks>
+    DetectionResult runDetection(QList<PolygonEdge *> &aEdgeList,
+                                 const DetectionParameters &aParams);
+
+    typedef DetectionResult (PolyFeatureDetection::*Detector)(QList<PolygonEdge *> &,
+                                                               const DetectionParameters &);
+    static Detector detector(const DetectionParameters &aParams);
+
+    void updateMetrics(QList<PolygonEdge *> &aEdgeList, const DetectionParameters &aParams);
+
+    DetectionResult relabelFeatures(QList<PolygonEdge *> &aEdgeList,
+                                    const DetectionParameters &aParams);
+
+    template<int Checks>
+    void assignFeatureIDs(QList<PolygonEdge *> &aEdgeList,
+                          const QVector<EdgeSpan> &aGroups,
+                          const QVector<QVector<long>> &aGroupIDs,
+                          const QVector<int> &aSplineCounts,
+                          const QVector<int> &aArcCounts,
+                          const QVector<int> &aLineCounts,
+                          const DetectionParameters &aParams,
+                          DetectionResult &aResult);
 
     void calcSplineApprox_recursive(QVector<QPointF> &aInputPts,
-                                    QList<PolygonEdge *> &aEdgeCandidateList,
-                                    const double aTolerance);
+                                    const QList<PolygonEdge *> &aEdgeList,
+                                    EdgeSpan &aCandidateSpan,
+                                    const double aTolerance,
+                                    const int aDepth = 1);
 
     void calcSpline(QVector<QPointF> &aInputPts, QVector<QPointF> &aSplineCurvePts);
+    // Samples of every spline fit, 100 per polygon vertex within the bounds
+    // of SplineCurveFitter::setSplineSize()
+    int splineSize() const;
 
     void identifySplineErrors(QVector<QPointF> &aSplineCurvePts,
-                              QList<PolygonEdge *> &aEdgeList,
+                              const QList<PolygonEdge *> &aEdgeList,
+                              const EdgeSpan &aCandidateSpan,
                               const double aTolerance);
 
-    bool removeEdgeswithSplineErrors(QList<PolygonEdge *> &aEdgeList,
+    bool removeEdgeswithSplineErrors(const QList<PolygonEdge *> &aEdgeList,
+                                     EdgeSpan &aCandidateSpan,
                                      QVector<QPointF> &aCandidatePts,
                                      const double aTolerance);
 
     QSharedPointer<QVector<QPointF>> mPolyPoints;
+    bool mParallelGroups;
+    bool mCacheMetrics;
+    DetectionMetrics mMetrics;
+    FeatureResultCache *mResultCache;
+    bool mIncremental;
+    LayerHistory mLayerHistory;
+    int mReusedGroups;
+    DetectionStatsCollector mStatsCollector;
 };
 
 #endif // POLYFEATUREDETECTION_H
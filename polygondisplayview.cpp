@@ -130,6 +130,11 @@ void PolygonDisplayView::setCheckSharpEdges(const bool aCheckSharpEdges)
     mPolygonGraphicsItem->setCheckSharpAngleTol(aCheckSharpEdges);
 }
 
+void PolygonDisplayView::setCascadeDetection(const bool aCascade)
+{
+    mPolygonGraphicsItem->setCascadeDetection(aCascade);
+}
+
 void PolygonDisplayView::setMarkerDisplay(const bool aShow)
 {
     mPolygonGraphicsItem->setMarkerDisplay(aShow);
@@ -39,6 +39,7 @@ public:
     void setCheckArcTol(const bool aSetTol);
     void setCheckSplineTol(const bool aSetTol);
     void setCheckSharpEdges(const bool aCheckSharpEdges);
+    void setCascadeDetection(const bool aCascade);
 
     void setMarkerDisplay(const bool aShow);
 
@@ -1,6 +1,7 @@
 #ifndef POLYGONEDGE_H
 #define POLYGONEDGE_H
 
+#include "gridhash.h"
 #include <QObject>
 #include <QPointF>
 
@@ -35,8 +36,10 @@ public:
 
     bool isSplineCandidate(const double aSplineTol) const;
 
-    void setHash(const QString &aHashKey) { mHashKey = aHashKey; }
-    const QString &getHash(size_t aSeed);
+    // Hash of the end points snapped to a grid of aQuantum, so edges within
+    // rounding noise of each other hash the same (see VertexIndex for lookups
+    // that also match across grid cell boundaries)
+    std::size_t getHash(const double aQuantum = DEFAULT_HASH_QUANTUM, std::size_t aSeed = 0) const;
 
     double getAngle() const;
 
@@ -47,7 +50,6 @@ private:
     QPointF mp1, mp2;
     long mFeatureID;
     long mSharpEdgeID;
-    QString mHashKey;
     double mSplineError;
 };
 
@@ -0,0 +1,196 @@
+#include "polygonfileio.h"
+#include <QDataStream>
+#include <QFile>
+#include <QTextStream>
+
+const quint32 LAYER_FILE_MAGIC = 0x4C424650; // "PFBL"
+const quint32 LAYER_FORMAT_VERSION = 1;
+
+int PolygonLayer::vertexCount() const
+{
+    int lCount = 0;
+    for (const QVector<QPointF> &lLoop : mLoops) {
+        lCount += lLoop.count();
+    }
+    return lCount;
+}
+
+static bool isPolygonLayerFile(QFile &aFile)
+{
+    QByteArray lMagic = aFile.peek(sizeof(LAYER_FILE_MAGIC));
+    QDataStream lStream(lMagic);
+    lStream.setByteOrder(QDataStream::LittleEndian);
+    quint32 lValue = 0;
+    lStream >> lValue;
+    return lStream.status() == QDataStream::Ok && lValue == LAYER_FILE_MAGIC;
+}
+
+bool readPolygonFile(const QString &aFilePath, QVector<QPointF> &aPoints)
+{
+    QFile lPointData(aFilePath);
+    if (!lPointData.open(QFile::OpenMode{QIODevice::OpenModeFlag::ReadOnly})) {
+        return false;
+    }
+    if (isPolygonLayerFile(lPointData)) {
+        lPointData.close();
+        PolygonLayer lLayer;
+        if (!readPolygonLayerFile(aFilePath, lLayer)) {
+            return false;
+        }
+        aPoints = lLayer.mLoops.isEmpty() ? QVector<QPointF>() : lLayer.mLoops.first();
+        return true;
+    }
+    aPoints.clear();
+
+    QTextStream lInputStream(&lPointData);
+    QString newLine = lInputStream.readLine();
+    while (!newLine.isNull()) {
+        QStringList lNewPtStr = newLine.split(QString(","));
+        if (lNewPtStr.size() >= 2) {
+            QString xVal = lNewPtStr[0];
+            QString yVal = lNewPtStr[1];
+            QPointF lNewPt(xVal.toDouble(), yVal.toDouble());
+            aPoints.append(lNewPt);
+        }
+        newLine = lInputStream.readLine();
+    }
+
+    lPointData.close();
+    return true;
+}
+
+bool readSegmentFile(const QString &aFilePath, QVector<QLineF> &aSegments)
+{
+    QFile lSegmentData(aFilePath);
+    if (!lSegmentData.open(QFile::OpenMode{QIODevice::OpenModeFlag::ReadOnly})) {
+        return false;
+    }
+    aSegments.clear();
+    if (isPolygonLayerFile(lSegmentData)) {
+        return true; // loops, not segments
+    }
+
+    QTextStream lInputStream(&lSegmentData);
+    QString newLine = lInputStream.readLine();
+    while (!newLine.isNull()) {
+        QStringList lValues = newLine.split(QString(","));
+        if (lValues.size() >= 4) {
+            aSegments.append(QLineF(lValues[0].toDouble(),
+                                    lValues[1].toDouble(),
+                                    lValues[2].toDouble(),
+                                    lValues[3].toDouble()));
+        }
+        newLine = lInputStream.readLine();
+    }
+
+    lSegmentData.close();
+    return true;
+}
+
+bool writePolygonFile(const QString &aFilePath,
+                      const QVector<QPointF> &aPoints,
+                      const QStringList &aComments)
+{
+    QFile lPointData(aFilePath);
+    if (!lPointData.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        return false;
+    }
+
+    QTextStream lOutputStream(&lPointData);
+    for (const QString &lComment : aComments) {
+        lOutputStream << "; " << lComment << "\n";
+    }
+    for (const QPointF &lPoint : aPoints) {
+        lOutputStream << QString::number(lPoint.x(), 'f', 6) << " , "
+                      << QString::number(lPoint.y(), 'f', 6) << "\n";
+    }
+    lOutputStream.flush();
+
+    return lOutputStream.status() == QTextStream::Ok && lPointData.error() == QFile::NoError;
+}
+
+bool writePolygonLayerFile(const QString &aFilePath, const PolygonLayer &aLayer)
+{
+    QFile lLayerData(aFilePath);
+    if (!lLayerData.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    QDataStream lStream(&lLayerData);
+    lStream.setByteOrder(QDataStream::LittleEndian);
+    lStream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+    lStream << LAYER_FILE_MAGIC << LAYER_FORMAT_VERSION << quint32(aLayer.mLoops.count())
+            << quint32(aLayer.mFeatures.count());
+    for (const QVector<QPointF> &lLoop : aLayer.mLoops) {
+        lStream << quint32(lLoop.count());
+        for (const QPointF &lPoint : lLoop) {
+            lStream << lPoint.x() << lPoint.y();
+        }
+    }
+    for (const KnownFeature &lFeature : aLayer.mFeatures) {
+        lStream << quint32(lFeature.mKind) << quint32(lFeature.mLoop)
+                << quint32(lFeature.mFirstEdge) << quint32(lFeature.mEdgeCount);
+    }
+
+    return lStream.status() == QDataStream::Ok && lLayerData.error() == QFile::NoError;
+}
+
+bool readPolygonLayerFile(const QString &aFilePath, PolygonLayer &aLayer)
+{
+    QFile lLayerData(aFilePath);
+    if (!lLayerData.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream lStream(&lLayerData);
+    lStream.setByteOrder(QDataStream::LittleEndian);
+    lStream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+    quint32 lMagic = 0, lVersion = 0, lLoopCount = 0, lFeatureCount = 0;
+    lStream >> lMagic >> lVersion >> lLoopCount >> lFeatureCount;
+    if (lStream.status() != QDataStream::Ok || lMagic != LAYER_FILE_MAGIC
+        || lVersion != LAYER_FORMAT_VERSION) {
+        return false;
+    }
+
+    // counts are checked against the file size before anything is reserved
+    const qint64 lFileSize = lLayerData.size();
+    PolygonLayer lLayer;
+    for (quint32 l = 0; l < lLoopCount && lStream.status() == QDataStream::Ok; l++) {
+        quint32 lPointCount = 0;
+        lStream >> lPointCount;
+        if (qint64(lPointCount) * qint64(2 * sizeof(double)) > lFileSize) {
+            return false;
+        }
+        QVector<QPointF> lLoop;
+        lLoop.resize(int(lPointCount));
+        for (QPointF &lPoint : lLoop) {
+            double lX = 0.0, lY = 0.0;
+            lStream >> lX >> lY;
+            lPoint = QPointF(lX, lY);
+        }
+        lLayer.mLoops.append(lLoop);
+    }
+    for (quint32 f = 0; f < lFeatureCount && lStream.status() == QDataStream::Ok; f++) {
+        quint32 lKind = 0, lLoop = 0, lFirstEdge = 0, lEdgeCount = 0;
+        lStream >> lKind >> lLoop >> lFirstEdge >> lEdgeCount;
+        KnownFeature lFeature;
+        lFeature.mKind = KnownFeatureKind(lKind);
+        lFeature.mLoop = int(lLoop);
+        lFeature.mFirstEdge = int(lFirstEdge);
+        lFeature.mEdgeCount = int(lEdgeCount);
+        lLayer.mFeatures.append(lFeature);
+    }
+    if (lStream.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    aLayer = lLayer;
+    return true;
+}
+
+void closePolygon(QVector<QPointF> &aPoints)
+{
+    if (aPoints.count() >= 3) {
+        aPoints.append(aPoints.at(0));
+    }
+}
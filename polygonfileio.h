@@ -0,0 +1,69 @@
+#ifndef POLYGONFILEIO_H
+#define POLYGONFILEIO_H
+
+#include <QLineF>
+#include <QPointF>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Kind of a feature known to be in a polygon, e.g. one drawn by PolygonGenerator
+enum KnownFeatureKind {
+    KnownLine = 1,
+    KnownArc = 2,
+    KnownSpline = 3,
+    KnownTinyEdgeCorner = 4 // sharp corner drawn with tiny edges, each turning a few degrees
+};
+
+// aEdgeCount edges of loop aLoop, starting with the one from vertex aFirstEdge
+class KnownFeature
+{
+public:
+    KnownFeature()
+        : mKind(KnownLine)
+        , mLoop(0)
+        , mFirstEdge(0)
+        , mEdgeCount(0)
+    {}
+
+    KnownFeatureKind mKind;
+    int mLoop, mFirstEdge, mEdgeCount;
+};
+
+// The loops of one layer, outer perimeter first, without their first point
+// repeated, and the features known to be in them (if any)
+class PolygonLayer
+{
+public:
+    int vertexCount() const;
+
+    QVector<QVector<QPointF>> mLoops;
+    QVector<KnownFeature> mFeatures;
+};
+
+// Reads one polygon layer, one "x, y" point per line. Lines that don't have
+// two comma-separated values are skipped. Returns false, leaving aPoints
+// untouched, if the file can't be opened. A binary layer file (see
+// writePolygonLayerFile()) gives its outer loop.
+bool readPolygonFile(const QString &aFilePath, QVector<QPointF> &aPoints);
+
+// Writes aPoints as read by readPolygonFile(), after aComments as "; " lines
+bool writePolygonFile(const QString &aFilePath,
+                      const QVector<QPointF> &aPoints,
+                      const QStringList &aComments = QStringList());
+
+// Binary layer files : every loop and known feature of aLayer, little endian.
+// Far smaller and faster to read than text for layers of millions of points.
+bool writePolygonLayerFile(const QString &aFilePath, const PolygonLayer &aLayer);
+bool readPolygonLayerFile(const QString &aFilePath, PolygonLayer &aLayer);
+
+// Reads unordered segments, one "x1, y1, x2, y2" segment per line (e.g. moves
+// extracted from G-code), to be stitched with LoopAssembler. Lines that don't
+// have four comma-separated values are skipped.
+bool readSegmentFile(const QString &aFilePath, QVector<QLineF> &aSegments);
+
+// Appends the first point so that the last edge closes the polygon, as
+// expected by PolyFeatureDetection::createEdgeList().
+void closePolygon(QVector<QPointF> &aPoints);
+
+#endif // POLYGONFILEIO_H
@@ -0,0 +1,236 @@
+#include "polygongenerator.h"
+#include <math.h>
+#include <QLineF>
+#include <QRandomGenerator>
+
+// Every loop has at least this many sides, so that no corner is sharper than
+// a right angle and the sides bulging towards each other can't cross
+const int MIN_LOOP_SIDES = 6;
+const int MIN_LOOP_VERTICES = 2 * MIN_LOOP_SIDES;
+
+// Standard normal deviate (Box-Muller)
+static double gaussian(QRandomGenerator &aRandom)
+{
+    double lU1 = 1.0 - aRandom.generateDouble();
+    double lU2 = aRandom.generateDouble();
+    return sqrt(-2.0 * log(lU1)) * cos(2.0 * M_PI * lU2);
+}
+
+// +1 or -1, to bulge a side out of or into its loop
+static double randomSign(QRandomGenerator &aRandom)
+{
+    return (aRandom.generateDouble() < 0.5) ? -1.0 : 1.0;
+}
+
+static KnownFeatureKind pickSideKind(QRandomGenerator &aRandom,
+                                     const GeneratorParameters &aParams)
+{
+    double lLine = qMax(0.0, aParams.mLineWeight);
+    double lArc = qMax(0.0, aParams.mArcWeight);
+    double lSpline = qMax(0.0, aParams.mSplineWeight);
+    double lPick = aRandom.generateDouble() * (lLine + lArc + lSpline);
+    if (lPick < lLine || lLine + lArc + lSpline <= 0.0) {
+        return KnownLine;
+    }
+    return (lPick < lLine + lArc) ? KnownArc : KnownSpline;
+}
+
+// Points strictly between aStart and aEnd on a side of aEdgeCount edges. Arcs
+// and splines bulge by less than a fifth of the chord, and leave the corners
+// at less than 35 degrees from it.
+static void drawSide(QRandomGenerator &aRandom,
+                     const KnownFeatureKind aKind,
+                     const QPointF &aStart,
+                     const QPointF &aEnd,
+                     const int aEdgeCount,
+                     QVector<QPointF> &aInterior)
+{
+    aInterior.clear();
+    aInterior.reserve(aEdgeCount - 1);
+    const QPointF lChord = aEnd - aStart;
+    const double lLength = QLineF(aStart, aEnd).length();
+    const QPointF lDirection = lChord / lLength;
+    const QPointF lNormal(-lDirection.y(), lDirection.x());
+
+    if (aKind == KnownArc) {
+        // circle through both corners, sagitta 5 to 15 % of the chord
+        const double lSign = randomSign(aRandom);
+        const double lSagitta = (0.05 + 0.1 * aRandom.generateDouble()) * lLength;
+        const double lRadius = (lLength * lLength / 4.0 + lSagitta * lSagitta) / (2.0 * lSagitta);
+        const double lHalfAngle = asin(lLength / (2.0 * lRadius));
+        const QPointF lCenter = (aStart + aEnd) / 2.0 + lNormal * lSign * (lSagitta - lRadius);
+        for (int i = 1; i < aEdgeCount; i++) {
+            double lAngle = -lHalfAngle + 2.0 * lHalfAngle * i / aEdgeCount;
+            QPointF lRadial = sin(lAngle) * lDirection + lSign * cos(lAngle) * lNormal;
+            aInterior.append(lCenter + lRadius * lRadial);
+        }
+    } else if (aKind == KnownSpline) {
+        // skewed bump, so that no circle fits it
+        const double lHeight = randomSign(aRandom) * (0.04 + 0.06 * aRandom.generateDouble());
+        const double lSkew = randomSign(aRandom) * (0.3 + 0.4 * aRandom.generateDouble());
+        for (int i = 1; i < aEdgeCount; i++) {
+            double t = double(i) / aEdgeCount;
+            double lOffset = lHeight * sin(M_PI * t) * (1.0 + lSkew * sin(2.0 * M_PI * t));
+            aInterior.append(aStart + t * lChord + lOffset * lLength * lNormal);
+        }
+    } else {
+        for (int i = 1; i < aEdgeCount; i++) {
+            aInterior.append(aStart + lChord * (double(i) / aEdgeCount));
+        }
+    }
+}
+
+// Corner aCorner drawn as aEdgeCount tiny edges from the segment towards aPrev
+// to the segment towards aNext, well within the spacing of the vertices
+static void drawTinyEdgeCorner(const QPointF &aPrev,
+                               const QPointF &aCorner,
+                               const QPointF &aNext,
+                               const int aEdgeCount,
+                               QVector<QPointF> &aLoop)
+{
+    const double lPrevLength = QLineF(aCorner, aPrev).length();
+    const double lNextLength = QLineF(aCorner, aNext).length();
+    const double lRadius = 0.25 * qMin(lPrevLength, lNextLength);
+    const QPointF lIn = aCorner + (aPrev - aCorner) * (lRadius / lPrevLength);
+    const QPointF lOut = aCorner + (aNext - aCorner) * (lRadius / lNextLength);
+    for (int i = 0; i <= aEdgeCount; i++) {
+        double t = double(i) / aEdgeCount;
+        aLoop.append((1.0 - t) * (1.0 - t) * lIn + 2.0 * t * (1.0 - t) * aCorner + t * t * lOut);
+    }
+}
+
+// One loop of aVertexCount vertices around aCenter, counterclockwise for an
+// outer perimeter and clockwise for a hole
+static void drawLoop(QRandomGenerator &aRandom,
+                     const GeneratorParameters &aParams,
+                     const QPointF &aCenter,
+                     const double aRadius,
+                     const int aVertexCount,
+                     const bool aClockwise,
+                     PolygonLayer &aLayer)
+{
+    const int lLoopIndex = aLayer.mLoops.count();
+    const int lTinyEdges = qMax(2, aParams.mTinyEdgeCount);
+    int lSides = qMax(MIN_LOOP_SIDES, aVertexCount / qMax(2, aParams.mFeatureVertices));
+    lSides = qMin(lSides, aVertexCount / 2);
+
+    // Corners at irregular angles, no gap more than 5/3 of the mean one
+    QVector<double> lGaps(lSides);
+    double lGapSum = 0.0;
+    for (double &lGap : lGaps) {
+        lGap = 0.75 + 0.5 * aRandom.generateDouble();
+        lGapSum += lGap;
+    }
+    double lAngle = 2.0 * M_PI * aRandom.generateDouble();
+    const double lTurn = aClockwise ? -2.0 * M_PI / lGapSum : 2.0 * M_PI / lGapSum;
+    QVector<QPointF> lCorners(lSides);
+    QVector<bool> lTinyCorners(lSides);
+    int lNumTinyCorners = 0;
+    for (int i = 0; i < lSides; i++) {
+        lCorners[i] = aCenter + aRadius * QPointF(cos(lAngle), sin(lAngle));
+        lAngle += lTurn * lGaps.at(i);
+        lTinyCorners[i] = aRandom.generateDouble() < aParams.mTinyEdgeCorners;
+        lNumTinyCorners += lTinyCorners.at(i) ? 1 : 0;
+    }
+
+    // The vertices left after the tiny edges are shared out between the
+    // sides, each of at least 2 edges
+    for (int i = lSides - 1; i >= 0 && aVertexCount - lNumTinyCorners * lTinyEdges < 2 * lSides;
+         i--) {
+        if (lTinyCorners.at(i)) {
+            lTinyCorners[i] = false;
+            lNumTinyCorners--;
+        }
+    }
+    const int lSideEdges = aVertexCount - lNumTinyCorners * lTinyEdges;
+
+    QVector<KnownFeatureKind> lKinds(lSides);
+    QVector<QVector<QPointF>> lInteriors(lSides);
+    for (int i = 0; i < lSides; i++) {
+        int lEdgeCount = lSideEdges / lSides + ((i < lSideEdges % lSides) ? 1 : 0);
+        lKinds[i] = pickSideKind(aRandom, aParams);
+        drawSide(aRandom,
+                 lKinds.at(i),
+                 lCorners.at(i),
+                 lCorners.at((i + 1) % lSides),
+                 lEdgeCount,
+                 lInteriors[i]);
+    }
+
+    QVector<QPointF> lLoop;
+    lLoop.reserve(aVertexCount);
+    for (int i = 0; i < lSides; i++) {
+        if (lTinyCorners.at(i)) {
+            KnownFeature lCorner;
+            lCorner.mKind = KnownTinyEdgeCorner;
+            lCorner.mLoop = lLoopIndex;
+            lCorner.mFirstEdge = lLoop.count();
+            lCorner.mEdgeCount = lTinyEdges;
+            aLayer.mFeatures.append(lCorner);
+            drawTinyEdgeCorner(lInteriors.at((i + lSides - 1) % lSides).last(),
+                               lCorners.at(i),
+                               lInteriors.at(i).first(),
+                               lTinyEdges,
+                               lLoop);
+        } else {
+            lLoop.append(lCorners.at(i));
+        }
+
+        KnownFeature lSide;
+        lSide.mKind = lKinds.at(i);
+        lSide.mLoop = lLoopIndex;
+        lSide.mFirstEdge = lLoop.count() - 1;
+        lSide.mEdgeCount = lInteriors.at(i).count() + 1;
+        aLayer.mFeatures.append(lSide);
+        lLoop << lInteriors.at(i);
+    }
+
+    if (aParams.mNoise > 0.0) {
+        for (QPointF &lPoint : lLoop) {
+            lPoint += aParams.mNoise * QPointF(gaussian(aRandom), gaussian(aRandom));
+        }
+    }
+    aLayer.mLoops.append(lLoop);
+}
+
+PolygonGenerator::PolygonGenerator(const GeneratorParameters &aParams)
+    : mParams(aParams)
+{}
+
+PolygonLayer PolygonGenerator::generate() const
+{
+    QRandomGenerator lRandom(mParams.mSeed);
+    PolygonLayer lLayer;
+
+    // With sides of at most a quarter turn bulging by less than a fifth of
+    // their chord, the outer loop keeps clear of a circle of 0.46 its radius :
+    // holes are kept within 0.45 of it, and clear of each other.
+    const double lRadius = mParams.mSize / 2.0;
+    const QPointF lCenter(lRadius, lRadius);
+    const int lNumHoles = qMax(0, mParams.mHoleCount);
+    double lHoleRadius = 0.3 * lRadius;
+    double lHoleRing = 0.0;
+    if (lNumHoles > 1) {
+        lHoleRing = 0.3 * lRadius;
+        lHoleRadius = qMin(0.12 * lRadius, 0.7 * lHoleRing * sin(M_PI / lNumHoles));
+    }
+
+    // vertices shared out in proportion to the loop perimeters
+    int lHoleVertices = 0;
+    if (lNumHoles > 0) {
+        lHoleVertices = qRound(mParams.mVertexCount * lHoleRadius
+                               / (lRadius + lNumHoles * lHoleRadius));
+        lHoleVertices = qMax(MIN_LOOP_VERTICES, lHoleVertices);
+    }
+    const int lOuterVertices = qMax(MIN_LOOP_VERTICES,
+                                    mParams.mVertexCount - lNumHoles * lHoleVertices);
+
+    drawLoop(lRandom, mParams, lCenter, lRadius, lOuterVertices, false, lLayer);
+    for (int h = 0; h < lNumHoles; h++) {
+        double lAngle = 2.0 * M_PI * h / lNumHoles;
+        QPointF lHoleCenter = lCenter + lHoleRing * QPointF(cos(lAngle), sin(lAngle));
+        drawLoop(lRandom, mParams, lHoleCenter, lHoleRadius, lHoleVertices, true, lLayer);
+    }
+
+    return lLayer;
+}
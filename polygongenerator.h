@@ -0,0 +1,52 @@
+#ifndef POLYGONGENERATOR_H
+#define POLYGONGENERATOR_H
+
+#include "polygonfileio.h"
+
+// What a generated layer is made of. The outer loop and every hole are
+// drawn the same way : corners on a circle, joined by sides that are each
+// one line, arc or spline, picked with the given weights.
+class GeneratorParameters
+{
+public:
+    GeneratorParameters()
+        : mSeed(1)
+        , mVertexCount(1000)
+        , mSize(100.0)
+        , mFeatureVertices(32)
+        , mLineWeight(1.0)
+        , mArcWeight(1.0)
+        , mSplineWeight(1.0)
+        , mTinyEdgeCorners(0.0)
+        , mTinyEdgeCount(16)
+        , mNoise(0.0)
+        , mHoleCount(0)
+    {}
+
+    quint32 mSeed;         // same seed and parameters, same layer
+    int mVertexCount;      // over all loops
+    double mSize;          // outline diameter, the layer sits in [0, mSize] x [0, mSize]
+    int mFeatureVertices;  // mean vertices per side
+    double mLineWeight, mArcWeight, mSplineWeight;
+    double mTinyEdgeCorners; // fraction of corners drawn with mTinyEdgeCount tiny edges
+    int mTinyEdgeCount;
+    double mNoise; // standard deviation of the scan noise added to every vertex
+    int mHoleCount;
+};
+
+// Draws reproducible layers of any size with known features : every side is
+// reported as a KnownLine, KnownArc or KnownSpline and every corner drawn with
+// tiny edges as a KnownTinyEdgeCorner. Noise moves the vertices, not the
+// known features.
+class PolygonGenerator
+{
+public:
+    PolygonGenerator(const GeneratorParameters &aParams);
+
+    PolygonLayer generate() const;
+
+private:
+    GeneratorParameters mParams;
+};
+
+#endif // POLYGONGENERATOR_H
@@ -4,14 +4,18 @@
 #include <polygondisplayview.h>
 #include <QCursor>
 #include <QDebug>
+#include <QDir>
 #include <QEvent>
 #include <QMouseEvent>
 #include <QPainter>
 #include <QPointF>
 #include <QPolygonF>
 #include <QSharedPointer>
+#include <QStandardPaths>
 #include <QStyleOptionGraphicsItem>
+#include <QTransform>
 #include <QVector>
+#include <QtConcurrent>
 
 PolygonGraphicsItem::PolygonGraphicsItem(const QRectF &aRect, QGraphicsView *parent)
     : mParent(parent)
@@ -21,6 +25,10 @@ PolygonGraphicsItem::PolygonGraphicsItem(const QRectF &aRect, QGraphicsView *par
     , mCheckArcs(false)
     , mCheckSplines(false)
     , mShowMarkers(false)
+    , mCascadeDetection(false)
+    , mShowDetectionStats(false)
+    , mDetectionDirty(true)
+    , mLabelVersion(0)
     , mLineTolerance(DEFAULT_LINE_TOL)
     , mArcTolerance(DEFAULT_ARC_TOL)
     , mSplineTolerance(DEFAULT_SPLINE_TOL)
@@ -31,12 +39,19 @@ PolygonGraphicsItem::PolygonGraphicsItem(const QRectF &aRect, QGraphicsView *par
     m_rect = aRect;
     mPointsList = QSharedPointer<QVector<QPointF>>(new QVector<QPointF>());
     setAcceptHoverEvents(true);
+    // for QStyleOptionGraphicsItem::exposedRect
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+    connect(&mTileWatcher,
+            &QFutureWatcher<QVector<QImage>>::finished,
+            this,
+            &PolygonGraphicsItem::tilesRendered);
     // setAcceptedMouseButtons({Qt::MouseButton::LeftButton,
     // Qt::MouseButton::RightButton});
 }
 
 PolygonGraphicsItem::~PolygonGraphicsItem()
 {
+    waitForTiles();
     mPointsList->clear();
 }
 
@@ -56,21 +71,31 @@ void PolygonGraphicsItem::setItemScaling(qreal aScaleFactor)
 void PolygonGraphicsItem::setLineTolerance(const double aDeviationVal)
 {
     mLineTolerance = aDeviationVal;
+    mDetectionDirty = true;
 }
 
 void PolygonGraphicsItem::setArcTolerance(const double aDeviationVal)
 {
     mArcTolerance = aDeviationVal;
+    mDetectionDirty = true;
 }
 
 void PolygonGraphicsItem::setSplineTolerance(const double aDeviationVal)
 {
     mSplineTolerance = aDeviationVal;
+    mDetectionDirty = true;
 }
 
 void PolygonGraphicsItem::setSharpAngleTolerance(const double aTolerance)
 {
     mSharpAngleTolerance = aTolerance;
+    mDetectionDirty = true;
+}
+
+void PolygonGraphicsItem::setCascadeDetection(const bool aCascade)
+{
+    mCascadeDetection = aCascade;
+    mDetectionDirty = true;
 }
 
 QPolygonF PolygonGraphicsItem::recalcPolygon(const QPolygonF &aPolygon)
@@ -107,6 +132,7 @@ m_fitCurve = true;*/
 
 void PolygonGraphicsItem::setPolyPoints(QSharedPointer<QVector<QPointF>> aPointsList)
 {
+    waitForTiles();
     prepareGeometryChange();
 
     if (aPointsList != nullptr) {
@@ -133,13 +159,30 @@ void PolygonGraphicsItem::setPolyPoints(QSharedPointer<QVector<QPointF>> aPoints
     if (mPolyFeatureDetection == nullptr) {
         mPolyFeatureDetection = new PolyFeatureDetection(mPointsList);
         mPolyFeatureDetection->createEdgeList(mPolyEdgeList);
+        // tolerance changes and repaints only relabel the edges, and going back
+        // to an earlier set of parameters reuses its labels
+        mPolyFeatureDetection->setMetricsCaching(true);
+        mPolyFeatureDetection->setResultCache(&mResultCache);
+        // and so do polygons detected in earlier sessions
+        QString lCacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+        if (QDir().mkpath(lCacheDir) && mDiskCache.open(lCacheDir + "/detection.cache")) {
+            mResultCache.setDiskCache(&mDiskCache);
+        }
+    } else {
+        mPolyFeatureDetection->invalidateMetrics();
     }
+    mEdgeGrid.build(mPolyEdgeList);
+    mDetectionDirty = true;
+    labelsChanged();
+    // nothing of the last polygon is shown, not even while tiles render
+    mTileCache.clear();
     update();
 }
 
 void PolygonGraphicsItem::setCheckLineTol(const bool aCheck)
 {
     mCheckLines = aCheck;
+    mDetectionDirty = true;
     if (!mCheckLines) {
         for (auto lEdge : mPolyEdgeList) {
             if (lEdge->getSharpEdgeID() > LINE_FEATURE_ID) {
@@ -152,6 +195,7 @@ void PolygonGraphicsItem::setCheckLineTol(const bool aCheck)
 void PolygonGraphicsItem::setCheckArcTol(const bool aCheck)
 {
     mCheckArcs = aCheck;
+    mDetectionDirty = true;
     if (!mCheckArcs) {
         for (auto lEdge : mPolyEdgeList) {
             if (lEdge->getSharpEdgeID() > ARC_FEATURE_ID
@@ -165,6 +209,7 @@ void PolygonGraphicsItem::setCheckArcTol(const bool aCheck)
 void PolygonGraphicsItem::setCheckSplineTol(const bool aCheck)
 {
     mCheckSplines = aCheck;
+    mDetectionDirty = true;
     if (!mCheckSplines) {
         for (auto lEdge : mPolyEdgeList) {
             if (lEdge->getSharpEdgeID() > SPLINE_FEATURE_ID
@@ -175,9 +220,16 @@ void PolygonGraphicsItem::setCheckSplineTol(const bool aCheck)
     }
 }
 
+void PolygonGraphicsItem::showDetectionStats()
+{
+    mShowDetectionStats = true;
+    mDetectionDirty = true;
+}
+
 void PolygonGraphicsItem::setCheckSharpAngleTol(const bool aCheck)
 {
     mCheckSharpEdges = aCheck;
+    mDetectionDirty = true;
     if (!mCheckSharpEdges) {
         // reset Sharp Angle Edge IDs
         for (auto lEdge : mPolyEdgeList) {
@@ -186,6 +238,24 @@ void PolygonGraphicsItem::setCheckSharpAngleTol(const bool aCheck)
     }
 }
 
+// Pen colour of an edge : shades of red for splines, green for arcs, blue for
+// lines and cyan for sharp-angle groups. Other edges keep aPrevious.
+static Qt::GlobalColor edgeColor(const PolygonEdge *aEdge, const Qt::GlobalColor aPrevious)
+{
+    const long lFeatureID = aEdge->getFeatureID();
+    const long lSharpEdgeID = aEdge->getSharpEdgeID();
+    if (lFeatureID > SPLINE_FEATURE_ID) {
+        return Qt::GlobalColor((lFeatureID % 10) + Qt::GlobalColor::red);
+    } else if (lFeatureID > ARC_FEATURE_ID) {
+        return Qt::GlobalColor((lFeatureID % 10) + Qt::GlobalColor::green);
+    } else if (lFeatureID > LINE_FEATURE_ID) {
+        return Qt::GlobalColor((lFeatureID % 10) + Qt::GlobalColor::blue);
+    } else if (lSharpEdgeID > DEFAULT_SHARPEDGE_ID) {
+        return Qt::GlobalColor((lSharpEdgeID % 10) + Qt::GlobalColor::cyan);
+    }
+    return aPrevious;
+}
+
 void PolygonGraphicsItem::paint(QPainter *aPainter,
                                 const QStyleOptionGraphicsItem *aOptions,
                                 QWidget *aWidget)
@@ -193,105 +263,311 @@ void PolygonGraphicsItem::paint(QPainter *aPainter,
     aPainter->setRenderHint(QPainter::Antialiasing, true);
     aPainter->setPen(QPen(lightgreen, 0.5));
     if (mPointsList && mPointsList->count() > 0) {
-        if (mDecomposing) {
-            aPainter->setPen(QPen(Qt::GlobalColor::lightGray, 0.5));
-            if (mPolyFeatureDetection != nullptr) {
-                int numLines = 0;
-                int numArcs = 0;
-                int numSplines = 0;
-                int numSharpEdges = 0;
-
-                // Reset feature IDs and sharp-edge IDs
-                for (auto lEdge : mPolyEdgeList) {
-                    lEdge->setFeatureID(0);
-                    lEdge->setSharpEdgeID(0);
-                }
-
-                double lSharpAngleTol = DEFAULT_SHARP_ANGLE_TOL;
-                if (mCheckSplines) {
-                    numSplines = mPolyFeatureDetection->splineToleranceCheck(mPolyEdgeList, mSplineTolerance,
-                                                                             mCheckSharpEdges, lSharpAngleTol);
-                }
-                if (mCheckArcs) {
-                    numArcs = mPolyFeatureDetection->arcToleranceCheck(mPolyEdgeList, mArcTolerance,
-                                                                       mCheckSharpEdges, lSharpAngleTol);
-                }
-                if (mCheckLines) {
-                    numLines = mPolyFeatureDetection->lineToleranceCheck(mPolyEdgeList, mLineTolerance, 
-                                                                         mCheckSharpEdges, lSharpAngleTol);
-                }
-                
-                if (mCheckSharpEdges && 
-                        !mCheckLines && !mCheckArcs && !mCheckSplines) {
-                    numSharpEdges = mPolyFeatureDetection
-                                        ->sharpAngleToleranceCheck(mPolyEdgeList,
-                                                                   mSharpAngleTolerance);
-                    lSharpAngleTol = mSharpAngleTolerance;
-                }
-
-
-                // Draw edges
-                for (int i = 0; i < mPolyEdgeList.count(); i++) {
-                    PolygonEdge *lPolyEdge = mPolyEdgeList.at(i);
-                    long lFeatureID = lPolyEdge->getFeatureID();
-                    long lSharpEdgeID = lPolyEdge->getSharpEdgeID();
-
-                    if (lFeatureID > SPLINE_FEATURE_ID) {
-                        aPainter->setPen(
-                            QPen(Qt::GlobalColor((lFeatureID % 10) + Qt::GlobalColor::red), 0.5));
-                    } else if (lFeatureID > ARC_FEATURE_ID) {
-                        aPainter->setPen(
-                            QPen(Qt::GlobalColor((lFeatureID % 10) + Qt::GlobalColor::green), 0.5));
-                    } else if (lFeatureID > LINE_FEATURE_ID) {
-                        aPainter->setPen(
-                            QPen(Qt::GlobalColor((lFeatureID % 10) + Qt::GlobalColor::blue), 0.5));
-                    } else if (lSharpEdgeID > DEFAULT_SHARPEDGE_ID) {
-                        aPainter->setPen(
-                            QPen(Qt::GlobalColor((lSharpEdgeID % 10) + Qt::GlobalColor::cyan), 0.5));
-                    }
-                    aPainter->drawLine(lPolyEdge->getPoint1(), lPolyEdge->getPoint2());
-                }
-            }
+        if (!mDecomposing) {
+            mShowDetectionStats = false;
+        } else if (mPolyFeatureDetection != nullptr && mDetectionDirty) {
+            updateLabels();
+        }
+
+        // Views that only scale and translate the item draw cached tiles,
+        // rotated or sheared ones draw the edges in view directly
+        const QTransform lTransform = aPainter->worldTransform();
+        if (lTransform.type() <= QTransform::TxScale && lTransform.m11() > 0.0
+            && lTransform.m11() == lTransform.m22()) {
+            drawTiles(aPainter, aOptions->exposedRect);
+        } else {
+            const double lPixelSize = 1.0
+                                      / QStyleOptionGraphicsItem::levelOfDetailFromTransform(
+                                          lTransform);
+            mEdgeGrid.query(aOptions->exposedRect, mVisibleEdges);
+            drawEdges(aPainter, mVisibleEdges, lPixelSize, mEdgeBatches);
             // Draw markers/symbols
             if (mShowMarkers) {
-                aPainter->save();
-                for (int i = 0; i < mPointsList->count(); i++) {
-                    double x2 = mPointsList->at(i).x();
-                    double y2 = mPointsList->at(i).y();
-                    // draw symbol/marker
-                    DataMarker lMarker(QPointF(x2, y2), SymbolType::Plus, grey);
-                    lMarker.paint(aPainter, aOptions, aWidget);
-                }
-                aPainter->restore();
-            }
-        } else { // if (!mDecomposing)
-            QPolygonF lPolygon;
-            lPolygon << *mPointsList;
-            // QPolygonF lPolygon = recalcPolygon(lOrigPolygon);
-            aPainter->save();
-            aPainter->setPen(QPen(lightgray, 0.5));
-            aPainter->drawPolygon(lPolygon);
-            aPainter->restore();
-
-            // draw symbols/markers
-            if (mShowMarkers) {
-                aPainter->save();
-                for (int i = 0; i < mPointsList->count(); i++) {
-                    double x1 = mPointsList->at(i).x();
-                    double y1 = mPointsList->at(i).y();
-                    DataMarker lMarker(QPointF(x1, y1), SymbolType::Plus, grey);
-                    lMarker.paint(aPainter, aOptions, aWidget);
-                }
-                aPainter->restore();
+                drawMarkers(aPainter, mVisibleEdges, lPixelSize, mMarkerLines);
             }
         }
     }
     aPainter->setRenderHint(QPainter::Antialiasing, false);
 }
 
+void PolygonGraphicsItem::updateLabels()
+{
+    DetectionParameters lParams;
+    lParams.mMode = mCascadeDetection ? CascadeDetection : SequentialDetection;
+    lParams.mCheckLines = mCheckLines;
+    lParams.mCheckArcs = mCheckArcs;
+    lParams.mCheckSplines = mCheckSplines;
+    lParams.mCheckSharpEdges = mCheckSharpEdges;
+    lParams.mLineTolerance = mLineTolerance;
+    lParams.mArcTolerance = mArcTolerance;
+    lParams.mSplineTolerance = mSplineTolerance;
+    // Line, arc and spline checks group sharp features using the
+    // default angle tolerance, sharp-angle-only runs use the user's.
+    lParams.mSharpAngleTolerance = DEFAULT_SHARP_ANGLE_TOL;
+    if (!mCheckLines && !mCheckArcs && !mCheckSplines) {
+        lParams.mSharpAngleTolerance = mSharpAngleTolerance;
+    }
+
+    // Resets and recomputes feature IDs and sharp-edge IDs
+    waitForTiles();
+    DetectionResult lResult = mPolyFeatureDetection->detectFeatures(mPolyEdgeList, lParams);
+    if (mShowDetectionStats && DetectionStats::enabled()) {
+        emit updateStatusBarText(lResult.mStats.summary());
+    }
+    mShowDetectionStats = false;
+    mDetectionDirty = false;
+
+    // colours of all edges, an edge in view can take its colour from one that is not
+    mEdgeColors.resize(mPolyEdgeList.count());
+    Qt::GlobalColor lColor = Qt::GlobalColor::lightGray;
+    for (int i = 0; i < mPolyEdgeList.count(); i++) {
+        lColor = edgeColor(mPolyEdgeList.at(i), lColor);
+        mEdgeColors[i] = quint8(lColor);
+    }
+    labelsChanged();
+}
+
+void PolygonGraphicsItem::labelsChanged()
+{
+    // tiles of the last labels stand in for the new ones until rendered
+    mLabelVersion++;
+    mTileCache.removeOlderThan(mLabelVersion - 1);
+}
+
+void PolygonGraphicsItem::waitForTiles()
+{
+    mTileWatcher.waitForFinished();
+}
+
+void PolygonGraphicsItem::tilesRendered()
+{
+    const QVector<QImage> lRendered = mTileWatcher.result();
+    for (int i = 0; i < mRenderingTiles.count(); i++) {
+        // labels changed meanwhile, the tile is already out of date
+        if (mRenderingTiles.at(i).mLabelVersion == mLabelVersion) {
+            mTileCache.insert(mRenderingTiles.at(i), lRendered.at(i));
+        }
+    }
+    mRenderingTiles.clear();
+    update();
+}
+
+void PolygonGraphicsItem::drawTiles(QPainter *aPainter, const QRectF &aExposedRect)
+{
+    const QTransform lTransform = aPainter->worldTransform();
+    const double lZoom = lTransform.m11();
+    const QRectF lRect = aExposedRect.intersected(boundingRect());
+    if (lRect.isEmpty()) {
+        return;
+    }
+
+    // Tiles start on the whole device pixel at or before the item origin and
+    // are rendered with the fraction of a pixel left (the phase), so the edges
+    // land where the item transform puts them when drawn without tiles
+    const double lOriginX = floor(lTransform.dx());
+    const double lOriginY = floor(lTransform.dy());
+    const double lPhaseX = lTransform.dx() - lOriginX;
+    const double lPhaseY = lTransform.dy() - lOriginY;
+
+    // tiles over the exposed rect
+    const int lFirstX = int(floor((lRect.left() * lZoom + lPhaseX) / RENDER_TILE_SIZE));
+    const int lLastX = int(floor((lRect.right() * lZoom + lPhaseX) / RENDER_TILE_SIZE));
+    const int lFirstY = int(floor((lRect.top() * lZoom + lPhaseY) / RENDER_TILE_SIZE));
+    const int lLastY = int(floor((lRect.bottom() * lZoom + lPhaseY) / RENDER_TILE_SIZE));
+    QVector<RenderTileKey> lKeys, lMissing;
+    QVector<QImage> lTiles;
+    for (int y = lFirstY; y <= lLastY; y++) {
+        for (int x = lFirstX; x <= lLastX; x++) {
+            const RenderTileKey lKey(lZoom, lPhaseX, lPhaseY, x, y, mLabelVersion);
+            lKeys.append(lKey);
+            lTiles.append(mTileCache.tile(lKey));
+            if (lTiles.last().isNull()) {
+                lMissing.append(lKey);
+                // the tile of the last labels until this one is rendered, if any
+                lTiles.last() = mTileCache.tile(
+                    RenderTileKey(lZoom, lPhaseX, lPhaseY, x, y, mLabelVersion - 1));
+            }
+        }
+    }
+
+    // Missing tiles are rendered in the background, in parallel, each with a
+    // QPainter on its own QImage, and tilesRendered() repaints once they are
+    // in. One batch at a time : tiles still missing then are asked for by
+    // that repaint.
+    if (!lMissing.isEmpty() && !mTileWatcher.isRunning()) {
+        mRenderingTiles = lMissing;
+        mTileWatcher.setFuture(QtConcurrent::run([this, lMissing]() {
+            QVector<QImage> lRendered(lMissing.count());
+            QVector<int> lIndices(lMissing.count());
+            for (int i = 0; i < lIndices.count(); i++) {
+                lIndices[i] = i;
+            }
+            QtConcurrent::blockingMap(lIndices, [&](const int &i) {
+                lRendered[i] = renderTile(lMissing.at(i));
+            });
+            return lRendered;
+        }));
+    }
+
+    aPainter->save();
+    aPainter->setWorldTransform(QTransform());
+    for (int i = 0; i < lKeys.count(); i++) {
+        if (!lTiles.at(i).isNull()) {
+            aPainter->drawImage(QPointF(lOriginX + lKeys.at(i).mX * RENDER_TILE_SIZE,
+                                        lOriginY + lKeys.at(i).mY * RENDER_TILE_SIZE),
+                                lTiles.at(i));
+        }
+    }
+    aPainter->restore();
+}
+
+QImage PolygonGraphicsItem::renderTile(const RenderTileKey &aKey) const
+{
+    QImage lTile(RENDER_TILE_SIZE, RENDER_TILE_SIZE, QImage::Format_ARGB32_Premultiplied);
+    lTile.fill(Qt::transparent);
+
+    // tile pixels from item units, and the item rect of the tile with room for
+    // the pens and markers of edges just outside it
+    const double lPixelSize = 1.0 / aKey.mZoom;
+    const QRectF lRect = QRectF((aKey.mX * RENDER_TILE_SIZE - aKey.mPhaseX) * lPixelSize,
+                                (aKey.mY * RENDER_TILE_SIZE - aKey.mPhaseY) * lPixelSize,
+                                RENDER_TILE_SIZE * lPixelSize,
+                                RENDER_TILE_SIZE * lPixelSize)
+                             .adjusted(-2 * MARKER_SIZE,
+                                       -2 * MARKER_SIZE,
+                                       2 * MARKER_SIZE,
+                                       2 * MARKER_SIZE);
+    QVector<int> lEdges;
+    mEdgeGrid.query(lRect, lEdges);
+
+    QPainter lPainter(&lTile);
+    lPainter.setRenderHint(QPainter::Antialiasing, true);
+    lPainter.setTransform(QTransform(aKey.mZoom,
+                                     0.0,
+                                     0.0,
+                                     aKey.mZoom,
+                                     aKey.mPhaseX - aKey.mX * RENDER_TILE_SIZE,
+                                     aKey.mPhaseY - aKey.mY * RENDER_TILE_SIZE));
+    QVector<QVector<QLineF>> lBatches;
+    drawEdges(&lPainter, lEdges, lPixelSize, lBatches);
+    if (mShowMarkers) {
+        QVector<QLineF> lMarkerLines;
+        drawMarkers(&lPainter, lEdges, lPixelSize, lMarkerLines);
+    }
+    return lTile;
+}
+
+void PolygonGraphicsItem::drawEdges(QPainter *aPainter,
+                                    const QVector<int> &aEdges,
+                                    const double aPixelSize,
+                                    QVector<QVector<QLineF>> &aBatches) const
+{
+    // One batch of lines per colour, and one drawLines() per batch instead of
+    // a setPen() and drawLine() per edge. The batches keep their capacity
+    // between repaints.
+    if (aBatches.count() != EDGE_COLOR_COUNT) {
+        aBatches.resize(EDGE_COLOR_COUNT);
+    }
+    for (QVector<QLineF> &lBatch : aBatches) {
+        lBatch.clear();
+    }
+
+    // feature colours once detected, the outline alone in light gray
+    const bool lFeatureColors = mDecomposing && mEdgeColors.count() == mPolyEdgeList.count();
+
+    // Consecutive edges of one colour are drawn as chords of at least a pixel :
+    // an edge shorter than that is merged with the ones after it, so a zoomed
+    // out layer draws about as many lines as the view has pixels along it
+    const double lMinLength2 = aPixelSize * aPixelSize;
+    Qt::GlobalColor lRunColor = Qt::GlobalColor::lightGray;
+    QPointF lChordStart, lChordEnd;
+    bool lPending = false;
+    int lPrevious = -2;
+    for (const int i : aEdges) {
+        const PolygonEdge *lPolyEdge = mPolyEdgeList.at(i);
+        const Qt::GlobalColor lColor = lFeatureColors ? Qt::GlobalColor(mEdgeColors.at(i))
+                                                      : Qt::GlobalColor::lightGray;
+        if (i != lPrevious + 1 || lColor != lRunColor) {
+            if (lPending) {
+                aBatches[lRunColor].append(QLineF(lChordStart, lChordEnd));
+            }
+            lRunColor = lColor;
+            lChordStart = lPolyEdge->getPoint1();
+        }
+        lPrevious = i;
+        lChordEnd = lPolyEdge->getPoint2();
+        const QPointF lChord = lChordEnd - lChordStart;
+        lPending = QPointF::dotProduct(lChord, lChord) < lMinLength2;
+        if (!lPending) {
+            aBatches[lRunColor].append(QLineF(lChordStart, lChordEnd));
+            lChordStart = lChordEnd;
+        }
+    }
+    if (lPending) {
+        aBatches[lRunColor].append(QLineF(lChordStart, lChordEnd));
+    }
+
+    for (int c = 0; c < aBatches.count(); c++) {
+        if (!aBatches.at(c).isEmpty()) {
+            aPainter->setPen(QPen(Qt::GlobalColor(c), 0.5));
+            aPainter->drawLines(aBatches.at(c));
+        }
+    }
+}
+
+void PolygonGraphicsItem::drawMarkers(QPainter *aPainter,
+                                      const QVector<int> &aEdges,
+                                      const double aPixelSize,
+                                      QVector<QLineF> &aMarkerLines) const
+{
+    // The plus signs of DataMarker on the vertices of aEdges, all in one
+    // drawLines(). A vertex closer than MIN_MARKER_SPACING pixels to the
+    // last marker drawn gets none, they would only overlap.
+    const double lHalfSize = MARKER_SIZE / sqrt(2.0);
+    const double lMinSpacing2 = pow(MIN_MARKER_SPACING * aPixelSize, 2);
+    QPointF lLastMarker;
+    bool lFirst = true;
+    auto lAddMarker = [&](const QPointF &aPoint) {
+        const QPointF lOffset = aPoint - lLastMarker;
+        if (!lFirst && QPointF::dotProduct(lOffset, lOffset) < lMinSpacing2) {
+            return;
+        }
+        lFirst = false;
+        lLastMarker = aPoint;
+        aMarkerLines.append(
+            QLineF(aPoint.x() - lHalfSize, aPoint.y(), aPoint.x() + lHalfSize, aPoint.y()));
+        aMarkerLines.append(
+            QLineF(aPoint.x(), aPoint.y() - lHalfSize, aPoint.x(), aPoint.y() + lHalfSize));
+    };
+
+    aMarkerLines.clear();
+    for (int k = 0; k < aEdges.count(); k++) {
+        const int i = aEdges.at(k);
+        lAddMarker(mPolyEdgeList.at(i)->getPoint1());
+        // last edge of a stretch in view
+        if (k + 1 == aEdges.count() || aEdges.at(k + 1) != i + 1) {
+            lAddMarker(mPolyEdgeList.at(i)->getPoint2());
+        }
+    }
+
+    aPainter->save();
+    aPainter->setBrush(Qt::NoBrush);
+    aPainter->setPen(QPen(grey, MARKER_SIZE));
+    aPainter->drawLines(aMarkerLines);
+    aPainter->restore();
+}
+
 QRectF PolygonGraphicsItem::boundingRect() const
 {
-    return m_rect;
+    // the polygon with room for the markers and pens, so that only the part
+    // of it in view is exposed
+    if (mEdgeGrid.isEmpty()) {
+        return m_rect;
+    }
+    return mEdgeGrid.bounds().adjusted(-2 * MARKER_SIZE,
+                                       -2 * MARKER_SIZE,
+                                       2 * MARKER_SIZE,
+                                       2 * MARKER_SIZE);
 }
 
 void PolygonGraphicsItem::mousePressEvent(QMouseEvent *event)
@@ -339,7 +615,9 @@ QRectF PolygonGraphicsItem::getBoundingRect() const
 
 void PolygonGraphicsItem::setMarkerDisplay(const bool aShow)
 {
+    waitForTiles();
     mShowMarkers = aShow;
+    labelsChanged();
 }
 
 void PolygonGraphicsItem::getMinMax(double &aMinX, double &aMinY, double &aMaxX, double &aMaxY)
@@ -365,15 +643,24 @@ void PolygonGraphicsItem::mouseReleaseEvent(QMouseEvent *event)
 
 void PolygonGraphicsItem::decompose_polygon(const bool aFindEdges)
 {
+    waitForTiles();
     mDecomposing = aFindEdges;
+    mDetectionDirty = true;
+    labelsChanged();
     prepareGeometryChange();
     update();
 }
 
 void PolygonGraphicsItem::clearData()
 {
+    waitForTiles();
     mPointsList->clear();
     mPolyEdgeList.clear();
     delete mPolyFeatureDetection;
     mPolyFeatureDetection = NULL;
+    prepareGeometryChange();
+    mEdgeGrid.clear();
+    mEdgeColors.clear();
+    labelsChanged();
+    mTileCache.clear();
 }
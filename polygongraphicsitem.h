@@ -1,8 +1,11 @@
 #ifndef POLYGONGRAPHICSITEM_H
 #define POLYGONGRAPHICSITEM_H
 
+#include <edgegrid.h>
 #include <memory.h>
 #include <polyfeaturedetection.h>
+#include <rendertilecache.h>
+#include <QFutureWatcher>
 #include <QGraphicsItem>
 #include <QGraphicsView>
 #include <QPainter>
@@ -13,6 +16,9 @@
 const int DATAMARKERSIZE = 1;
 const int LINE_WIDTH = 1;
 const double POINT_CLICK_TOLERANCE = 10.0;
+const double MARKER_SIZE = 0.5; // width and height of the vertex markers
+const int EDGE_COLOR_COUNT = Qt::GlobalColor::transparent + 1;
+const double MIN_MARKER_SPACING = 3.0; // pixels between the centres of drawn markers
 
 class PolygonGraphicsItem : public QObject, public QGraphicsItem
 {
@@ -39,6 +45,10 @@ public:
     void setCheckArcTol(const bool aCheck);
     void setCheckSplineTol(const bool aCheck);
     void setCheckSharpAngleTol(const bool aCheck);
+    void setCascadeDetection(const bool aCascade);
+
+    // Show the DetectionStats of the next detection run in the status bar
+    void showDetectionStats();
 
     // virtual bool event(QEvent *event) override;
     void mousePressEvent(QMouseEvent *event);
@@ -56,22 +66,64 @@ protected:
                        QWidget *aWidget) override;
     virtual QRectF boundingRect() const override;
 
+    // Runs the detection with the current parameters, new label version
+    void updateLabels();
+    // What is drawn changed, cached tiles are dropped
+    void labelsChanged();
+
+    void drawTiles(QPainter *aPainter, const QRectF &aExposedRect);
+    // Edges and markers of one tile, can be called from any thread
+    QImage renderTile(const RenderTileKey &aKey) const;
+    // Called before the edges, their colours or the markers change : tiles
+    // are rendered from them in the background
+    void waitForTiles();
+    void drawEdges(QPainter *aPainter,
+                   const QVector<int> &aEdges,
+                   const double aPixelSize,
+                   QVector<QVector<QLineF>> &aBatches) const;
+    void drawMarkers(QPainter *aPainter,
+                     const QVector<int> &aEdges,
+                     const double aPixelSize,
+                     QVector<QLineF> &aMarkerLines) const;
+
 public:
 signals:
     void updateStatusBarText(const QString &aText);
 
 public slots:
 
+private slots:
+    // The tiles rendered in the background are in, repaint with them
+    void tilesRendered();
+
 private:
     QRectF m_rect;
     QSharedPointer<QVector<QPointF>> mPointsList;
     PolyFeatureDetection *mPolyFeatureDetection;
+    DiskResultCache mDiskCache;
+    FeatureResultCache mResultCache;
     QList<PolygonEdge *> mPolyEdgeList;
     QGraphicsView *mParent;
     QPointF mPointOffset;
     double mSharpAngleTolerance, mLineTolerance, mArcTolerance, mSplineTolerance;
     bool mDecomposing, mShowMarkers;
     bool mCheckSharpEdges, mCheckLines, mCheckArcs, mCheckSplines;
+    bool mCascadeDetection;
+    bool mShowDetectionStats;
+    // labels older than the parameters, version of what is drawn
+    bool mDetectionDirty;
+    quint64 mLabelVersion;
+    // edges by pen colour (Qt::GlobalColor) and the marker lines, kept between repaints
+    QVector<QVector<QLineF>> mEdgeBatches;
+    QVector<QLineF> mMarkerLines;
+    // edges by position, built once per polygon, and those in the exposed rect
+    EdgeGrid mEdgeGrid;
+    QVector<int> mVisibleEdges;
+    QVector<quint8> mEdgeColors;
+    RenderTileCache mTileCache;
+    // tiles being rendered, see drawTiles()
+    QFutureWatcher<QVector<QImage>> mTileWatcher;
+    QVector<RenderTileKey> mRenderingTiles;
 };
 
 #endif // POLYGONGRAPHICSITEM_H
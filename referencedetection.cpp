@@ -0,0 +1,697 @@
+#include "referencedetection.h"
+#include <limits.h>
+#include <math.h>
+#include <QLineF>
+#include <QPainterPath>
+#include <QPointF>
+
+// The spline fit of SplineCurveFitter and Spline as they were when the
+// reference was frozen : a natural cubic spline through the points, sampled
+// at evenly spaced x and evaluated one sample at a time.
+
+// Bounds of the spline size of SplineCurveFitter::setSplineSize()
+const int REFERENCE_MIN_SPLINE_SIZE = 10;
+const int REFERENCE_MAX_SPLINE_SIZE = 50000;
+
+// Segment of the spline that x is evaluated on
+static int referenceSplineLookup(const double x, const QPolygonF &aPoints)
+{
+    const int lSize = aPoints.size();
+    if (x <= aPoints[0].x()) {
+        return 0;
+    } else if (x >= aPoints[lSize - 2].x()) {
+        return lSize - 2;
+    }
+
+    int i1 = 0;
+    int i2 = lSize - 2;
+    while (i2 - i1 > 1) {
+        const int i3 = i1 + ((i2 - i1) >> 1);
+        if (aPoints[i3].x() > x) {
+            i2 = i3;
+        } else {
+            i1 = i3;
+        }
+    }
+    return i1;
+}
+
+// Coefficients of the natural spline through aPoints, false unless the x
+// of the points strictly ascend
+static bool referenceNaturalSpline(const QPolygonF &aPoints,
+                                   QVector<double> &aA,
+                                   QVector<double> &aB,
+                                   QVector<double> &aC)
+{
+    const QPointF *p = aPoints.data();
+    const int lSize = aPoints.size();
+    aA.resize(lSize - 1);
+    aB.resize(lSize - 1);
+    aC.resize(lSize - 1);
+
+    // set up tridiagonal equation system; use coefficient vectors as
+    // temporary buffers
+    QVector<double> h(lSize - 1);
+    for (int i = 0; i < lSize - 1; i++) {
+        h[i] = p[i + 1].x() - p[i].x();
+        if (h[i] <= 0) {
+            return false;
+        }
+    }
+
+    QVector<double> d(lSize - 1);
+    double dy1 = (p[1].y() - p[0].y()) / h[0];
+    for (int i = 1; i < lSize - 1; i++) {
+        aB[i] = aC[i] = h[i];
+        aA[i] = 2.0 * (h[i - 1] + h[i]);
+
+        const double dy2 = (p[i + 1].y() - p[i].y()) / h[i];
+        d[i] = 6.0 * (dy1 - dy2);
+        dy1 = dy2;
+    }
+
+    // L-U Factorization
+    for (int i = 1; i < lSize - 2; i++) {
+        aC[i] /= aA[i];
+        aA[i + 1] -= aB[i] * aC[i];
+    }
+
+    // forward elimination
+    QVector<double> s(lSize);
+    s[1] = d[1];
+    for (int i = 2; i < lSize - 1; i++) {
+        s[i] = d[i] - aC[i - 1] * s[i - 1];
+    }
+
+    // backward elimination
+    s[lSize - 2] = -s[lSize - 2] / aA[lSize - 2];
+    for (int i = lSize - 3; i > 0; i--) {
+        s[i] = -(s[i] + aB[i] * s[i + 1]) / aA[i];
+    }
+    s[lSize - 1] = s[0] = 0.0;
+
+    // Finally, determine the spline coefficients
+    for (int i = 0; i < lSize - 1; i++) {
+        aA[i] = (s[i + 1] - s[i]) / (6.0 * h[i]);
+        aB[i] = 0.5 * s[i];
+        aC[i] = (p[i + 1].y() - p[i].y()) / h[i] - (s[i + 1] + 2.0 * s[i]) * h[i] / 6.0;
+    }
+    return true;
+}
+
+// aSplineSize points of the spline through aPoints, aPoints themselves when
+// there is no spline through them
+static QPolygonF referenceFitSpline(const QPolygonF &aPoints, const int aSplineSize)
+{
+    QVector<double> lA, lB, lC;
+    if (aPoints.size() <= 2 || !referenceNaturalSpline(aPoints, lA, lB, lC)) {
+        return aPoints;
+    }
+
+    QPolygonF lFittedPoints(aSplineSize);
+    const double x1 = aPoints[0].x();
+    const double x2 = aPoints[int(aPoints.size() - 1)].x();
+    const double lDelta = (x2 - x1) / (aSplineSize - 1);
+    for (int k = 0; k < aSplineSize; k++) {
+        const double v = x1 + k * lDelta;
+        const int i = referenceSplineLookup(v, aPoints);
+        const double d = v - aPoints[i].x();
+        lFittedPoints[k] = QPointF(v, (((lA[i] * d) + lB[i]) * d + lC[i]) * d + aPoints[i].y());
+    }
+    return lFittedPoints;
+}
+
+ReferenceDetection::ReferenceDetection(QSharedPointer<QVector<QPointF>> &aPointsList)
+{
+    mPolyPoints = aPointsList;
+}
+
+DetectionResult ReferenceDetection::detectFeatures(QList<PolygonEdge *> &aEdgeList,
+                                                   const DetectionParameters &aParams)
+{
+    // The checks one after the other, as the "Apply" button first ran them
+    DetectionResult lResult;
+    for (auto lEdge : aEdgeList) {
+        lEdge->setFeatureID(0);
+        lEdge->setSharpEdgeID(0);
+    }
+    if (aParams.mCheckSplines) {
+        lResult.mNumSplines = splineToleranceCheck(aEdgeList,
+                                                   aParams.mSplineTolerance,
+                                                   aParams.mCheckSharpEdges,
+                                                   aParams.mSharpAngleTolerance);
+    }
+    if (aParams.mCheckArcs) {
+        lResult.mNumArcs = arcToleranceCheck(aEdgeList,
+                                             aParams.mArcTolerance,
+                                             aParams.mCheckSharpEdges,
+                                             aParams.mSharpAngleTolerance);
+    }
+    if (aParams.mCheckLines) {
+        lResult.mNumLines = lineToleranceCheck(aEdgeList,
+                                               aParams.mLineTolerance,
+                                               aParams.mCheckSharpEdges,
+                                               aParams.mSharpAngleTolerance);
+    }
+    if (aParams.mCheckSharpEdges && !aParams.mCheckLines && !aParams.mCheckArcs
+        && !aParams.mCheckSplines) {
+        lResult.mNumSharpEdges = sharpAngleToleranceCheck(aEdgeList, aParams.mSharpAngleTolerance);
+    }
+    return lResult;
+}
+
+void ReferenceDetection::createEdgeList(QList<PolygonEdge *> &aEdgeList)
+{
+    // recreate edge list
+    aEdgeList.clear();
+    QPointF lPrev, lCurrent;
+    for (int i = 1; i < mPolyPoints->count(); i++) {
+        lPrev = mPolyPoints->at(i - 1);
+        lCurrent = mPolyPoints->at(i);
+        aEdgeList.append(new PolygonEdge(lPrev, lCurrent));
+    }
+}
+
+void ReferenceDetection::getMinMax(
+    QList<PolygonEdge *> &aEdgeList, double &aMinX, double &aMinY, double &aMaxX, double &aMaxY)
+{
+    aMinX = 99999.0;
+    aMinY = 99999.0;
+    aMaxX = -99999.0;
+    aMaxY = -99999.0;
+
+    if (aEdgeList.count() > 0) {
+        for (auto lEdge : aEdgeList) {
+            double x1 = lEdge->getPoint1().x();
+            double y1 = lEdge->getPoint1().y();
+            if (x1 < aMinX) {
+                aMinX = x1;
+            }
+            if (x1 > aMaxX) {
+                aMaxX = x1;
+            }
+            if (y1 < aMinY) {
+                aMinY = y1;
+            }
+            if (y1 > aMaxY) {
+                aMaxY = y1;
+            }
+        }
+        // check endpoint of last edge.
+        double x2 = aEdgeList.at(aEdgeList.count() - 1)->getPoint2().x();
+        double y2 = aEdgeList.at(aEdgeList.count() - 1)->getPoint2().y();
+        if (x2 < aMinX) {
+            aMinX = x2;
+        }
+        if (x2 > aMaxX) {
+            aMaxX = x2;
+        }
+        if (y2 < aMinY) {
+            aMinY = y2;
+        }
+        if (y2 > aMaxY) {
+            aMaxY = y2;
+        }
+    } else {
+        aMinX = -99999.0;
+        aMinY = -99999.0;
+        aMaxX = 99999.0;
+        aMaxY = 99999.0;
+    }
+}
+
+bool ReferenceDetection::calculateArcParameters(const PolygonEdge *aCurrentEdge,
+                                                const PolygonEdge *aNextEdge,
+                                                double &aCenterX,
+                                                double &aCenterY,
+                                                double &aRadius)
+{
+    bool lArcOk = false;
+    if (aCurrentEdge != nullptr && aNextEdge != nullptr) {
+        double x1 = aCurrentEdge->getPoint1().x();
+        double y1 = aCurrentEdge->getPoint1().y();
+        double x2 = aCurrentEdge->getPoint2().x();
+        double y2 = aCurrentEdge->getPoint2().y();
+        double x3 = aNextEdge->getPoint2().x();
+        double y3 = aNextEdge->getPoint2().y();
+
+        // Calculate center and radius of arc formed by 3 previous points
+        double centerY_denom = (y1 - y2) / (x1 - x2) - (y2 - y3) / (x2 - x3);
+        double centerY_num = ((x1 * x1 + y1 * y1 - x2 * x2 - y2 * y2) / (2 * (x1 - x2)))
+                             - ((x2 * x2 + y2 * y2 - x3 * x3 - y3 * y3) / (2 * (x2 - x3)));
+        aCenterY = centerY_num / centerY_denom;
+        aCenterX = ((x1 * x1 + y1 * y1 - x2 * x2 - y2 * y2) / (2 * (x1 - x2)))
+                   - (aCenterY * (y1 - y2) / (x1 - x2));
+        aRadius = sqrt((aCenterX - x1) * (aCenterX - x1) + (aCenterY - y1) * (aCenterY - y1));
+        lArcOk = true;
+    }
+    return lArcOk;
+}
+
+void ReferenceDetection::getListOfSharpFeatures(
+    QList<PolygonEdge *> &aEdgeList,
+    const double aAngleTol,
+    QList<QSharedPointer<QList<PolygonEdge *>>> &aSharpFeaturesList)
+{
+    sharpAngleToleranceCheck(aEdgeList, aAngleTol);
+
+    if (aEdgeList.count() > 0) {
+        QSharedPointer<QList<PolygonEdge *>> lCurrentSharpEdgeList
+            = QSharedPointer<QList<PolygonEdge *>>(new QList<PolygonEdge *>());
+        lCurrentSharpEdgeList->append(aEdgeList.at(0));
+        aSharpFeaturesList.append(lCurrentSharpEdgeList);
+
+        int i = 1;
+        while (i <= aEdgeList.count() - 1) {
+            PolygonEdge *lPrevEdge = aEdgeList.at(i - 1);
+            int lSharpEdgeID = lPrevEdge->getSharpEdgeID();
+            PolygonEdge *lCurrentEdge = aEdgeList.at(i);
+            if (lCurrentEdge->getSharpEdgeID() == lSharpEdgeID) {
+                lCurrentSharpEdgeList->append(lCurrentEdge);
+            } else {
+                lCurrentSharpEdgeList = QSharedPointer<QList<PolygonEdge *>>(
+                    new QList<PolygonEdge *>());
+                lCurrentSharpEdgeList->append(lCurrentEdge);
+                aSharpFeaturesList.append(lCurrentSharpEdgeList);
+            }
+            i++;
+        }
+    }
+}
+
+int ReferenceDetection::sharpAngleToleranceCheck(QList<PolygonEdge *> &aEdgeList,
+                                                 const double aAngleTol)
+{
+    // Reset all sharp edge IDs
+    for (auto lEdge : aEdgeList) {
+        lEdge->setSharpEdgeID(DEFAULT_SHARPEDGE_ID);
+    }
+
+    int lSharpEdgeCount = DEFAULT_SHARPEDGE_ID + 1;
+    if (aEdgeList.count() >= 2) {
+        PolygonEdge *firstEdge = aEdgeList.at(0);
+        firstEdge->setSharpEdgeID(lSharpEdgeCount);
+        bool lCurrentAngleDir = false;
+        bool lPrevAngleDir = (firstEdge->getAngle() >= 0);
+
+        int i = 0;
+        while (i <= aEdgeList.count() - 2) {
+            PolygonEdge *lCurrentEdge = aEdgeList.at(i);
+            PolygonEdge *lNextEdge = aEdgeList.at(i + 1);
+            double lAngleDiff = abs(lNextEdge->getAngle() - lCurrentEdge->getAngle());
+            lCurrentAngleDir = (lAngleDiff >= 0) & (lPrevAngleDir);
+            if ((lAngleDiff <= aAngleTol)) {
+                lNextEdge->setSharpEdgeID(lSharpEdgeCount);
+            } else {
+                lSharpEdgeCount++;
+                lNextEdge->setSharpEdgeID(lSharpEdgeCount);
+            }
+            lPrevAngleDir = lCurrentAngleDir;
+            i++;
+        } // while (i <= aEdgeList.count() - 2)
+
+        // check angle between first and last edge.
+        PolygonEdge *lastEdge = aEdgeList.at(aEdgeList.count() - 1);
+        double lAngleDiff = (lastEdge->getAngle()) - (firstEdge->getAngle());
+        lCurrentAngleDir = (lAngleDiff >= 0) & (lPrevAngleDir);
+
+        if (lAngleDiff <= aAngleTol) {
+            // get all the edges tagged with same ID as first edge
+            // change the IDs of all of the above edges.
+            for (int i = 0; i <= aEdgeList.count() - 1; i++) {
+                PolygonEdge *lEdge = aEdgeList.at(i);
+                if (lEdge->getSharpEdgeID() == DEFAULT_SHARPEDGE_ID) {
+                    lEdge->setSharpEdgeID(lSharpEdgeCount);
+                } else {
+                    break;
+                }
+            }
+            i = 0;
+            lSharpEdgeCount = DEFAULT_SHARPEDGE_ID;
+            while (i <= aEdgeList.count() - 2) {
+                PolygonEdge *lCurrentEdge = aEdgeList.at(i);
+                PolygonEdge *lNextEdge = aEdgeList.at(i + 1);
+                double lAngleDiff = lNextEdge->getAngle() - lCurrentEdge->getAngle();
+                lCurrentAngleDir = (lAngleDiff >= 0) & (lPrevAngleDir);
+                if ((lAngleDiff <= aAngleTol)) {
+                    lNextEdge->setSharpEdgeID(lCurrentEdge->getSharpEdgeID());
+
+                } else {
+                    lNextEdge->setSharpEdgeID(lCurrentEdge->getSharpEdgeID() + 1);
+                    lSharpEdgeCount++;
+                }
+                lPrevAngleDir = lCurrentAngleDir;
+                i++;
+            } // while (i <= aEdgeList.count() - 2)
+        }
+    } // if (aEdgeList.count() >= 2)
+
+    return lSharpEdgeCount;
+}
+
+int ReferenceDetection::lineToleranceCheck(QList<PolygonEdge *> &aEdgeList,
+                                           const double aTolerance,
+                                           const bool aSharpAngleCheck,
+                                           const double aSharpAngleTol)
+{
+    // Poly Edges that do NOT pass the tolerance check will be marked with feature
+    // ID "0" or a special feature ID "99999" indicating ---- NOT IMPLEMENTED
+    long lFeatureID = LINE_FEATURE_ID;
+
+    QList<QSharedPointer<QList<PolygonEdge *>>> lSharpEdges;
+    if (aSharpAngleCheck) {
+        getListOfSharpFeatures(aEdgeList, aSharpAngleTol, lSharpEdges);
+    } else {
+        QSharedPointer<QList<PolygonEdge *>> lEdgeListPtr = QSharedPointer<QList<PolygonEdge *>>(
+            new QList<PolygonEdge *>());
+        for (auto lEdge : aEdgeList) {
+            lEdgeListPtr->append(lEdge);
+        }
+        lSharpEdges.append(lEdgeListPtr);
+    }
+
+    double lMinX, lMinY, lMaxX, lMaxY;
+    getMinMax(aEdgeList, lMinX, lMinY, lMaxX, lMaxY);
+    double lNormalizeFactor = std::max((lMaxY - lMinY), (lMaxX - lMinX));
+
+    for (int j = 0; j <= lSharpEdges.count() - 1; j++) {
+        QSharedPointer<QList<PolygonEdge *>> lCandidateEdgeListPtr = lSharpEdges.at(j);
+        QList<PolygonEdge *> lCandidateEdgeList = *(lCandidateEdgeListPtr.data());
+        lFeatureID++;
+
+        // Remove all edges tagged as SPLINEs
+        QList<PolygonEdge *> lCandidateLineEdges;
+        for (auto lEdge : lCandidateEdgeList) {
+            if (lEdge->getFeatureID() < ARC_FEATURE_ID) {
+                lCandidateLineEdges.append(lEdge);
+            }
+        }
+
+        if (lCandidateLineEdges.count() > 1) {
+            PolygonEdge *lFirstEdge = lCandidateLineEdges.at(0);
+            lFirstEdge->setFeatureID(lFeatureID);
+
+            for (int i = 1; i <= lCandidateLineEdges.count() - 1; i++) {
+                PolygonEdge *lCurrentEdge = lCandidateLineEdges.at(i);
+                PolygonEdge *lPrevEdge = lCandidateLineEdges.at(i - 1);
+
+                double lPrevSlope, lCurrentSlope;
+                double lPrevAngle = lPrevEdge->getAngle();
+                if (fabs(lPrevAngle - 90) <= EPSILON) {
+                    lPrevSlope = 1.0;
+                } else {
+                    lPrevSlope = tan(lPrevAngle);
+                }
+
+                double lCurrentAngle = lCurrentEdge->getAngle();
+                if (fabs(lCurrentAngle - 90) <= EPSILON) {
+                    lCurrentSlope = 1.0;
+                } else {
+                    lCurrentSlope = tan(lCurrentAngle);
+                }
+
+                double lSlopeDiff = fabs(lCurrentSlope - lPrevSlope) / lNormalizeFactor;
+                if (lSlopeDiff <= aTolerance) {
+                    lCurrentEdge->setFeatureID(lPrevEdge->getFeatureID());
+                } else {
+                    lFeatureID++;
+                    lCurrentEdge->setFeatureID(lFeatureID);
+                }
+
+            } // for i
+
+            // calculate slope between last edge and first edge
+        }
+    } // for j
+
+    return (lFeatureID - LINE_FEATURE_ID);
+}
+
+int ReferenceDetection::arcToleranceCheck(QList<PolygonEdge *> &aEdgeList,
+                                          const double aTolerance,
+                                          const bool aSharpAngleCheck,
+                                          const double aSharpAngleTol)
+{
+    // Step 1: Calculate center of curvature and radius of arc passing through
+    // non-collinear pts 1-2-3 -
+    // For non-collinearity : check FEATURE ID of edges 1-2 and 2-3, these should
+    // be different IDs (because of line tolerance check that runs before arc
+    // tolerance check)
+    // Step 2: Calculate if pt 4 lies on this arc,
+    // if YES in Step 2, mark 1-2-3-4 as ARC ID "ARC_FEATURE_ID+XXX" and keep
+    // repeating for subsequeent points if NO in step 2, then start new arc for
+    // points 2-3-4.  //
+    // Edge 1-2 will be not be tagged (will retain feature ID from line tolerance
+    // checks)
+    long lFeatureID = ARC_FEATURE_ID;
+
+    QList<QSharedPointer<QList<PolygonEdge *>>> lSharpEdges;
+    if (aSharpAngleCheck) {
+        getListOfSharpFeatures(aEdgeList, aSharpAngleTol, lSharpEdges);
+    } else {
+        QSharedPointer<QList<PolygonEdge *>> lEdgeListPtr = QSharedPointer<QList<PolygonEdge *>>(
+            new QList<PolygonEdge *>());
+        for (auto lEdge : aEdgeList) {
+            lEdgeListPtr->append(lEdge);
+        }
+        lSharpEdges.append(lEdgeListPtr);
+    }
+
+    for (int j = 0; j <= lSharpEdges.count() - 1; j++) {
+        QSharedPointer<QList<PolygonEdge *>> lCandidateEdgeListPtr = lSharpEdges.at(j);
+        QList<PolygonEdge *> lCandidateArcEdges = *(lCandidateEdgeListPtr.data());
+        long lFirstEdgeFeatID = 0;
+
+        // Get all edges that are NOT tagged as SPLINEs
+        lFeatureID++;
+        lCandidateArcEdges.at(0)->setFeatureID(0);
+
+        int lCurrentEdgeIdx = 1;
+        while (lCurrentEdgeIdx <= lCandidateArcEdges.count() - 1) {
+            double lMinX, lMinY, lMaxX, lMaxY;
+            getMinMax(lCandidateArcEdges, lMinX, lMinY, lMaxX, lMaxY);
+            double lNormalizeFactor = std::max((lMaxY - lMinY), (lMaxX - lMinX));
+
+            // Calculate center and radius of arc formed by 3 previous points
+            double lCenterX, lCenterY, lArcRad;
+            PolygonEdge *lCurrentEdge = lCandidateArcEdges.at(lCurrentEdgeIdx);
+            PolygonEdge *lPreviousEdge = lCandidateArcEdges.at(lCurrentEdgeIdx - 1);
+            lCurrentEdge->setFeatureID(lPreviousEdge->getFeatureID());
+            calculateArcParameters(lPreviousEdge, lCurrentEdge, lCenterX, lCenterY, lArcRad);
+
+            // Calculate distance of next edge end point to center of circle
+            PolygonEdge *lNextEdge;
+            if (lCurrentEdgeIdx == lCandidateArcEdges.count() - 1) {
+                lNextEdge = lCandidateArcEdges.at(0);
+            } else {
+                lNextEdge = lCandidateArcEdges.at(lCurrentEdgeIdx + 1);
+            }
+            double lDist = sqrt(pow((lNextEdge->getPoint2().y() - lCenterY), 2)
+                                + pow(lNextEdge->getPoint2().x() - lCenterX, 2));
+            if ((fabs(lDist - lArcRad) / lNormalizeFactor) <= aTolerance) {
+                // tag this Edge (and previous & next edge) with arc feature ID
+                lPreviousEdge->setFeatureID(lFeatureID);
+                lCurrentEdge->setFeatureID(lFeatureID);
+                lNextEdge->setFeatureID(lFeatureID);
+            } else {
+                // edge is connected to previous, but has a different radius from
+                // previous arc
+                // calculate new ARC parameters.
+                // lPreviousEdge->setFeatureID(0);
+                lCurrentEdge->setFeatureID(0);
+                // lNextEdge->setFeatureID(0);
+                calculateArcParameters(lCurrentEdge, lNextEdge, lCenterX, lCenterY, lArcRad);
+                lFeatureID++;
+            }
+
+            lCurrentEdgeIdx++;
+        } // while (i <= lCandidateArcEdges.count() - 2)
+
+    } // for j
+
+    return (lFeatureID - ARC_FEATURE_ID);
+}
+
+int ReferenceDetection::splineToleranceCheck(QList<PolygonEdge *> &aEdgeList,
+                                             const double aTolerance,
+                                             const bool aSharpAngleCheck,
+                                             const double aSharpAngleTol)
+{
+    // Find candidates for splines : edges with feature IDs < (ARC_FEATURE_ID)??
+    // Step 1 : check if the complete list of points can be
+    // approximated by 1 spline
+    // Step 2: If yes, mark all edges with a unique
+    // feature id for spline (SPLINE_FEATURE_ID).
+    // Step 3 : If no, find the first
+    // point with spline error, break the list at this point, and recalculate
+    // spline for remaining points in list. ALl entities upto the error point are
+    // tagged with new feature ID (SPLINE_FEATURE_ID+XXX)
+    // Step 4 : Repeat step 3
+    // until all points with spline errors have been removed OR approximated with
+    // new splines
+    long lFeatureID = SPLINE_FEATURE_ID;
+    QList<QSharedPointer<QList<PolygonEdge *>>> lSharpEdges;
+    if (aSharpAngleCheck) {
+        getListOfSharpFeatures(aEdgeList, aSharpAngleTol, lSharpEdges);
+    } else {
+        QSharedPointer<QList<PolygonEdge *>> lEdgeListPtr = QSharedPointer<QList<PolygonEdge *>>(
+            new QList<PolygonEdge *>());
+        for (auto lEdge : aEdgeList) {
+            lEdgeListPtr->append(lEdge);
+        }
+        lSharpEdges.append(lEdgeListPtr);
+    }
+
+    for (int k = 0; k <= lSharpEdges.count() - 1; k++) {
+        QSharedPointer<QList<PolygonEdge *>> lCandidateEdgeListPtr = lSharpEdges.at(k);
+        QList<PolygonEdge *> lCandidateEdgeList = *(lCandidateEdgeListPtr.data());
+
+        lFeatureID++;
+        if (lCandidateEdgeList.count() >= 3) {
+            QVector<QPointF> lInputPoints;
+            // append first point
+            lInputPoints << lCandidateEdgeList.at(0)->getPoint1();
+            int j;
+            for (j = 0; j < lCandidateEdgeList.count() - 1; j++) {
+                PolygonEdge *lCurrEdge = lCandidateEdgeList.at(j);
+                PolygonEdge *lNextEdge = lCandidateEdgeList.at(j + 1);
+                lInputPoints << lNextEdge->getPoint1();
+            }
+            // append last point - why is this required?
+            lInputPoints << lCandidateEdgeList.at(lCandidateEdgeList.count() - 1)->getPoint2();
+
+            // recursively calculate splines
+            double lMinX, lMinY, lMaxX, lMaxY;
+            getMinMax(lCandidateEdgeList, lMinX, lMinY, lMaxX, lMaxY);
+            double lNormalizeFactor = std::max((lMaxY - lMinY), (lMaxX - lMinX));
+            // double lSplineTolerance = aTolerance/lNormalizeFactor;
+            calcSplineApprox_recursive(lInputPoints, lCandidateEdgeList, aTolerance);
+
+            // At this point all the spline candidates have been identified, and
+            // spline error set for each edge. Set a unique feature ID, starting
+            // with SPLINE_FEATURE_ID+1 for every new set of points that constitute
+            // a spline if spline approximation fails, feature ID stays unchanged.
+            PolygonEdge *lPrevEdge = lCandidateEdgeList.at(0);
+            lPrevEdge->setFeatureID(lFeatureID);
+
+            int i = 1;
+            while (i <= lCandidateEdgeList.count() - 1) {
+                lPrevEdge = lCandidateEdgeList.at(i - 1);
+                PolygonEdge *lCurrEdge = lCandidateEdgeList.at(i);
+                if (lPrevEdge->isSplineCandidate(aTolerance)
+                    && lCurrEdge->isSplineCandidate(aTolerance)) {
+                    lCurrEdge->setFeatureID(lPrevEdge->getFeatureID());
+                } else if (!lPrevEdge->isSplineCandidate(aTolerance)
+                           && lCurrEdge->isSplineCandidate(aTolerance)) {
+                    lFeatureID++;
+                    lCurrEdge->setFeatureID(lFeatureID);
+                } else if (!lCurrEdge->isSplineCandidate(aTolerance)) {
+                    lCurrEdge->setFeatureID(0);
+                }
+                i++;
+            } // while (i <= lCandidateEdgeList.count()-1)
+
+        } // if (lCandidateEdgeList.count() >= 3)
+
+    } // for (int k = 0; k <= lSharpEdges.count()-1; k++)
+
+    return (lFeatureID - SPLINE_FEATURE_ID);
+}
+
+void ReferenceDetection::calcSplineApprox_recursive(QVector<QPointF> &aInputPts,
+                                                    QList<PolygonEdge *> &aEdgeCandidateList,
+                                                    const double aTolerance)
+{
+    QVector<QPointF> lSplinePoints;
+    calcSpline(aInputPts, lSplinePoints);
+
+    aInputPts.clear();
+    aInputPts << lSplinePoints; // create new input polygon
+    // Tag edges as spline candidates if they qualify for spline approximation
+    identifySplineErrors(lSplinePoints, aEdgeCandidateList, aTolerance);
+    // remove any edges with spline errors > tolerance and
+    // formulate new list of points that are spline candidates
+    bool lEdgeListModified = removeEdgeswithSplineErrors(aEdgeCandidateList, aInputPts, aTolerance);
+    if (lEdgeListModified && aEdgeCandidateList.count() >= 3) {
+        calcSplineApprox_recursive(aInputPts, aEdgeCandidateList, aTolerance);
+    }
+}
+
+void ReferenceDetection::calcSpline(QVector<QPointF> &aInputPts, QVector<QPointF> &aSplineCurvePts)
+{
+    // aSplineCurvePts is an output parameter, will be recreated every time
+    QPolygonF lInputPoly(aInputPts);
+    QPolygonF lSplineCurve = referenceFitSpline(lInputPoly,
+                                                qBound(REFERENCE_MIN_SPLINE_SIZE,
+                                                       100 * mPolyPoints->count(),
+                                                       REFERENCE_MAX_SPLINE_SIZE));
+
+    aSplineCurvePts.clear();
+    aSplineCurvePts << lSplineCurve;
+}
+
+bool ReferenceDetection::removeEdgeswithSplineErrors(QList<PolygonEdge *> &aEdgeList,
+                                                     QVector<QPointF> &aCandidatePts,
+                                                     const double aTolerance)
+{
+    bool aEdgeListModified = false;
+    // find index of first non-spline entity.
+    int lSplineStartIndex = -1;
+    for (int j = 0; j < aEdgeList.count(); j++) {
+        PolygonEdge *lEdge = aEdgeList.at(j);
+        if (j >= 3 && lEdge->getSplineError() > aTolerance) {
+            lSplineStartIndex = j;
+            break;
+        }
+    }
+    if (lSplineStartIndex >= 3) {
+        // remove all entities upto lSplineStartIndex
+        int k = 0;
+        while (k >= lSplineStartIndex && aEdgeList.count() >= 3) {
+            aEdgeList.removeAt(0);
+            aEdgeListModified = true;
+            k++;
+        }
+    }
+    // populate new list of points based on removed edges : aCandidatePts
+    aCandidatePts.clear(); // aCandidatePts is OUTPUT list
+    for (int j = 0; j < aEdgeList.count(); j++) {
+        PolygonEdge *lEdge = aEdgeList.at(j);
+        aCandidatePts << lEdge->getPoint1();
+        if (j == aEdgeList.count() - 1) {
+            aCandidatePts << lEdge->getPoint2();
+        }
+    }
+
+    return aEdgeListModified;
+}
+
+void ReferenceDetection::identifySplineErrors(QVector<QPointF> &aSplineCurvePts,
+                                              QList<PolygonEdge *> &aEdgeList,
+                                              const double aTolerance)
+{
+    for (int j = 0; j < aEdgeList.count(); j++) {
+        PolygonEdge *lEdge = aEdgeList.at(j);
+        double lDistToSpline = 99999;
+
+        for (int k = 0; k <= aSplineCurvePts.count() - 1; k++) {
+            QPointF lSplinePt = aSplineCurvePts.at(k);
+            // calculate error/distance of spline point from lEdge
+            QPointF p1 = lEdge->getPoint1();
+            QPointF p2 = lEdge->getPoint2();
+            QPointF lMidPoint((p1.x() + p2.x()) / 2, (p1.y() + p2.y()) / 2);
+
+            qreal lDist1 = sqrt(pow(lSplinePt.x() - p1.x(), 2) + pow(lSplinePt.y() - p1.y(), 2));
+            qreal lDist2 = sqrt(pow(lSplinePt.x() - p2.x(), 2) + pow(lSplinePt.y() - p2.y(), 2));
+            qreal lDist3 = sqrt(pow(lSplinePt.x() - lMidPoint.x(), 2)
+                                + pow(lSplinePt.y() - lMidPoint.y(), 2));
+
+            qreal leastSqrError = sqrt(lDist1 * lDist1 + lDist2 * lDist2 + lDist3 * lDist3);
+            if (leastSqrError < lDistToSpline) {
+                lDistToSpline = leastSqrError;
+            }
+        } // for k
+
+        aEdgeList.at(j)->setSplineError(lDistToSpline);
+    } // for j
+}
@@ -0,0 +1,79 @@
+#ifndef REFERENCEDETECTION_H
+#define REFERENCEDETECTION_H
+
+#include "detectiontypes.h"
+#include "polygonedge.h"
+#include <QList>
+#include <QPolygonF>
+#include <QSharedPointer>
+#include <QVector>
+
+// Frozen copy of the original serial PolyFeatureDetection checks, the
+// reference the differential test (tools/difftest) holds every optimized
+// engine to. Do not optimize or fix it : a change here moves the reference,
+// only PolyFeatureDetection changes. It shares only PolygonEdge with the
+// engines : the spline fit (SplineCurveFitter and Spline) is copied in too.
+class ReferenceDetection
+{
+public:
+    ReferenceDetection(QSharedPointer<QVector<QPointF>> &aPointsList);
+
+    // Runs the enabled checks one after the other : splines, arcs, then lines.
+    // CascadeDetection has no reference, mMode is ignored.
+    DetectionResult detectFeatures(QList<PolygonEdge *> &aEdgeList,
+                                   const DetectionParameters &aParams);
+
+    void createEdgeList(QList<PolygonEdge *> &aEdgeList);
+
+    void getMinMax(QList<PolygonEdge *> &aEdgeList,
+                   double &aMinX,
+                   double &aMinY,
+                   double &aMaxX,
+                   double &aMaxY);
+
+    int sharpAngleToleranceCheck(QList<PolygonEdge *> &aEdgeList, const double aAngleTol);
+
+    int lineToleranceCheck(QList<PolygonEdge *> &aEdgeList,
+                           const double aTolerance,
+                           const bool aSharpAngleCheck,
+                           const double aSharpAngleTol);
+
+    int arcToleranceCheck(QList<PolygonEdge *> &aEdgeList,
+                          const double aTolerance,
+                          const bool aSharpAngleCheck,
+                          const double aSharpAngleTol);
+
+    int splineToleranceCheck(QList<PolygonEdge *> &aEdgeList,
+                             const double aTolerance,
+                             const bool aSharpAngleCheck,
+                             const double aSharpAngleTol);
+
+    void getListOfSharpFeatures(QList<PolygonEdge *> &aEdgeList,
+                                const double aAngleTol,
+                                QList<QSharedPointer<QList<PolygonEdge *>>> &aSharpFeatures);
+
+private:
+    bool calculateArcParameters(const PolygonEdge *aCurrentEdge,
+                                const PolygonEdge *aNextEdge,
+                                double &aCenterX,
+                                double &aCenterY,
+                                double &aRadius);
+
+    void calcSplineApprox_recursive(QVector<QPointF> &aInputPts,
+                                    QList<PolygonEdge *> &aEdgeCandidateList,
+                                    const double aTolerance);
+
+    void calcSpline(QVector<QPointF> &aInputPts, QVector<QPointF> &aSplineCurvePts);
+
+    void identifySplineErrors(QVector<QPointF> &aSplineCurvePts,
+                              QList<PolygonEdge *> &aEdgeList,
+                              const double aTolerance);
+
+    bool removeEdgeswithSplineErrors(QList<PolygonEdge *> &aEdgeList,
+                                     QVector<QPointF> &aCandidatePts,
+                                     const double aTolerance);
+
+    QSharedPointer<QVector<QPointF>> mPolyPoints;
+};
+
+#endif // REFERENCEDETECTION_H
@@ -0,0 +1,54 @@
+#include "rendertilecache.h"
+
+RenderTileCache::RenderTileCache(const qint64 aMaxBytes)
+    : mMaxBytes(aMaxBytes)
+    , mBytes(0)
+{}
+
+QImage RenderTileCache::tile(const RenderTileKey &aKey) const
+{
+    auto lTile = mTiles.find(aKey);
+    return (lTile != mTiles.end()) ? lTile->second : QImage();
+}
+
+void RenderTileCache::insert(const RenderTileKey &aKey, const QImage &aTile)
+{
+    auto lOld = mTiles.find(aKey);
+    if (lOld != mTiles.end()) {
+        mBytes -= lOld->second.sizeInBytes();
+        lOld->second = aTile;
+        mBytes += aTile.sizeInBytes();
+        return;
+    }
+
+    while (!mInsertOrder.isEmpty() && mBytes + aTile.sizeInBytes() > mMaxBytes) {
+        auto lOldest = mTiles.find(mInsertOrder.dequeue());
+        mBytes -= lOldest->second.sizeInBytes();
+        mTiles.erase(lOldest);
+    }
+    mTiles.emplace(aKey, aTile);
+    mInsertOrder.enqueue(aKey);
+    mBytes += aTile.sizeInBytes();
+}
+
+void RenderTileCache::removeOlderThan(const quint64 aLabelVersion)
+{
+    QQueue<RenderTileKey> lInsertOrder;
+    for (const RenderTileKey &lKey : mInsertOrder) {
+        if (lKey.mLabelVersion >= aLabelVersion) {
+            lInsertOrder.enqueue(lKey);
+        } else {
+            auto lTile = mTiles.find(lKey);
+            mBytes -= lTile->second.sizeInBytes();
+            mTiles.erase(lTile);
+        }
+    }
+    mInsertOrder.swap(lInsertOrder);
+}
+
+void RenderTileCache::clear()
+{
+    mTiles.clear();
+    mInsertOrder.clear();
+    mBytes = 0;
+}
@@ -0,0 +1,91 @@
+#ifndef RENDERTILECACHE_H
+#define RENDERTILECACHE_H
+
+#include "hashcombine.h"
+#include <QImage>
+#include <QQueue>
+#include <unordered_map>
+
+const int RENDER_TILE_SIZE = 256;                 // device pixels per side of a tile
+const qint64 DEFAULT_TILE_CACHE_SIZE = 64 << 20; // bytes of tiles kept
+
+// Key of a tile : zoom (device pixels per item unit), fraction of a device
+// pixel the item origin is past the whole pixel the tiles start on, tile
+// column and row counted in tiles from that pixel, and the label version it
+// shows
+class RenderTileKey
+{
+public:
+    RenderTileKey(const double aZoom,
+                  const double aPhaseX,
+                  const double aPhaseY,
+                  const int aX,
+                  const int aY,
+                  const quint64 aLabelVersion)
+        : mZoom(aZoom)
+        , mPhaseX(aPhaseX)
+        , mPhaseY(aPhaseY)
+        , mX(aX)
+        , mY(aY)
+        , mLabelVersion(aLabelVersion)
+    {}
+
+    bool operator==(const RenderTileKey &aOther) const
+    {
+        return mZoom == aOther.mZoom && mPhaseX == aOther.mPhaseX && mPhaseY == aOther.mPhaseY
+               && mX == aOther.mX && mY == aOther.mY && mLabelVersion == aOther.mLabelVersion;
+    }
+
+    double mZoom;
+    double mPhaseX, mPhaseY;
+    int mX, mY;
+    quint64 mLabelVersion;
+};
+
+namespace std {
+
+template<>
+struct hash<RenderTileKey>
+{
+    size_t operator()(const RenderTileKey &k) const
+    {
+        size_t seed = 0;
+        hash_combine(seed, k.mZoom);
+        hash_combine(seed, k.mPhaseX);
+        hash_combine(seed, k.mPhaseY);
+        hash_combine(seed, k.mX);
+        hash_combine(seed, k.mY);
+        hash_combine(seed, k.mLabelVersion);
+        return seed;
+    }
+};
+
+} // namespace std
+
+// Rendered tiles of a graphics item, so that panning and going back to an
+// earlier zoom draw images instead of the polygon. The oldest tiles are
+// dropped once the tiles take more than the cache size. Used from the GUI
+// thread only; tiles are rendered elsewhere and inserted from there.
+class RenderTileCache
+{
+public:
+    explicit RenderTileCache(const qint64 aMaxBytes = DEFAULT_TILE_CACHE_SIZE);
+
+    // Tile stored under aKey, a null image on a miss
+    QImage tile(const RenderTileKey &aKey) const;
+    void insert(const RenderTileKey &aKey, const QImage &aTile);
+    // Drops the tiles of label versions before aLabelVersion
+    void removeOlderThan(const quint64 aLabelVersion);
+    void clear();
+
+    int count() const { return int(mTiles.size()); }
+    qint64 byteSize() const { return mBytes; }
+
+private:
+    const qint64 mMaxBytes;
+    std::unordered_map<RenderTileKey, QImage> mTiles;
+    QQueue<RenderTileKey> mInsertOrder;
+    qint64 mBytes;
+};
+
+#endif // RENDERTILECACHE_H
@@ -0,0 +1,244 @@
+#include "tolerancesweep.h"
+#include "detectiontrace.h"
+#include "polyfeaturedetection.h"
+#include "polygonfileio.h"
+#include <algorithm>
+#include <math.h>
+#include <QDataStream>
+#include <QtConcurrent>
+
+QVector<double> SweepParameters::logSpaced(const double aMin, const double aMax, const int aCount)
+{
+    QVector<double> lValues;
+    if (aCount == 1) {
+        lValues.append(aMin);
+    } else if (aCount > 1 && aMin > 0.0 && aMax > 0.0) {
+        double lStep = log(aMax / aMin) / (aCount - 1);
+        for (int i = 0; i < aCount; i++) {
+            lValues.append(aMin * exp(lStep * i));
+        }
+    }
+    return lValues;
+}
+
+ToleranceSweep::ToleranceSweep()
+    : mDiskCache(nullptr)
+{}
+
+// Payload of a SweepRecord : the per-layer counts and fit error of one point
+static QByteArray writeSweepPoint(const SweepPoint &aPoint)
+{
+    QByteArray lPayload;
+    QDataStream lStream(&lPayload, QIODevice::WriteOnly);
+    lStream << qint32(aPoint.mNumFeatures) << qint32(aPoint.mNumSegments) << aPoint.mFitError;
+    return lPayload;
+}
+
+static bool readSweepPoint(const QByteArray &aPayload, SweepPoint &aPoint)
+{
+    QDataStream lStream(aPayload);
+    qint32 lNumFeatures = 0, lNumSegments = 0;
+    double lFitError = 0.0;
+    lStream >> lNumFeatures >> lNumSegments >> lFitError;
+    if (lStream.status() != QDataStream::Ok) {
+        return false;
+    }
+    aPoint.mNumFeatures = lNumFeatures;
+    aPoint.mNumSegments = lNumSegments;
+    aPoint.mFitError = lFitError;
+    return true;
+}
+
+void ToleranceSweep::addLayer(const QVector<QPointF> &aPoints)
+{
+    QVector<QPointF> lPoints = aPoints;
+    closePolygon(lPoints);
+    mLayers.append(lPoints);
+}
+
+QVector<DetectionParameters> ToleranceSweep::parameterGrid(const SweepParameters &aParams) const
+{
+    const DetectionParameters &lBase = aParams.mBaseParams;
+    auto lValues = [](const bool aEnabled, const QVector<double> &aList, const double aDefault) {
+        return (aEnabled && !aList.isEmpty()) ? aList : QVector<double>(1, aDefault);
+    };
+    QVector<double> lSharp = lValues(lBase.mCheckSharpEdges,
+                                     aParams.mSharpAngleTolerances,
+                                     lBase.mSharpAngleTolerance);
+    QVector<double> lSpline = lValues(lBase.mCheckSplines,
+                                      aParams.mSplineTolerances,
+                                      lBase.mSplineTolerance);
+    QVector<double> lArc = lValues(lBase.mCheckArcs, aParams.mArcTolerances, lBase.mArcTolerance);
+    QVector<double> lLine = lValues(lBase.mCheckLines,
+                                    aParams.mLineTolerances,
+                                    lBase.mLineTolerance);
+
+    // Sharp-angle grouping and spline fits invalidate the cached metrics, keep
+    // them in the outer loops so line and arc changes are plain relabelling.
+    QVector<DetectionParameters> lGrid;
+    for (double lSharpTol : lSharp) {
+        for (double lSplineTol : lSpline) {
+            for (double lArcTol : lArc) {
+                for (double lLineTol : lLine) {
+                    DetectionParameters lParams = lBase;
+                    lParams.mSharpAngleTolerance = lSharpTol;
+                    lParams.mSplineTolerance = lSplineTol;
+                    lParams.mArcTolerance = lArcTol;
+                    lParams.mLineTolerance = lLineTol;
+                    lGrid.append(lParams);
+                }
+            }
+        }
+    }
+    return lGrid;
+}
+
+void ToleranceSweep::uniqueLayers(QVector<int> &aLayers, QVector<int> &aMultiplicity) const
+{
+    // Layers that repeat an earlier one, possibly from another start vertex,
+    // are evaluated once and counted with their multiplicity.
+    FeatureResultCache lContent;
+    QVector<QList<PolygonEdge *>> lEdgeLists(mLayers.count());
+    QHash<quint64, QVector<int>> lLayersByHash;
+    aLayers.clear();
+    aMultiplicity.clear();
+
+    for (int j = 0; j < mLayers.count(); j++) {
+        QSharedPointer<QVector<QPointF>> lPoints(new QVector<QPointF>(mLayers.at(j)));
+        PolyFeatureDetection lDetection(lPoints);
+        lDetection.createEdgeList(lEdgeLists[j]);
+
+        QVector<int> &lCandidates = lLayersByHash[lContent.contentHash(lEdgeLists.at(j))];
+        int lUniqueIdx = -1;
+        for (int k : lCandidates) {
+            if (lContent.sameContent(lEdgeLists.at(aLayers.at(k)), lEdgeLists.at(j))) {
+                lUniqueIdx = k;
+                break;
+            }
+        }
+        if (lUniqueIdx < 0) {
+            lCandidates.append(aLayers.count());
+            aLayers.append(j);
+            aMultiplicity.append(1);
+        } else {
+            aMultiplicity[lUniqueIdx]++;
+        }
+    }
+
+    for (auto &lEdgeList : lEdgeLists) {
+        qDeleteAll(lEdgeList);
+    }
+}
+
+QVector<SweepPoint> ToleranceSweep::run(const SweepParameters &aParams) const
+{
+    DETECTION_TRACE_SCOPE("sweep", "run");
+    const QVector<DetectionParameters> lGrid = parameterGrid(aParams);
+
+    QVector<int> lLayers, lMultiplicity;
+    {
+        DETECTION_TRACE_SCOPE("sweep", "uniqueLayers");
+        uniqueLayers(lLayers, lMultiplicity);
+    }
+    const int lLayerCount = lLayers.count();
+
+    QVector<QVector<SweepPoint>> lLayerPoints(lLayerCount);
+    QVector<int> lLayerIndices(lLayerCount);
+    for (int j = 0; j < lLayerCount; j++) {
+        lLayerIndices[j] = j;
+    }
+
+    QtConcurrent::blockingMap(lLayerIndices, [&](const int &j) {
+        DETECTION_TRACE_SCOPE_ARG("task", "layer", "layer", lLayers.at(j));
+        QSharedPointer<QVector<QPointF>> lPoints(new QVector<QPointF>(mLayers.at(lLayers.at(j))));
+        PolyFeatureDetection lDetection(lPoints);
+        // layers already run concurrently, only split a lone layer by groups
+        lDetection.setParallelGroupProcessing(lLayerCount == 1);
+        lDetection.setMetricsCaching(true);
+
+        QList<PolygonEdge *> lEdgeList;
+        lDetection.createEdgeList(lEdgeList);
+        const quint64 lContentHash = (mDiskCache != nullptr)
+                                         ? FeatureResultCache(0).contentHash(lEdgeList)
+                                         : 0;
+
+        QVector<SweepPoint> &lPointsOut = lLayerPoints[j];
+        lPointsOut.resize(lGrid.count());
+        for (int k = 0; k < lGrid.count(); k++) {
+            DETECTION_TRACE_SCOPE_ARG("sweep", "point", "point", k);
+            SweepPoint &lPoint = lPointsOut[k];
+            DiskRecordKey lKey(lContentHash,
+                               FeatureResultCache::parameterHash(lGrid.at(k)),
+                               SweepRecord);
+            QByteArray lPayload;
+            if (mDiskCache != nullptr && mDiskCache->find(lKey, lPayload)
+                && readSweepPoint(lPayload, lPoint)) {
+                continue;
+            }
+
+            DetectionResult lResult = lDetection.detectFeatures(lEdgeList, lGrid.at(k));
+            int lUnlabelled = 0;
+            for (auto lEdge : lEdgeList) {
+                if (lEdge->getFeatureID() <= LINE_FEATURE_ID) {
+                    lUnlabelled++;
+                }
+            }
+
+            lPoint.mNumFeatures = lResult.mNumLines + lResult.mNumArcs + lResult.mNumSplines;
+            lPoint.mNumSegments = lPoint.mNumFeatures + lUnlabelled;
+            lPoint.mFitError = lDetection.featureFitError(lEdgeList);
+            if (mDiskCache != nullptr) {
+                mDiskCache->append(lKey, writeSweepPoint(lPoint));
+            }
+        }
+
+        qDeleteAll(lEdgeList);
+    });
+
+    QVector<SweepPoint> lSweep(lGrid.count());
+    for (int k = 0; k < lGrid.count(); k++) {
+        SweepPoint &lPoint = lSweep[k];
+        lPoint.mParams = lGrid.at(k);
+        for (int j = 0; j < lLayerCount; j++) {
+            const SweepPoint &lLayerPoint = lLayerPoints.at(j).at(k);
+            const int lCount = lMultiplicity.at(j);
+            lPoint.mNumFeatures += lCount * lLayerPoint.mNumFeatures;
+            lPoint.mNumSegments += lCount * lLayerPoint.mNumSegments;
+            lPoint.mFitError += lCount * lLayerPoint.mFitError;
+        }
+        if (!mLayers.isEmpty()) {
+            lPoint.mFitError /= mLayers.count();
+        }
+    }
+
+    markFrontier(lSweep);
+    return lSweep;
+}
+
+void ToleranceSweep::markFrontier(QVector<SweepPoint> &aPoints)
+{
+    // Pareto frontier of segment count against fit error : visit the points by
+    // increasing segment count, a point is on the frontier when its error is
+    // lower than that of every point with fewer (or as many) segments before it.
+    QVector<int> lOrder(aPoints.count());
+    for (int k = 0; k < aPoints.count(); k++) {
+        lOrder[k] = k;
+        aPoints[k].mOnFrontier = false;
+    }
+    std::stable_sort(lOrder.begin(), lOrder.end(), [&](const int a, const int b) {
+        if (aPoints.at(a).mNumSegments != aPoints.at(b).mNumSegments) {
+            return aPoints.at(a).mNumSegments < aPoints.at(b).mNumSegments;
+        }
+        return aPoints.at(a).mFitError < aPoints.at(b).mFitError;
+    });
+
+    bool lFirst = true;
+    double lBestError = 0.0;
+    for (int k : lOrder) {
+        if (lFirst || aPoints.at(k).mFitError < lBestError) {
+            aPoints[k].mOnFrontier = true;
+            lBestError = aPoints.at(k).mFitError;
+            lFirst = false;
+        }
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef TOLERANCESWEEP_H
+#define TOLERANCESWEEP_H
+
+#include "detectiontypes.h"
+#include "diskresultcache.h"
+#include <QPointF>
+#include <QVector>
+
+// Tolerance values tried by ToleranceSweep::run(), every combination of them is
+// evaluated. An empty list keeps the tolerance of mBaseParams, and so does the
+// list of a check that is not enabled in mBaseParams.
+class SweepParameters
+{
+public:
+    SweepParameters() {}
+
+    // aCount values spaced geometrically from aMin to aMax
+    static QVector<double> logSpaced(const double aMin, const double aMax, const int aCount);
+
+    DetectionParameters mBaseParams;
+    QVector<double> mLineTolerances, mArcTolerances, mSplineTolerances, mSharpAngleTolerances;
+};
+
+// One parameter point of a sweep, summed over all layers
+class SweepPoint
+{
+public:
+    SweepPoint()
+        : mNumFeatures(0)
+        , mNumSegments(0)
+        , mFitError(0.0)
+        , mOnFrontier(false)
+    {}
+
+    DetectionParameters mParams;
+    int mNumFeatures; // lines, arcs and splines
+    int mNumSegments; // features, plus edges that are not part of any feature
+    double mFitError; // mean of PolyFeatureDetection::featureFitError() over the layers
+    bool mOnFrontier; // no other point has fewer segments and a lower fit error
+};
+
+// Evaluates a grid of tolerances over a set of polygon layers. Layers are
+// processed concurrently; each layer keeps its detection metrics across the
+// whole grid, so only the spline fit and sharp-angle grouping are ever redone.
+// Repeated layers (see FeatureResultCache::sameContent()) are evaluated once.
+// With a DiskResultCache, the result of every layer at every parameter point
+// is stored, and read back instead of being evaluated by later runs.
+class ToleranceSweep
+{
+public:
+    ToleranceSweep();
+
+    // aPoints as read from a layer file, the polygon is closed here
+    void addLayer(const QVector<QPointF> &aPoints);
+    int layerCount() const { return mLayers.count(); }
+
+    // aDiskCache is not owned, nullptr to evaluate every point
+    void setDiskCache(DiskResultCache *aDiskCache) { mDiskCache = aDiskCache; }
+
+    QVector<SweepPoint> run(const SweepParameters &aParams) const;
+
+    static void markFrontier(QVector<SweepPoint> &aPoints);
+
+private:
+    QVector<DetectionParameters> parameterGrid(const SweepParameters &aParams) const;
+    void uniqueLayers(QVector<int> &aLayers, QVector<int> &aMultiplicity) const;
+
+    QVector<QVector<QPointF>> mLayers;
+    DiskResultCache *mDiskCache;
+};
+
+#endif // TOLERANCESWEEP_H
@@ -0,0 +1,82 @@
+#include "allocationcounter.h"
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+
+static std::atomic<quint64> gAllocationCount(0);
+
+static inline void countAllocation()
+{
+    gAllocationCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+quint64 allocationCount()
+{
+    return gAllocationCount.load(std::memory_order_relaxed);
+}
+
+#if defined(__GLIBC__)
+
+// Interpose the malloc family, forwarding to the glibc implementation
+extern "C" {
+void *__libc_malloc(size_t aSize);
+void *__libc_calloc(size_t aCount, size_t aSize);
+void *__libc_realloc(void *aPointer, size_t aSize);
+
+void *malloc(size_t aSize) __THROW
+{
+    countAllocation();
+    return __libc_malloc(aSize);
+}
+
+void *calloc(size_t aCount, size_t aSize) __THROW
+{
+    countAllocation();
+    return __libc_calloc(aCount, aSize);
+}
+
+void *realloc(void *aPointer, size_t aSize) __THROW
+{
+    countAllocation();
+    return __libc_realloc(aPointer, aSize);
+}
+}
+
+bool allocationCountIncludesMalloc()
+{
+    return true;
+}
+
+#else
+
+void *operator new(std::size_t aSize)
+{
+    countAllocation();
+    void *lPointer = malloc(aSize > 0 ? aSize : 1);
+    if (lPointer == nullptr) {
+        throw std::bad_alloc();
+    }
+    return lPointer;
+}
+
+void *operator new[](std::size_t aSize)
+{
+    return operator new(aSize);
+}
+
+void operator delete(void *aPointer) noexcept
+{
+    free(aPointer);
+}
+
+void operator delete[](void *aPointer) noexcept
+{
+    free(aPointer);
+}
+
+bool allocationCountIncludesMalloc()
+{
+    return false;
+}
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <QtGlobal>
+
+// Number of heap allocations made by the process so far. With glibc every call
+// of the malloc family is counted; elsewhere only operator new is, which misses
+// the Qt containers (they allocate with malloc).
+quint64 allocationCount();
+bool allocationCountIncludesMalloc();
+
+#endif // ALLOCATIONCOUNTER_H
@@ -0,0 +1,23 @@
+#-------------------------------------------------
+#
+# Per-stage detection timings over data/ and synthetic polygons, as JSON
+#
+#-------------------------------------------------
+
+QT       += core gui concurrent
+
+TARGET = polybench
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include(../../polyfeaturecore.pri)
+
+SOURCES += \
+        allocationcounter.cpp \
+        main.cpp
+
+HEADERS += \
+        allocationcounter.h
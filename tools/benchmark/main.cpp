@@ -0,0 +1,362 @@
+#include "CurveFitter.h"
+#include "Spline.h"
+#include "allocationcounter.h"
+#include "featureruns.h"
+#include "geometrykernels.h"
+#include "polyfeaturedetection.h"
+#include "polygonfileio.h"
+#include <algorithm>
+#include <math.h>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <QTextStream>
+#include <QThread>
+
+// How often, and up to which size, every stage is run
+class BenchmarkOptions
+{
+public:
+    BenchmarkOptions()
+        : mRepeat(7)
+        , mMaxSeconds(5.0)
+        , mSplineMaxVertices(20000)
+    {}
+
+    int mRepeat;            // runs per stage and input
+    double mMaxSeconds;     // no new run is started past this much time in a stage
+    int mSplineMaxVertices; // spline stages are skipped on larger inputs
+};
+
+// Run times and allocations of one stage over one input
+class StageTiming
+{
+public:
+    StageTiming()
+        : mSkipped(false)
+    {}
+
+    QString mStage;
+    bool mSkipped;
+    QVector<qint64> mNanoseconds;
+    QVector<qint64> mAllocations;
+};
+
+// Nearest-rank percentile of aValues, aFraction in [0, 1]
+static qint64 percentile(QVector<qint64> aValues, const double aFraction)
+{
+    if (aValues.isEmpty()) {
+        return 0;
+    }
+    std::sort(aValues.begin(), aValues.end());
+    int lRank = int(ceil(aFraction * aValues.count()));
+    return aValues.at(qBound(1, lRank, aValues.count()) - 1);
+}
+
+// Closed test polygon of aVertexCount points : a rounded square (long, nearly
+// straight sides and tight corners) with a ripple on its upper half, so that
+// every check has lines, arcs and curves to label.
+static QVector<QPointF> syntheticPolygon(const int aVertexCount)
+{
+    QVector<QPointF> lPoints;
+    lPoints.reserve(aVertexCount + 1);
+    for (int i = 0; i < aVertexCount; i++) {
+        double lAngle = 2.0 * M_PI * i / aVertexCount;
+        double lCos = cos(lAngle);
+        double lSin = sin(lAngle);
+        // superellipse |x|^4 + |y|^4 = 1
+        double lRadius = 50.0 / pow(pow(fabs(lCos), 4.0) + pow(fabs(lSin), 4.0), 0.25);
+        if (lSin > 0.0) {
+            lRadius *= 1.0 + 0.02 * sin(24.0 * lAngle);
+        }
+        lPoints.append(QPointF(lRadius * lCos, lRadius * lSin));
+    }
+    return lPoints;
+}
+
+// Runs aStage up to aOptions.mRepeat times, aSetup (not timed) before each run
+template<typename Setup, typename Stage>
+static StageTiming timeStage(const QString &aName,
+                             const BenchmarkOptions &aOptions,
+                             Setup aSetup,
+                             Stage aStage)
+{
+    StageTiming lTiming;
+    lTiming.mStage = aName;
+    qint64 lTotal = 0;
+    QElapsedTimer lTimer;
+    for (int lRun = 0; lRun < aOptions.mRepeat; lRun++) {
+        if (lTotal > qint64(aOptions.mMaxSeconds * 1E9)) {
+            break;
+        }
+        aSetup();
+        quint64 lAllocations = allocationCount();
+        lTimer.start();
+        aStage();
+        qint64 lElapsed = lTimer.nsecsElapsed();
+        lTiming.mAllocations.append(qint64(allocationCount() - lAllocations));
+        lTiming.mNanoseconds.append(lElapsed);
+        lTotal += lElapsed;
+    }
+    return lTiming;
+}
+
+static StageTiming skippedStage(const QString &aName)
+{
+    StageTiming lTiming;
+    lTiming.mStage = aName;
+    lTiming.mSkipped = true;
+    return lTiming;
+}
+
+// Every stage over one polygon, aPoints as read from a layer file
+static QVector<StageTiming> benchmarkPolygon(const QVector<QPointF> &aPoints,
+                                             const BenchmarkOptions &aOptions,
+                                             const bool aParallelGroups)
+{
+    QSharedPointer<QVector<QPointF>> lPoints(new QVector<QPointF>(aPoints));
+    closePolygon(*lPoints);
+    PolyFeatureDetection lDetection(lPoints);
+    lDetection.setParallelGroupProcessing(aParallelGroups);
+    const bool lSplines = aPoints.count() <= aOptions.mSplineMaxVertices;
+
+    QList<PolygonEdge *> lEdgeList;
+    auto lNoSetup = []() {};
+    auto lFreshEdges = [&]() {
+        qDeleteAll(lEdgeList);
+        lDetection.createEdgeList(lEdgeList);
+    };
+    auto lNoEdges = [&]() {
+        qDeleteAll(lEdgeList);
+        lEdgeList.clear();
+    };
+
+    QVector<StageTiming> lTimings;
+    lTimings << timeStage("createEdgeList", aOptions, lNoEdges, [&]() {
+        lDetection.createEdgeList(lEdgeList);
+    });
+    lTimings << timeStage("sharpAngleToleranceCheck", aOptions, lFreshEdges, [&]() {
+        lDetection.sharpAngleToleranceCheck(lEdgeList, DEFAULT_SHARP_ANGLE_TOL);
+    });
+    lTimings << timeStage("lineToleranceCheck", aOptions, lFreshEdges, [&]() {
+        lDetection.lineToleranceCheck(lEdgeList, DEFAULT_LINE_TOL, true, DEFAULT_SHARP_ANGLE_TOL);
+    });
+    lTimings << timeStage("arcToleranceCheck", aOptions, lFreshEdges, [&]() {
+        lDetection.arcToleranceCheck(lEdgeList, DEFAULT_ARC_TOL, true, DEFAULT_SHARP_ANGLE_TOL);
+    });
+    if (lSplines) {
+        lTimings << timeStage("splineToleranceCheck", aOptions, lFreshEdges, [&]() {
+            lDetection.splineToleranceCheck(lEdgeList,
+                                            DEFAULT_SPLINE_TOL,
+                                            true,
+                                            DEFAULT_SHARP_ANGLE_TOL);
+        });
+    } else {
+        lTimings << skippedStage("splineToleranceCheck");
+    }
+
+    // Spline needs strictly increasing x, which a closed polygon never has :
+    // the spline kernels run over the y profile of the points instead.
+    // buildNaturalSpline() is protected, Spline::setPoints() is only a copy of
+    // the points on top of it.
+    QPolygonF lPolygon;
+    lPolygon.reserve(lPoints->count());
+    for (int i = 0; i < lPoints->count(); i++) {
+        lPolygon.append(QPointF(i, lPoints->at(i).y()));
+    }
+    Spline lSpline;
+    lTimings << timeStage("Spline::buildNaturalSpline", aOptions, lNoSetup, [&]() {
+        lSpline.setPoints(lPolygon);
+    });
+
+    // with the spline size used by the spline check
+    if (lSplines) {
+        SplineCurveFitter lFitter;
+        lFitter.setSplineSize(100 * lPoints->count());
+        lTimings << timeStage("SplineCurveFitter::fitCurve", aOptions, lNoSetup, [&]() {
+            lFitter.fitCurve(lPolygon);
+        });
+    } else {
+        lTimings << skippedStage("SplineCurveFitter::fitCurve");
+    }
+
+    DetectionParameters lParams;
+    lParams.mCheckLines = true;
+    lParams.mCheckArcs = true;
+    lParams.mCheckSplines = lSplines;
+    lParams.mCheckSharpEdges = true;
+    lTimings << timeStage(lSplines ? "detectFeatures" : "detectFeatures (no splines)",
+                          aOptions,
+                          lFreshEdges,
+                          [&]() { lDetection.detectFeatures(lEdgeList, lParams); });
+
+    // the checks without splines once more in float (DetectionParameters::mPrecision)
+    lParams.mCheckSplines = false;
+    if (lSplines) {
+        lTimings << timeStage("detectFeatures (no splines)", aOptions, lFreshEdges, [&]() {
+            lDetection.detectFeatures(lEdgeList, lParams);
+        });
+    }
+    lParams.mPrecision = SinglePrecision;
+    lTimings << timeStage("detectFeatures (float, no splines)", aOptions, lFreshEdges, [&]() {
+        lDetection.detectFeatures(lEdgeList, lParams);
+    });
+
+    // the runs of the labels left by the last stage
+    lTimings << timeStage("FeatureRunList::fromEdges", aOptions, lNoSetup, [&]() {
+        FeatureRunList::fromEdges(lEdgeList);
+    });
+
+    qDeleteAll(lEdgeList);
+    return lTimings;
+}
+
+static QJsonObject timingToJson(const QString &aInput,
+                                const int aVertexCount,
+                                const StageTiming &aTiming)
+{
+    QJsonObject lObject;
+    lObject["input"] = aInput;
+    lObject["vertices"] = aVertexCount;
+    lObject["stage"] = aTiming.mStage;
+    lObject["skipped"] = aTiming.mSkipped;
+    if (aTiming.mSkipped) {
+        return lObject;
+    }
+    const qint64 lMedian = percentile(aTiming.mNanoseconds, 0.5);
+    lObject["runs"] = aTiming.mNanoseconds.count();
+    lObject["median_ns"] = lMedian;
+    lObject["p90_ns"] = percentile(aTiming.mNanoseconds, 0.9);
+    lObject["p99_ns"] = percentile(aTiming.mNanoseconds, 0.99);
+    lObject["min_ns"] = percentile(aTiming.mNanoseconds, 0.0);
+    lObject["max_ns"] = percentile(aTiming.mNanoseconds, 1.0);
+    lObject["vertices_per_second"] = (lMedian > 0) ? (aVertexCount * 1E9 / lMedian) : 0.0;
+    lObject["allocations"] = percentile(aTiming.mAllocations, 0.5);
+    return lObject;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication lApp(argc, argv);
+    QCoreApplication::setApplicationName("polybench");
+
+    QCommandLineParser lParser;
+    lParser.setApplicationDescription(
+        "Times every detection stage over polygon layer files and synthetic polygons, and "
+        "writes median and percentile times, throughput and allocation counts as JSON.");
+    lParser.addHelpOption();
+    lParser.addPositionalArgument("layers",
+                                  "Polygon layer files, every .txt and .pfb file of --data if "
+                                  "none.");
+
+    QCommandLineOption lDataOption("data", "Directory of layer files.", "dir", "data");
+    QCommandLineOption lSizesOption("sizes",
+                                    "Vertex counts of the synthetic polygons, 0 for none.",
+                                    "list",
+                                    "1000,10000,100000,1000000");
+    QCommandLineOption lRepeatOption("repeat", "Runs per stage.", "count", "7");
+    QCommandLineOption lMaxSecondsOption("max-seconds",
+                                         "Stop repeating a stage after this many seconds.",
+                                         "seconds",
+                                         "5");
+    QCommandLineOption lSplineMaxOption("spline-max-vertices",
+                                        "Skip the spline stages above this many vertices "
+                                        "(the fit samples 100 points per vertex).",
+                                        "count",
+                                        "20000");
+    QCommandLineOption lSerialOption("serial", "Do not label sharp-angle groups concurrently.");
+    QCommandLineOption lOutputOption("output", "Write the JSON report to this file.", "file");
+    lParser.addOption(lDataOption);
+    lParser.addOption(lSizesOption);
+    lParser.addOption(lRepeatOption);
+    lParser.addOption(lMaxSecondsOption);
+    lParser.addOption(lSplineMaxOption);
+    lParser.addOption(lSerialOption);
+    lParser.addOption(lOutputOption);
+    lParser.process(lApp);
+
+    QTextStream lErr(stderr);
+
+    BenchmarkOptions lOptions;
+    bool lRepeatOk, lMaxSecondsOk, lSplineMaxOk;
+    lOptions.mRepeat = lParser.value(lRepeatOption).toInt(&lRepeatOk);
+    lOptions.mMaxSeconds = lParser.value(lMaxSecondsOption).toDouble(&lMaxSecondsOk);
+    lOptions.mSplineMaxVertices = lParser.value(lSplineMaxOption).toInt(&lSplineMaxOk);
+    QVector<int> lSizes;
+    bool lSizesOk = true;
+    for (const QString &lSize : lParser.value(lSizesOption).split(QString(","))) {
+        bool lSizeOk;
+        int lCount = lSize.toInt(&lSizeOk);
+        lSizesOk = lSizesOk && lSizeOk;
+        if (lCount >= 3) {
+            lSizes.append(lCount);
+        }
+    }
+    if (!lRepeatOk || lOptions.mRepeat < 1 || !lMaxSecondsOk || !lSplineMaxOk || !lSizesOk) {
+        lErr << "Invalid option value\n";
+        return 1;
+    }
+
+    QStringList lFiles = lParser.positionalArguments();
+    if (lFiles.isEmpty()) {
+        QDir lDataDir(lParser.value(lDataOption));
+        for (const QString &lName : lDataDir.entryList(QStringList() << "*.txt" << "*.pfb",
+                                                       QDir::Files,
+                                                       QDir::Name)) {
+            lFiles.append(lDataDir.filePath(lName));
+        }
+    }
+
+    const bool lParallelGroups = !lParser.isSet(lSerialOption);
+    QJsonArray lResults;
+    auto lRun = [&](const QString &aInput, const QVector<QPointF> &aPoints) {
+        lErr << aInput << " (" << aPoints.count() << " vertices)\n";
+        lErr.flush();
+        for (const StageTiming &lTiming : benchmarkPolygon(aPoints, lOptions, lParallelGroups)) {
+            lResults.append(timingToJson(aInput, aPoints.count(), lTiming));
+        }
+    };
+
+    for (const QString &lFilePath : lFiles) {
+        QVector<QPointF> lPoints;
+        if (!readPolygonFile(lFilePath, lPoints)) {
+            lErr << "Cannot read " << lFilePath << "\n";
+            return 1;
+        }
+        lRun(QFileInfo(lFilePath).fileName(), lPoints);
+    }
+    for (int lSize : lSizes) {
+        lRun(QString("synthetic_%1").arg(lSize), syntheticPolygon(lSize));
+    }
+
+    QJsonObject lReport;
+    lReport["tool"] = QString("polybench");
+    lReport["algorithm_version"] = int(DETECTION_ALGORITHM_VERSION);
+    lReport["qt_version"] = QString(qVersion());
+    lReport["threads"] = QThread::idealThreadCount();
+    lReport["geometry_kernels"] = QString(GeometryKernels::isaName(GeometryKernels::isa()));
+    lReport["parallel_groups"] = lParallelGroups;
+    lReport["allocations_include_malloc"] = allocationCountIncludesMalloc();
+    lReport["repeat"] = lOptions.mRepeat;
+    lReport["results"] = lResults;
+    QByteArray lJson = QJsonDocument(lReport).toJson(QJsonDocument::Indented);
+
+    if (lParser.isSet(lOutputOption)) {
+        QFile lOutput(lParser.value(lOutputOption));
+        if (!lOutput.open(QIODevice::WriteOnly | QIODevice::Truncate)
+            || lOutput.write(lJson) != lJson.size()) {
+            lErr << "Cannot write " << lParser.value(lOutputOption) << "\n";
+            return 1;
+        }
+    } else {
+        QTextStream(stdout) << lJson;
+    }
+    return 0;
+}
@@ -0,0 +1,24 @@
+#-------------------------------------------------
+#
+# Differential test of the detection engines against the frozen reference
+#
+#-------------------------------------------------
+
+QT       += core gui concurrent
+
+TARGET = polydifftest
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include(../../polyfeaturecore.pri)
+
+# the reference is only built into the test
+SOURCES += \
+        ../../referencedetection.cpp \
+        main.cpp
+
+HEADERS += \
+        ../../referencedetection.h
@@ -0,0 +1,641 @@
+#include "featurediff.h"
+#include "geometrykernels.h"
+#include "polyfeaturedetection.h"
+#include "polygonfileio.h"
+#include "polygongenerator.h"
+#include "referencedetection.h"
+#include "Spline.h"
+#include <algorithm>
+#include <functional>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QTextStream>
+
+// Vertices of the --large layers : the spline size stops growing at 500
+const int LARGE_LAYER_VERTICES = 1500;
+
+// One test polygon, closed
+class DiffLayer
+{
+public:
+    QString mName;
+    QSharedPointer<QVector<QPointF>> mPoints;
+};
+
+// Labels every parameter set on a layer, in order, each on edges of its own.
+// Engines that keep state between runs (cached metrics, result cache, layer
+// history) get to use it, that is what they are tested for.
+class DiffEngine
+{
+public:
+    DiffEngine()
+        : mApproximate(false)
+    {}
+
+    QString mName;
+    QString mDescription;
+    // Not meant to give the reference labels : its differences are counted as
+    // an accuracy report, not listed, and don't fail the run
+    bool mApproximate;
+    std::function<void(DiffLayer &aLayer,
+                       const QVector<DetectionParameters> &aParams,
+                       QVector<EdgeLabels> &aLabels)>
+        mRun;
+};
+
+// Appends the loops of a generated layer, closed
+static void appendGenerated(const GeneratorParameters &aParams,
+                            const QString &aName,
+                            QVector<DiffLayer> &aLayers)
+{
+    PolygonLayer lGenerated = PolygonGenerator(aParams).generate();
+    for (int l = 0; l < lGenerated.mLoops.count(); l++) {
+        DiffLayer lLayer;
+        lLayer.mName = QString("%1 loop %2").arg(aName).arg(l);
+        lLayer.mPoints.reset(new QVector<QPointF>(lGenerated.mLoops.at(l)));
+        closePolygon(*lLayer.mPoints);
+        aLayers.append(lLayer);
+    }
+}
+
+static EdgeLabels detectOnce(PolyFeatureDetection &aDetection, const DetectionParameters &aParams)
+{
+    QList<PolygonEdge *> lEdgeList;
+    aDetection.createEdgeList(lEdgeList);
+    aDetection.detectFeatures(lEdgeList, aParams);
+    EdgeLabels lLabels = EdgeLabels::fromEdges(lEdgeList);
+    qDeleteAll(lEdgeList);
+    return lLabels;
+}
+
+static QVector<DiffEngine> diffEngines()
+{
+    QVector<DiffEngine> lEngines;
+    DiffEngine lEngine;
+
+    lEngine.mName = "serial";
+    lEngine.mDescription = "detectFeatures(), groups one after the other";
+    lEngine.mRun = [](DiffLayer &aLayer,
+                      const QVector<DetectionParameters> &aParams,
+                      QVector<EdgeLabels> &aLabels) {
+        for (const DetectionParameters &lParams : aParams) {
+            PolyFeatureDetection lDetection(aLayer.mPoints);
+            lDetection.setParallelGroupProcessing(false);
+            aLabels.append(detectOnce(lDetection, lParams));
+        }
+    };
+    lEngines.append(lEngine);
+
+    lEngine.mName = "parallel";
+    lEngine.mDescription = "detectFeatures(), groups labelled concurrently";
+    lEngine.mRun = [](DiffLayer &aLayer,
+                      const QVector<DetectionParameters> &aParams,
+                      QVector<EdgeLabels> &aLabels) {
+        for (const DetectionParameters &lParams : aParams) {
+            PolyFeatureDetection lDetection(aLayer.mPoints);
+            aLabels.append(detectOnce(lDetection, lParams));
+        }
+    };
+    lEngines.append(lEngine);
+
+    lEngine.mName = "checks";
+    lEngine.mDescription = "the individual tolerance checks, splines, arcs then lines";
+    lEngine.mRun = [](DiffLayer &aLayer,
+                      const QVector<DetectionParameters> &aParams,
+                      QVector<EdgeLabels> &aLabels) {
+        for (const DetectionParameters &lParams : aParams) {
+            PolyFeatureDetection lDetection(aLayer.mPoints);
+            QList<PolygonEdge *> lEdgeList;
+            lDetection.createEdgeList(lEdgeList);
+            const bool lSharp = lParams.mCheckSharpEdges;
+            const double lAngleTol = lParams.mSharpAngleTolerance;
+            if (lParams.mCheckSplines) {
+                lDetection.splineToleranceCheck(lEdgeList,
+                                                lParams.mSplineTolerance,
+                                                lSharp,
+                                                lAngleTol);
+            }
+            if (lParams.mCheckArcs) {
+                lDetection.arcToleranceCheck(lEdgeList, lParams.mArcTolerance, lSharp, lAngleTol);
+            }
+            if (lParams.mCheckLines) {
+                lDetection.lineToleranceCheck(lEdgeList, lParams.mLineTolerance, lSharp, lAngleTol);
+            }
+            if (lSharp && !lParams.mCheckLines && !lParams.mCheckArcs && !lParams.mCheckSplines) {
+                lDetection.sharpAngleToleranceCheck(lEdgeList, lAngleTol);
+            }
+            aLabels.append(EdgeLabels::fromEdges(lEdgeList));
+            qDeleteAll(lEdgeList);
+        }
+    };
+    lEngines.append(lEngine);
+
+    lEngine.mName = "metrics";
+    lEngine.mDescription = "one detector per layer with cached metrics, relabelled for every set";
+    lEngine.mRun = [](DiffLayer &aLayer,
+                      const QVector<DetectionParameters> &aParams,
+                      QVector<EdgeLabels> &aLabels) {
+        PolyFeatureDetection lDetection(aLayer.mPoints);
+        lDetection.setMetricsCaching(true);
+        QList<PolygonEdge *> lEdgeList;
+        lDetection.createEdgeList(lEdgeList);
+        for (const DetectionParameters &lParams : aParams) {
+            lDetection.detectFeatures(lEdgeList, lParams);
+            aLabels.append(EdgeLabels::fromEdges(lEdgeList));
+        }
+        qDeleteAll(lEdgeList);
+    };
+    lEngines.append(lEngine);
+
+    lEngine.mName = "result-cache";
+    lEngine.mDescription = "every set run twice through a FeatureResultCache, the second a hit";
+    lEngine.mRun = [](DiffLayer &aLayer,
+                      const QVector<DetectionParameters> &aParams,
+                      QVector<EdgeLabels> &aLabels) {
+        FeatureResultCache lCache;
+        for (const DetectionParameters &lParams : aParams) {
+            PolyFeatureDetection lDetection(aLayer.mPoints);
+            lDetection.setResultCache(&lCache);
+            detectOnce(lDetection, lParams);
+            aLabels.append(detectOnce(lDetection, lParams));
+        }
+    };
+    lEngines.append(lEngine);
+
+    lEngine.mName = "result-cache-rotated";
+    lEngine.mDescription = "every set run through a FeatureResultCache, then a hit on the same "
+                           "layer from another start vertex, rotated back";
+    lEngine.mRun = [](DiffLayer &aLayer,
+                      const QVector<DetectionParameters> &aParams,
+                      QVector<EdgeLabels> &aLabels) {
+        // the loop started a third of the way round, closed again
+        const QVector<QPointF> &lPoints = *aLayer.mPoints;
+        const int lCount = lPoints.count() - 1;
+        const int lOffset = lCount / 3;
+        QSharedPointer<QVector<QPointF>> lRotated(new QVector<QPointF>());
+        for (int i = 0; i <= lCount; i++) {
+            lRotated->append(lPoints.at((i + lOffset) % lCount));
+        }
+        FeatureResultCache lCache;
+        for (const DetectionParameters &lParams : aParams) {
+            PolyFeatureDetection lDetection(aLayer.mPoints);
+            lDetection.setResultCache(&lCache);
+            detectOnce(lDetection, lParams);
+            PolyFeatureDetection lRotatedDetection(lRotated);
+            lRotatedDetection.setResultCache(&lCache);
+            const EdgeLabels lHit = detectOnce(lRotatedDetection, lParams);
+
+            // rotated edge i is edge i + lOffset of the layer
+            EdgeLabels lLabels = lHit;
+            for (int i = 0; i < lHit.count(); i++) {
+                const int lEdge = (i + lOffset) % lHit.count();
+                lLabels.mFeatureIDs[lEdge] = lHit.mFeatureIDs.at(i);
+                lLabels.mSharpEdgeIDs[lEdge] = lHit.mSharpEdgeIDs.at(i);
+                lLabels.mSplineErrors[lEdge] = lHit.mSplineErrors.at(i);
+            }
+            aLabels.append(lLabels);
+        }
+    };
+    lEngines.append(lEngine);
+
+    lEngine.mName = "incremental";
+    lEngine.mDescription = "every set run twice with incremental detection, the second reusing "
+                           "every group";
+    lEngine.mRun = [](DiffLayer &aLayer,
+                      const QVector<DetectionParameters> &aParams,
+                      QVector<EdgeLabels> &aLabels) {
+        PolyFeatureDetection lDetection(aLayer.mPoints);
+        lDetection.setIncrementalDetection(true);
+        for (const DetectionParameters &lParams : aParams) {
+            detectOnce(lDetection, lParams);
+            aLabels.append(detectOnce(lDetection, lParams));
+        }
+    };
+    lEngines.append(lEngine);
+
+    lEngine.mName = "incremental-moved";
+    lEngine.mDescription = "incremental detection after the layer with vertices moved by less "
+                           "than the hash quantum";
+    lEngine.mRun = [](DiffLayer &aLayer,
+                      const QVector<DetectionParameters> &aParams,
+                      QVector<EdgeLabels> &aLabels) {
+        QVector<QPointF> lMoved = *aLayer.mPoints;
+        for (int i = 3; i < lMoved.count() - 1; i += 7) {
+            lMoved[i].rx() += 0.4 * DEFAULT_HASH_QUANTUM;
+        }
+        QSharedPointer<QVector<QPointF>> lPoints(new QVector<QPointF>());
+        PolyFeatureDetection lDetection(lPoints);
+        lDetection.setIncrementalDetection(true);
+        for (const DetectionParameters &lParams : aParams) {
+            *lPoints = lMoved;
+            detectOnce(lDetection, lParams);
+            *lPoints = *aLayer.mPoints;
+            aLabels.append(detectOnce(lDetection, lParams));
+        }
+    };
+    lEngines.append(lEngine);
+
+    lEngine.mName = "incremental-inserted";
+    lEngine.mDescription = "incremental detection after the layer with one more vertex, the "
+                           "other groups unchanged";
+    lEngine.mRun = [](DiffLayer &aLayer,
+                      const QVector<DetectionParameters> &aParams,
+                      QVector<EdgeLabels> &aLabels) {
+        // the middle of an edge, which only changes the group holding it and
+        // the spline size
+        QVector<QPointF> lInserted = *aLayer.mPoints;
+        const int lEdge = lInserted.count() / 2;
+        lInserted.insert(lEdge + 1, (lInserted.at(lEdge) + lInserted.at(lEdge + 1)) / 2.0);
+        QSharedPointer<QVector<QPointF>> lPoints(new QVector<QPointF>());
+        PolyFeatureDetection lDetection(lPoints);
+        lDetection.setIncrementalDetection(true);
+        for (const DetectionParameters &lParams : aParams) {
+            *lPoints = lInserted;
+            detectOnce(lDetection, lParams);
+            *lPoints = *aLayer.mPoints;
+            aLabels.append(detectOnce(lDetection, lParams));
+        }
+    };
+    lEngines.append(lEngine);
+
+    // Also fits the arcs through a vertical edge, which the reference misses
+    lEngine.mName = "fixed-point";
+    lEngine.mDescription = "detectFeatures() with the edge geometry in micrometres";
+    lEngine.mApproximate = true;
+    lEngine.mRun = [](DiffLayer &aLayer,
+                      const QVector<DetectionParameters> &aParams,
+                      QVector<EdgeLabels> &aLabels) {
+        for (DetectionParameters lParams : aParams) {
+            lParams.mCoordinates = FixedPointCoordinates;
+            PolyFeatureDetection lDetection(aLayer.mPoints);
+            aLabels.append(detectOnce(lDetection, lParams));
+        }
+    };
+    lEngines.append(lEngine);
+    lEngine.mApproximate = false;
+
+    // The serial engine once more with each instruction set this CPU has
+    for (int i = 0; i < NumKernelIsas; i++) {
+        const KernelIsa lIsa = KernelIsa(i);
+        if (!GeometryKernels::isSupported(lIsa)) {
+            continue;
+        }
+        lEngine.mName = QString("kernels-") + GeometryKernels::isaName(lIsa);
+        lEngine.mDescription = QString("detectFeatures() with the ")
+                               + GeometryKernels::isaName(lIsa) + " geometry kernels";
+        lEngine.mRun = [lIsa](DiffLayer &aLayer,
+                              const QVector<DetectionParameters> &aParams,
+                              QVector<EdgeLabels> &aLabels) {
+            const KernelIsa lDefaultIsa = GeometryKernels::isa();
+            GeometryKernels::setIsa(lIsa);
+            for (const DetectionParameters &lParams : aParams) {
+                PolyFeatureDetection lDetection(aLayer.mPoints);
+                lDetection.setParallelGroupProcessing(false);
+                aLabels.append(detectOnce(lDetection, lParams));
+            }
+            GeometryKernels::setIsa(lDefaultIsa);
+        };
+        lEngines.append(lEngine);
+    }
+
+    lEngine.mName = "float";
+    lEngine.mDescription = "detectFeatures() with the sharp angle, line and arc checks in float";
+    lEngine.mApproximate = true;
+    lEngine.mRun = [](DiffLayer &aLayer,
+                      const QVector<DetectionParameters> &aParams,
+                      QVector<EdgeLabels> &aLabels) {
+        for (DetectionParameters lParams : aParams) {
+            lParams.mPrecision = SinglePrecision;
+            PolyFeatureDetection lDetection(aLayer.mPoints);
+            aLabels.append(detectOnce(lDetection, lParams));
+        }
+    };
+    lEngines.append(lEngine);
+
+    return lEngines;
+}
+
+// Spline::values() against value() over random splines, with the arguments
+// ascending, descending and in no order (some outside the spline), and with
+// each instruction set this CPU has. Returns the arguments that differ.
+static int checkSplineValues(QTextStream &aOut)
+{
+    QRandomGenerator lRandom(1);
+    int lNumDiffering = 0;
+    for (int s = 0; s < 200; s++) {
+        // x of the points ascending, except in every tenth spline
+        QPolygonF lPoints;
+        double x = lRandom.generateDouble();
+        for (int i = 3 + s % 20; i > 0; i--) {
+            lPoints << QPointF(x, lRandom.generateDouble());
+            x += (s % 10 == 9) ? lRandom.generateDouble() - 0.5 : 0.01 + lRandom.generateDouble();
+        }
+        Spline lSpline;
+        lSpline.setPoints(lPoints);
+
+        QVector<double> lArgs(500);
+        for (double &lArg : lArgs) {
+            lArg = lPoints.first().x() - 1.0
+                   + (x - lPoints.first().x() + 2.0) * lRandom.generateDouble();
+        }
+        for (int lOrder = 0; lOrder < 3; lOrder++) {
+            if (lOrder == 0) {
+                std::sort(lArgs.begin(), lArgs.end());
+            } else if (lOrder == 1) {
+                std::reverse(lArgs.begin(), lArgs.end());
+            } else {
+                std::shuffle(lArgs.begin(), lArgs.end(), lRandom);
+            }
+            const KernelIsa lDefaultIsa = GeometryKernels::isa();
+            for (int i = 0; i < NumKernelIsas; i++) {
+                if (!GeometryKernels::setIsa(KernelIsa(i))) {
+                    continue;
+                }
+                QVector<double> lValues(lArgs.count());
+                lSpline.values(lArgs.constData(), lValues.data(), lArgs.count());
+                for (int k = 0; k < lArgs.count(); k++) {
+                    if (lValues.at(k) != lSpline.value(lArgs.at(k))) {
+                        if (lNumDiffering++ < 5) {
+                            aOut << "Spline::values() | " << GeometryKernels::isaName(KernelIsa(i))
+                                 << " | spline " << s << " : " << lValues.at(k) << " at "
+                                 << lArgs.at(k) << ", value() " << lSpline.value(lArgs.at(k))
+                                 << "\n";
+                        }
+                    }
+                }
+            }
+            GeometryKernels::setIsa(lDefaultIsa);
+        }
+    }
+    return lNumDiffering;
+}
+
+// Every combination of checks, at the default tolerances times each scale
+static QVector<DetectionParameters> parameterSets(const QVector<double> &aScales)
+{
+    QVector<DetectionParameters> lSets;
+    for (double lScale : aScales) {
+        for (int lChecks = 1; lChecks < 16; lChecks++) {
+            DetectionParameters lParams;
+            lParams.mCheckSplines = (lChecks & 1) != 0;
+            lParams.mCheckArcs = (lChecks & 2) != 0;
+            lParams.mCheckLines = (lChecks & 4) != 0;
+            lParams.mCheckSharpEdges = (lChecks & 8) != 0;
+            lParams.mLineTolerance *= lScale;
+            lParams.mArcTolerance *= lScale;
+            lParams.mSplineTolerance *= lScale;
+            lParams.mSharpAngleTolerance *= lScale;
+            lSets.append(lParams);
+        }
+    }
+    return lSets;
+}
+
+static QString describeParameters(const DetectionParameters &aParams, const double aScale)
+{
+    QStringList lChecks;
+    if (aParams.mCheckSplines) {
+        lChecks << "splines";
+    }
+    if (aParams.mCheckArcs) {
+        lChecks << "arcs";
+    }
+    if (aParams.mCheckLines) {
+        lChecks << "lines";
+    }
+    if (aParams.mCheckSharpEdges) {
+        lChecks << "sharp";
+    }
+    return lChecks.join(",") + QString(" x%1").arg(aScale);
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication lApp(argc, argv);
+    QCoreApplication::setApplicationName("polydifftest");
+
+    QCommandLineParser lParser;
+    lParser.setApplicationDescription(
+        "Runs the frozen reference detection (ReferenceDetection) next to every detection "
+        "engine over polygon layer files and generated layers, and reports the feature runs "
+        "that differ. Exits with 1 on any difference, except in the approximate engines (fixed-point, "
+        "float), "
+        "which are only counted.");
+    lParser.addHelpOption();
+    lParser.addPositionalArgument("layers", "Polygon layer files, text or binary.");
+
+    QCommandLineOption lGenerateOption("generate",
+                                       "Also test the loops of this many generated layers.",
+                                       "n",
+                                       "0");
+    QCommandLineOption lVerticesOption("vertices", "Vertices per generated layer.", "n", "300");
+    QCommandLineOption lLargeOption("large",
+                                    QString("Also test this many generated layers of %1 "
+                                            "vertices in one loop.")
+                                        .arg(LARGE_LAYER_VERTICES),
+                                    "n",
+                                    "2");
+    QCommandLineOption lScalesOption("scales",
+                                     "Tolerance scales, every check combination is run with "
+                                     "the default tolerances times each.",
+                                     "list",
+                                     "0.5,1,2");
+    QCommandLineOption lEnginesOption("engines", "Engines to test, all by default.", "list");
+    QCommandLineOption lBoundaryOption("boundary-edges",
+                                       "Feature ends may move by this many edges.",
+                                       "n",
+                                       "0");
+    QCommandLineOption lSplineErrorOption("spline-error",
+                                          "Largest spline error difference.",
+                                          "value",
+                                          "1e-9");
+    QCommandLineOption lMaxReportOption("max-report",
+                                        "Differing runs printed per layer and parameter set.",
+                                        "n",
+                                        "5");
+    QCommandLineOption lListOption("list", "List the engines and exit.");
+    lParser.addOption(lGenerateOption);
+    lParser.addOption(lVerticesOption);
+    lParser.addOption(lLargeOption);
+    lParser.addOption(lScalesOption);
+    lParser.addOption(lEnginesOption);
+    lParser.addOption(lBoundaryOption);
+    lParser.addOption(lSplineErrorOption);
+    lParser.addOption(lMaxReportOption);
+    lParser.addOption(lListOption);
+    lParser.process(lApp);
+
+    QTextStream lOut(stdout);
+    QTextStream lErr(stderr);
+
+    QVector<DiffEngine> lEngines = diffEngines();
+    if (lParser.isSet(lListOption)) {
+        for (const DiffEngine &lEngine : lEngines) {
+            lOut << lEngine.mName << "\t" << lEngine.mDescription << "\n";
+        }
+        return 0;
+    }
+    if (lParser.isSet(lEnginesOption)) {
+        QStringList lNames = lParser.value(lEnginesOption).split(QString(","));
+        QVector<DiffEngine> lSelected;
+        for (const QString &lName : lNames) {
+            bool lFound = false;
+            for (const DiffEngine &lEngine : lEngines) {
+                if (lEngine.mName == lName) {
+                    lSelected.append(lEngine);
+                    lFound = true;
+                }
+            }
+            if (!lFound) {
+                lErr << "Unknown engine " << lName << "\n";
+                return 1;
+            }
+        }
+        lEngines = lSelected;
+    }
+
+    bool lOk[6];
+    const int lGenerate = lParser.value(lGenerateOption).toInt(&lOk[0]);
+    const int lVertices = lParser.value(lVerticesOption).toInt(&lOk[1]);
+    const int lLarge = lParser.value(lLargeOption).toInt(&lOk[5]);
+    FeatureDiffTolerance lTolerance;
+    lTolerance.mBoundaryEdges = lParser.value(lBoundaryOption).toInt(&lOk[2]);
+    lTolerance.mSplineError = lParser.value(lSplineErrorOption).toDouble(&lOk[3]);
+    const int lMaxReport = lParser.value(lMaxReportOption).toInt(&lOk[4]);
+    QVector<double> lScales;
+    bool lAllOk = true;
+    for (const QString &lScale : lParser.value(lScalesOption).split(QString(","))) {
+        bool lScaleOk;
+        lScales.append(lScale.toDouble(&lScaleOk));
+        lAllOk = lAllOk && lScaleOk && lScales.last() > 0.0;
+    }
+    for (bool lValueOk : lOk) {
+        lAllOk = lAllOk && lValueOk;
+    }
+    if (!lAllOk || lGenerate < 0 || lVertices < 1 || lLarge < 0) {
+        lErr << "Invalid option value\n";
+        return 1;
+    }
+
+    QVector<DiffLayer> lLayers;
+    for (const QString &lFilePath : lParser.positionalArguments()) {
+        DiffLayer lLayer;
+        lLayer.mName = QFileInfo(lFilePath).fileName();
+        lLayer.mPoints.reset(new QVector<QPointF>());
+        if (!readPolygonFile(lFilePath, *lLayer.mPoints)) {
+            lErr << "Cannot read " << lFilePath << "\n";
+            return 1;
+        }
+        if (lLayer.mPoints->count() < 3) {
+            lErr << "Skipping " << lFilePath << ", not a polygon\n";
+            continue;
+        }
+        closePolygon(*lLayer.mPoints);
+        lLayers.append(lLayer);
+    }
+    for (int g = 1; g <= lGenerate; g++) {
+        // every other layer with scan noise and corners of tiny edges
+        GeneratorParameters lParams;
+        lParams.mSeed = quint32(g);
+        lParams.mVertexCount = lVertices;
+        lParams.mFeatureVertices = 24;
+        lParams.mHoleCount = g % 3;
+        if (g % 2 == 0) {
+            lParams.mNoise = 0.01;
+            lParams.mTinyEdgeCorners = 0.3;
+            lParams.mTinyEdgeCount = 6;
+        }
+        appendGenerated(lParams, QString("generated %1").arg(g), lLayers);
+    }
+    for (int g = 1; g <= lLarge; g++) {
+        // above 500 vertices the spline size is MAX_SPLINE_SIZE
+        GeneratorParameters lParams;
+        lParams.mSeed = quint32(1000 + g);
+        lParams.mVertexCount = LARGE_LAYER_VERTICES;
+        lParams.mFeatureVertices = 24;
+        if (g % 2 == 0) {
+            lParams.mNoise = 0.01;
+        }
+        appendGenerated(lParams, QString("large %1").arg(g), lLayers);
+    }
+    if (lLayers.isEmpty()) {
+        lParser.showHelp(1);
+    }
+
+    const int lNumSplineDiffering = checkSplineValues(lOut);
+    lOut << "Spline::values() arguments differing from value() : " << lNumSplineDiffering << "\n";
+
+    const QVector<DetectionParameters> lParamSets = parameterSets(lScales);
+    QVector<int> lNumIdentical(lEngines.count(), 0);
+    QVector<int> lNumMatching(lEngines.count(), 0);
+    QVector<int> lNumDiffering(lEngines.count(), 0);
+    QVector<qint64> lNumKindEdges(lEngines.count(), 0);
+    qint64 lNumEdges = 0;
+
+    for (DiffLayer &lLayer : lLayers) {
+        QVector<EdgeLabels> lReference;
+        for (const DetectionParameters &lParams : lParamSets) {
+            ReferenceDetection lDetection(lLayer.mPoints);
+            QList<PolygonEdge *> lEdgeList;
+            lDetection.createEdgeList(lEdgeList);
+            lDetection.detectFeatures(lEdgeList, lParams);
+            lReference.append(EdgeLabels::fromEdges(lEdgeList));
+            lNumEdges += lEdgeList.count();
+            qDeleteAll(lEdgeList);
+        }
+
+        for (int e = 0; e < lEngines.count(); e++) {
+            QVector<EdgeLabels> lCandidate;
+            lEngines.at(e).mRun(lLayer, lParamSets, lCandidate);
+            for (int p = 0; p < lParamSets.count(); p++) {
+                lTolerance.mCompareSplineErrors = lParamSets.at(p).mCheckSplines;
+                FeatureDiffReport lReport = compareFeatures(lReference.at(p),
+                                                            lCandidate.at(p),
+                                                            lTolerance);
+                lNumKindEdges[e] += lReport.mNumKindMismatchEdges;
+                if (lReport.mSameLabels) {
+                    lNumIdentical[e]++;
+                    continue;
+                } else if (lReport.matches()) {
+                    lNumMatching[e]++;
+                    continue;
+                }
+
+                lNumDiffering[e]++;
+                if (lEngines.at(e).mApproximate) {
+                    continue;
+                }
+                lOut << lEngines.at(e).mName << " | " << lLayer.mName << " | "
+                     << describeParameters(lParamSets.at(p), lScales.at(p / 15)) << " : "
+                     << lReport.mMismatches.count() << " of " << lReport.mNumReferenceRuns
+                     << " runs, " << lReport.mNumKindMismatchEdges << " edges of another kind, "
+                     << lReport.mNumSplineErrorMismatches << " spline errors (max diff "
+                     << lReport.mMaxSplineErrorDiff << ")\n";
+                for (int m = 0; m < lReport.mMismatches.count() && m < lMaxReport; m++) {
+                    lOut << "    " << lReport.mMismatches.at(m).describe() << "\n";
+                }
+            }
+        }
+        lOut.flush();
+    }
+
+    lOut << "engine\tidentical\twithin tolerance\tdiffering\tedges of another kind\n";
+    int lTotalDiffering = 0;
+    for (int e = 0; e < lEngines.count(); e++) {
+        lOut << lEngines.at(e).mName << "\t" << lNumIdentical.at(e) << "\t" << lNumMatching.at(e)
+             << "\t" << lNumDiffering.at(e) << "\t" << lNumKindEdges.at(e) << " of " << lNumEdges;
+        if (lEngines.at(e).mApproximate) {
+            lOut << " (approximate)";
+        } else {
+            lTotalDiffering += lNumDiffering.at(e);
+        }
+        lOut << "\n";
+    }
+    lErr << lLayers.count() << " layers, " << lParamSets.count() << " parameter sets, "
+         << lEngines.count() << " engines\n";
+
+    return (lTotalDiffering > 0 || lNumSplineDiffering > 0) ? 1 : 0;
+}
@@ -0,0 +1,19 @@
+#-------------------------------------------------
+#
+# Command line feature export of polygon layer files
+#
+#-------------------------------------------------
+
+QT       += core gui concurrent
+
+TARGET = polyexport
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include(../../polyfeaturecore.pri)
+
+SOURCES += \
+        main.cpp
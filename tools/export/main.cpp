@@ -0,0 +1,168 @@
+#include "featureexport.h"
+#include "polyfeaturedetection.h"
+#include "polygonfileio.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QTextStream>
+#include <QtConcurrent>
+
+// All loops of a binary layer file, the polygon of a text one
+static bool readLayerLoops(const QString &aFilePath, QVector<QVector<QPointF>> &aLoops)
+{
+    PolygonLayer lLayer;
+    if (readPolygonLayerFile(aFilePath, lLayer)) {
+        aLoops = lLayer.mLoops;
+        return true;
+    }
+    QVector<QPointF> lPoints;
+    if (!readPolygonFile(aFilePath, lPoints)) {
+        return false;
+    }
+    aLoops = QVector<QVector<QPointF>>() << lPoints;
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication lApp(argc, argv);
+    QCoreApplication::setApplicationName("polyexport");
+
+    QCommandLineParser lParser;
+    lParser.setApplicationDescription(
+        "Detects the features of polygon layer files in parallel and streams the feature runs "
+        "of every loop, as JSON Lines or binary records, as soon as the loop is done.");
+    lParser.addHelpOption();
+    lParser.addPositionalArgument("layers",
+                                  "Polygon layer files, text or binary (all loops are exported).");
+
+    QCommandLineOption lOutputOption("output", "Output file, - for stdout.", "file", "-");
+    QCommandLineOption lFormatOption("format", "jsonl or binary.", "format", "jsonl");
+    QCommandLineOption lChecksOption("checks",
+                                     "Checks to run : any of lines, arcs, splines, sharp.",
+                                     "list",
+                                     "lines,arcs,splines,sharp");
+    QCommandLineOption lLineOption("line-tol",
+                                   "Line tolerance.",
+                                   "value",
+                                   QString::number(DEFAULT_LINE_TOL));
+    QCommandLineOption lArcOption("arc-tol",
+                                  "Arc tolerance.",
+                                  "value",
+                                  QString::number(DEFAULT_ARC_TOL));
+    QCommandLineOption lSplineOption("spline-tol",
+                                     "Spline tolerance.",
+                                     "value",
+                                     QString::number(DEFAULT_SPLINE_TOL));
+    QCommandLineOption lAngleOption("angle-tol",
+                                    "Sharp angle tolerance.",
+                                    "degrees",
+                                    QString::number(DEFAULT_SHARP_ANGLE_TOL));
+    QCommandLineOption lFixedPointOption("fixed-point",
+                                         "Compute edge angles and bounds from the vertices in "
+                                         "micrometres (for G-code layers).");
+    QCommandLineOption lBufferOption("buffer",
+                                     "Output buffer size.",
+                                     "bytes",
+                                     QString::number(DEFAULT_EXPORT_BUFFER_SIZE));
+    lParser.addOption(lOutputOption);
+    lParser.addOption(lFormatOption);
+    lParser.addOption(lChecksOption);
+    lParser.addOption(lLineOption);
+    lParser.addOption(lArcOption);
+    lParser.addOption(lSplineOption);
+    lParser.addOption(lAngleOption);
+    lParser.addOption(lFixedPointOption);
+    lParser.addOption(lBufferOption);
+    lParser.process(lApp);
+
+    QTextStream lErr(stderr);
+    const QStringList lFilePaths = lParser.positionalArguments();
+    if (lFilePaths.isEmpty()) {
+        lParser.showHelp(1);
+    }
+
+    DetectionParameters lParams;
+    QStringList lChecks = lParser.value(lChecksOption).split(QString(","));
+    lParams.mCheckLines = lChecks.contains("lines");
+    lParams.mCheckArcs = lChecks.contains("arcs");
+    lParams.mCheckSplines = lChecks.contains("splines");
+    lParams.mCheckSharpEdges = lChecks.contains("sharp");
+    if (lParser.isSet(lFixedPointOption)) {
+        lParams.mCoordinates = FixedPointCoordinates;
+    }
+    bool lOk[5];
+    lParams.mLineTolerance = lParser.value(lLineOption).toDouble(&lOk[0]);
+    lParams.mArcTolerance = lParser.value(lArcOption).toDouble(&lOk[1]);
+    lParams.mSplineTolerance = lParser.value(lSplineOption).toDouble(&lOk[2]);
+    lParams.mSharpAngleTolerance = lParser.value(lAngleOption).toDouble(&lOk[3]);
+    const int lBufferSize = lParser.value(lBufferOption).toInt(&lOk[4]);
+    for (bool lValueOk : lOk) {
+        if (!lValueOk) {
+            lErr << "Invalid tolerance or buffer size\n";
+            return 1;
+        }
+    }
+
+    FeatureExportFormat lFormat = JsonLinesExport;
+    if (lParser.value(lFormatOption) == "binary") {
+        lFormat = BinaryExport;
+    } else if (lParser.value(lFormatOption) != "jsonl") {
+        lErr << "Unknown format " << lParser.value(lFormatOption) << "\n";
+        return 1;
+    }
+
+    FeatureExportWriter lWriter(lFormat, lBufferSize);
+    if (!lWriter.open(lParser.value(lOutputOption))) {
+        lErr << "Cannot write " << lParser.value(lOutputOption) << "\n";
+        return 1;
+    }
+
+    // Layers are read by the task that runs them, so only the layers in
+    // flight are in memory, and every loop is written as soon as it is done
+    QVector<int> lLayerIndices(lFilePaths.count());
+    for (int j = 0; j < lFilePaths.count(); j++) {
+        lLayerIndices[j] = j;
+    }
+    QVector<bool> lUnread(lFilePaths.count(), false);
+    QElapsedTimer lTimer;
+    lTimer.start();
+    QtConcurrent::blockingMap(lLayerIndices, [&](const int &j) {
+        QVector<QVector<QPointF>> lLoops;
+        if (!readLayerLoops(lFilePaths.at(j), lLoops)) {
+            lUnread[j] = true;
+            return;
+        }
+        for (int l = 0; l < lLoops.count(); l++) {
+            QSharedPointer<QVector<QPointF>> lPoints(new QVector<QPointF>(lLoops.at(l)));
+            closePolygon(*lPoints);
+            PolyFeatureDetection lDetection(lPoints);
+            // layers already run concurrently, only split a lone layer by groups
+            lDetection.setParallelGroupProcessing(lFilePaths.count() == 1);
+
+            QList<PolygonEdge *> lEdgeList;
+            lDetection.createEdgeList(lEdgeList);
+            lDetection.detectFeatures(lEdgeList, lParams);
+            lWriter.writePolygon(j, l, lEdgeList);
+            qDeleteAll(lEdgeList);
+        }
+        // a finished layer is readable at once
+        lWriter.flush();
+    });
+    qint64 lElapsed = lTimer.elapsed();
+
+    const bool lWritten = lWriter.close();
+    const int lUnreadCount = lUnread.count(true);
+    for (int j = 0; j < lFilePaths.count(); j++) {
+        if (lUnread.at(j)) {
+            lErr << "Cannot read " << lFilePaths.at(j) << "\n";
+        }
+    }
+    lErr << lWriter.polygonCount() << " loops of " << lFilePaths.count() - lUnreadCount
+         << " layers, " << lWriter.bytesWritten() << " bytes in " << lElapsed << " ms\n";
+    if (!lWritten) {
+        lErr << "Cannot write " << lParser.value(lOutputOption) << "\n";
+    }
+    return (lWritten && lUnreadCount == 0) ? 0 : 1;
+}
@@ -0,0 +1,19 @@
+#-------------------------------------------------
+#
+# Seeded synthetic polygon layers with known features
+#
+#-------------------------------------------------
+
+QT       += core gui concurrent
+
+TARGET = polygen
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include(../../polyfeaturecore.pri)
+
+SOURCES += \
+        main.cpp
@@ -0,0 +1,148 @@
+#include "polygongenerator.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QStringList>
+#include <QTextStream>
+
+static QString kindName(const KnownFeatureKind aKind)
+{
+    switch (aKind) {
+    case KnownArc:
+        return "arc";
+    case KnownSpline:
+        return "spline";
+    case KnownTinyEdgeCorner:
+        return "tiny-edge-corner";
+    default:
+        return "line";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication lApp(argc, argv);
+    QCoreApplication::setApplicationName("polygen");
+
+    QCommandLineParser lParser;
+    lParser.setApplicationDescription(
+        "Generates reproducible polygon layers of lines, arcs and splines with known features, "
+        "as text layer files (<output>.txt, holes in <output>_hole<n>.txt, known features in "
+        "their comments) or as a binary layer file (<output>.pfb).");
+    lParser.addHelpOption();
+    lParser.addPositionalArgument("output", "Output path, without extension.");
+
+    GeneratorParameters lDefaults;
+    QCommandLineOption lSeedOption("seed", "Random seed.", "n", QString::number(lDefaults.mSeed));
+    QCommandLineOption lVerticesOption("vertices",
+                                       "Vertex count over all loops.",
+                                       "n",
+                                       QString::number(lDefaults.mVertexCount));
+    QCommandLineOption lSizeOption("size", "Outline diameter.", "mm", "100");
+    QCommandLineOption lFeatureOption("feature-vertices",
+                                      "Mean vertices per side.",
+                                      "n",
+                                      QString::number(lDefaults.mFeatureVertices));
+    QCommandLineOption lMixOption("mix", "Line, arc and spline side weights.", "l,a,s", "1,1,1");
+    QCommandLineOption lTinyOption("tiny-corners",
+                                   "Fraction of corners drawn with tiny edges.",
+                                   "fraction",
+                                   "0");
+    QCommandLineOption lTinyEdgesOption("tiny-edges",
+                                        "Edges per tiny-edge corner.",
+                                        "n",
+                                        QString::number(lDefaults.mTinyEdgeCount));
+    QCommandLineOption lNoiseOption("noise", "Standard deviation of the scan noise.", "mm", "0");
+    QCommandLineOption lHolesOption("holes", "Number of holes.", "n", "0");
+    QCommandLineOption lFormatOption("format", "text, binary or both.", "format", "text");
+    lParser.addOption(lSeedOption);
+    lParser.addOption(lVerticesOption);
+    lParser.addOption(lSizeOption);
+    lParser.addOption(lFeatureOption);
+    lParser.addOption(lMixOption);
+    lParser.addOption(lTinyOption);
+    lParser.addOption(lTinyEdgesOption);
+    lParser.addOption(lNoiseOption);
+    lParser.addOption(lHolesOption);
+    lParser.addOption(lFormatOption);
+    lParser.process(lApp);
+
+    QTextStream lErr(stderr);
+    if (lParser.positionalArguments().size() != 1) {
+        lParser.showHelp(1);
+    }
+    const QString lOutput = lParser.positionalArguments().first();
+    const QString lFormat = lParser.value(lFormatOption);
+
+    GeneratorParameters lParams;
+    bool lOk[9];
+    lParams.mSeed = lParser.value(lSeedOption).toUInt(&lOk[0]);
+    lParams.mVertexCount = lParser.value(lVerticesOption).toInt(&lOk[1]);
+    lParams.mSize = lParser.value(lSizeOption).toDouble(&lOk[2]);
+    lParams.mFeatureVertices = lParser.value(lFeatureOption).toInt(&lOk[3]);
+    lParams.mTinyEdgeCorners = lParser.value(lTinyOption).toDouble(&lOk[4]);
+    lParams.mTinyEdgeCount = lParser.value(lTinyEdgesOption).toInt(&lOk[5]);
+    lParams.mNoise = lParser.value(lNoiseOption).toDouble(&lOk[6]);
+    lParams.mHoleCount = lParser.value(lHolesOption).toInt(&lOk[7]);
+    QStringList lMix = lParser.value(lMixOption).split(QString(","));
+    lOk[8] = (lMix.size() == 3);
+    if (lOk[8]) {
+        bool lMixOk[3];
+        lParams.mLineWeight = lMix[0].toDouble(&lMixOk[0]);
+        lParams.mArcWeight = lMix[1].toDouble(&lMixOk[1]);
+        lParams.mSplineWeight = lMix[2].toDouble(&lMixOk[2]);
+        lOk[8] = lMixOk[0] && lMixOk[1] && lMixOk[2];
+    }
+    bool lAllOk = lFormat == "text" || lFormat == "binary" || lFormat == "both";
+    for (bool lValueOk : lOk) {
+        lAllOk = lAllOk && lValueOk;
+    }
+    if (!lAllOk || lParams.mVertexCount < 1 || lParams.mSize <= 0.0) {
+        lErr << "Invalid option value\n";
+        return 1;
+    }
+
+    PolygonLayer lLayer = PolygonGenerator(lParams).generate();
+
+    if (lFormat != "text" && !writePolygonLayerFile(lOutput + ".pfb", lLayer)) {
+        lErr << "Cannot write " << lOutput << ".pfb\n";
+        return 1;
+    }
+    if (lFormat != "binary") {
+        QStringList lParamComments;
+        lParamComments << QString("polygen --seed %1 --vertices %2 --size %3 --feature-vertices %4 "
+                                  "--mix %5 --tiny-corners %6 --tiny-edges %7 --noise %8 "
+                                  "--holes %9")
+                              .arg(lParser.value(lSeedOption),
+                                   lParser.value(lVerticesOption),
+                                   lParser.value(lSizeOption),
+                                   lParser.value(lFeatureOption),
+                                   lParser.value(lMixOption),
+                                   lParser.value(lTinyOption),
+                                   lParser.value(lTinyEdgesOption),
+                                   lParser.value(lNoiseOption),
+                                   lParser.value(lHolesOption));
+        for (int l = 0; l < lLayer.mLoops.count(); l++) {
+            QStringList lComments = lParamComments;
+            lComments << ((l == 0) ? QString("outer perimeter") : QString("hole %1").arg(l));
+            lComments << "known features : kind, first edge, edge count";
+            for (const KnownFeature &lFeature : lLayer.mFeatures) {
+                if (lFeature.mLoop == l) {
+                    lComments << QString("%1 %2 %3")
+                                     .arg(kindName(lFeature.mKind))
+                                     .arg(lFeature.mFirstEdge)
+                                     .arg(lFeature.mEdgeCount);
+                }
+            }
+            QString lFilePath = lOutput + ((l == 0) ? QString() : QString("_hole%1").arg(l))
+                                + ".txt";
+            if (!writePolygonFile(lFilePath, lLayer.mLoops.at(l), lComments)) {
+                lErr << "Cannot write " << lFilePath << "\n";
+                return 1;
+            }
+        }
+    }
+
+    lErr << lLayer.vertexCount() << " vertices in " << lLayer.mLoops.count() << " loops, "
+         << lLayer.mFeatures.count() << " known features\n";
+    return 0;
+}
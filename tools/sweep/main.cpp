@@ -0,0 +1,155 @@
+#include "detectiontrace.h"
+#include "polygonfileio.h"
+#include "tolerancesweep.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QTextStream>
+
+// "a,b,c" lists the values, "min:max:count" spaces count values geometrically
+static bool parseToleranceSpec(const QString &aSpec, QVector<double> &aValues)
+{
+    aValues.clear();
+    bool lOk = true;
+    QStringList lRange = aSpec.split(QString(":"));
+    if (lRange.size() == 3) {
+        bool lMinOk, lMaxOk, lCountOk;
+        double lMin = lRange[0].toDouble(&lMinOk);
+        double lMax = lRange[1].toDouble(&lMaxOk);
+        int lCount = lRange[2].toInt(&lCountOk);
+        aValues = SweepParameters::logSpaced(lMin, lMax, lCount);
+        lOk = lMinOk && lMaxOk && lCountOk && !aValues.isEmpty();
+    } else {
+        for (const QString &lValue : aSpec.split(QString(","))) {
+            bool lValueOk;
+            aValues.append(lValue.toDouble(&lValueOk));
+            lOk = lOk && lValueOk;
+        }
+    }
+    return lOk;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication lApp(argc, argv);
+    QCoreApplication::setApplicationName("polysweep");
+
+    QCommandLineParser lParser;
+    lParser.setApplicationDescription(
+        "Sweeps line, arc, spline and sharp angle tolerances over polygon layers and reports "
+        "the frontier of segment count against fit error.");
+    lParser.addHelpOption();
+    lParser.addPositionalArgument("layers", "Polygon layer files, one \"x, y\" point per line.");
+
+    QCommandLineOption lChecksOption("checks",
+                                     "Checks to run : any of lines, arcs, splines, sharp.",
+                                     "list",
+                                     "lines,arcs,splines,sharp");
+    QCommandLineOption lLineOption("line-tol", "Line tolerances.", "spec", "0.0001:0.01:5");
+    QCommandLineOption lArcOption("arc-tol", "Arc tolerances.", "spec", "0.001:0.1:5");
+    QCommandLineOption lSplineOption("spline-tol", "Spline tolerances.", "spec", "0.01:1:4");
+    QCommandLineOption lAngleOption("angle-tol", "Sharp angle tolerances.", "spec", "5,10,20");
+    QCommandLineOption lAllOption("all", "Print every parameter point, not only the frontier.");
+    QCommandLineOption lFixedPointOption("fixed-point",
+                                         "Compute edge angles and bounds from the vertices in "
+                                         "micrometres (for G-code layers).");
+    QCommandLineOption lCacheOption("cache",
+                                    "Keep layer results in this file, and reuse them on later "
+                                    "runs.",
+                                    "file");
+    lParser.addOption(lChecksOption);
+    lParser.addOption(lLineOption);
+    lParser.addOption(lArcOption);
+    lParser.addOption(lSplineOption);
+    lParser.addOption(lAngleOption);
+    lParser.addOption(lAllOption);
+    lParser.addOption(lFixedPointOption);
+    QCommandLineOption lTraceOption("trace",
+                                    "Write a Chrome trace of the sweep tasks and detection "
+                                    "stages to this file, for Perfetto UI.",
+                                    "file");
+    lParser.addOption(lCacheOption);
+    lParser.addOption(lTraceOption);
+    lParser.process(lApp);
+
+    QTextStream lOut(stdout);
+    QTextStream lErr(stderr);
+
+    SweepParameters lParams;
+    QStringList lChecks = lParser.value(lChecksOption).split(QString(","));
+    lParams.mBaseParams.mCheckLines = lChecks.contains("lines");
+    lParams.mBaseParams.mCheckArcs = lChecks.contains("arcs");
+    lParams.mBaseParams.mCheckSplines = lChecks.contains("splines");
+    lParams.mBaseParams.mCheckSharpEdges = lChecks.contains("sharp");
+    if (lParser.isSet(lFixedPointOption)) {
+        lParams.mBaseParams.mCoordinates = FixedPointCoordinates;
+    }
+
+    if (!parseToleranceSpec(lParser.value(lLineOption), lParams.mLineTolerances)
+        || !parseToleranceSpec(lParser.value(lArcOption), lParams.mArcTolerances)
+        || !parseToleranceSpec(lParser.value(lSplineOption), lParams.mSplineTolerances)
+        || !parseToleranceSpec(lParser.value(lAngleOption), lParams.mSharpAngleTolerances)) {
+        lErr << "Invalid tolerance specification\n";
+        return 1;
+    }
+
+    ToleranceSweep lSweep;
+    for (const QString &lFilePath : lParser.positionalArguments()) {
+        QVector<QPointF> lPoints;
+        if (!readPolygonFile(lFilePath, lPoints)) {
+            lErr << "Cannot read " << lFilePath << "\n";
+            return 1;
+        }
+        lSweep.addLayer(lPoints);
+    }
+    if (lSweep.layerCount() == 0) {
+        lParser.showHelp(1);
+    }
+
+    DiskResultCache lDiskCache;
+    if (lParser.isSet(lCacheOption)) {
+        // e.g. in use by another process, the sweep runs without it
+        if (lDiskCache.open(lParser.value(lCacheOption))) {
+            lSweep.setDiskCache(&lDiskCache);
+        } else {
+            lErr << "Cannot open cache " << lParser.value(lCacheOption) << ", not using it\n";
+        }
+    }
+
+    if (lParser.isSet(lTraceOption)) {
+        DetectionTrace::start();
+    }
+    QElapsedTimer lTimer;
+    lTimer.start();
+    QVector<SweepPoint> lResults = lSweep.run(lParams);
+    qint64 lElapsed = lTimer.elapsed();
+    if (lParser.isSet(lTraceOption)) {
+        DetectionTrace::stop();
+        int lNumEvents = DetectionTrace::writeChromeTrace(lParser.value(lTraceOption));
+        if (lNumEvents < 0) {
+            lErr << "Cannot write " << lParser.value(lTraceOption) << "\n";
+            return 1;
+        }
+        lErr << lNumEvents << " trace events, " << DetectionTrace::droppedEvents()
+             << " dropped\n";
+    }
+
+    lOut << "line_tol\tarc_tol\tspline_tol\tangle_tol\tfeatures\tsegments\tfit_error\tfrontier\n";
+    for (const SweepPoint &lPoint : lResults) {
+        if (!lPoint.mOnFrontier && !lParser.isSet(lAllOption)) {
+            continue;
+        }
+        lOut << lPoint.mParams.mLineTolerance << "\t" << lPoint.mParams.mArcTolerance << "\t"
+             << lPoint.mParams.mSplineTolerance << "\t" << lPoint.mParams.mSharpAngleTolerance
+             << "\t" << lPoint.mNumFeatures << "\t" << lPoint.mNumSegments << "\t"
+             << lPoint.mFitError << "\t" << (lPoint.mOnFrontier ? 1 : 0) << "\n";
+    }
+    lErr << lResults.count() << " parameter points over " << lSweep.layerCount() << " layers in "
+         << lElapsed << " ms\n";
+    if (lDiskCache.isOpen()) {
+        lErr << lDiskCache.hitCount() << " cache hits, " << lDiskCache.missCount() << " misses\n";
+    }
+
+    return 0;
+}
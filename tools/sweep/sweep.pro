@@ -0,0 +1,22 @@
+#-------------------------------------------------
+#
+# Command line tolerance sweep over polygon layer files
+#
+#-------------------------------------------------
+
+QT       += core gui concurrent
+
+TARGET = polysweep
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+# trace scopes for --trace, only recorded while tracing
+DEFINES += POLYFEATURE_TRACE
+
+include(../../polyfeaturecore.pri)
+
+SOURCES += \
+        main.cpp